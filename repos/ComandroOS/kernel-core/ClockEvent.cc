@@ -0,0 +1,59 @@
+#include "ClockEvent.h"
+
+namespace comandro {
+namespace kernel {
+
+static constexpr uint64_t NSEC_PER_SEC = 1000000000ULL;
+
+static inline uint64_t cycles_to_ns(uint64_t cycles, uint64_t frequency_hz) {
+    return static_cast<uint64_t>(static_cast<unsigned __int128>(cycles) * NSEC_PER_SEC / frequency_hz);
+}
+
+void ClockEventDevice::configure(uint64_t frequency, uint64_t min_delta_cycles, uint64_t max_delta_cycles) {
+    frequency_hz = frequency;
+    max_delta_ns = cycles_to_ns(max_delta_cycles, frequency);
+    // Arredonda para cima: o hardware nunca recebe menos que min_delta_cycles
+    min_delta_ns = cycles_to_ns(min_delta_cycles, frequency);
+    if (static_cast<unsigned __int128>(min_delta_ns) * frequency < static_cast<unsigned __int128>(min_delta_cycles) * NSEC_PER_SEC) {
+        min_delta_ns++;
+    }
+
+    // Maior shift (mais precisao) em que mult cabe em 32 bits e max_delta_ns * mult em 64
+    for (shift = 32; shift > 0; --shift) {
+        uint64_t candidate = static_cast<uint64_t>((static_cast<unsigned __int128>(frequency) << shift) / NSEC_PER_SEC);
+        if (candidate <= UINT32_MAX && (candidate == 0 || max_delta_ns <= UINT64_MAX / candidate)) {
+            mult = static_cast<uint32_t>(candidate);
+            return;
+        }
+    }
+    mult = static_cast<uint32_t>(frequency / NSEC_PER_SEC);
+}
+
+uint64_t ClockEventDevice::ns_to_cycles(uint64_t ns) const {
+    if (ns > max_delta_ns) {
+        ns = max_delta_ns;
+    }
+    return (ns * mult) >> shift;
+}
+
+bool ClockEventDevice::program_event(uint64_t expires_ns, uint64_t now_ns) {
+    uint64_t delta_ns = (expires_ns > now_ns) ? expires_ns - now_ns : 0;
+    if (delta_ns < min_delta_ns) {
+        delta_ns = min_delta_ns;
+    }
+    state = CLOCK_EVT_STATE_ONESHOT;
+    return set_next_event(ns_to_cycles(delta_ns));
+}
+
+bool ClockEventDevice::program_periodic(uint64_t period_ns) {
+    state = CLOCK_EVT_STATE_PERIODIC;
+    return set_periodic(ns_to_cycles(period_ns));
+}
+
+void ClockEventDevice::stop() {
+    state = CLOCK_EVT_STATE_SHUTDOWN;
+    shutdown();
+}
+
+} // namespace kernel
+} // namespace comandro
@@ -0,0 +1,73 @@
+#ifndef COMANDRO_KERNEL_CORE_CLOCK_EVENT_H
+#define COMANDRO_KERNEL_CORE_CLOCK_EVENT_H
+
+#include <comandro/kernel/types.h>
+#include <stdint.h>
+
+namespace comandro {
+namespace kernel {
+
+// Capacidades de um timer de hardware
+static constexpr uint32_t CLOCK_EVT_FEAT_PERIODIC = 1 << 0; // Dispara sozinho a cada periodo
+static constexpr uint32_t CLOCK_EVT_FEAT_ONESHOT = 1 << 1;  // Comparador: um disparo no instante programado
+
+// Modo atual do timer de hardware
+enum ClockEventState {
+    CLOCK_EVT_STATE_SHUTDOWN = 0,   // Parado (one-shot sem timers pendentes)
+    CLOCK_EVT_STATE_PERIODIC,       // Tick fixo: os timers tem a resolucao do tick
+    CLOCK_EVT_STATE_ONESHOT,        // hrtimer: reprogramado para o proximo vencimento exato
+};
+
+/**
+ * @brief Timer de hardware de uma CPU (comparador do generic timer, timer local, timerfd no host).
+ * * O driver implementa set_next_event()/set_periodic()/shutdown() em ciclos do proprio
+ *   contador; a conversao de ns (mult/shift) e os limites saem de configure().
+ * * Pode ser chamado de outra CPU (migracao/rearme de timers): um comparador que so a
+ *   propria CPU programa encaminha o pedido por IPI.
+ */
+class ClockEventDevice {
+public:
+    virtual ~ClockEventDevice() = default;
+
+    // Dispara uma vez daqui a cycles ciclos (>= min_delta; 0 so com min_delta 0: disparo imediato)
+    virtual bool set_next_event(uint64_t cycles) = 0;
+    // Dispara a cada period_cycles ciclos ate shutdown() ou set_next_event()
+    virtual bool set_periodic(uint64_t period_cycles) = 0;
+    virtual void shutdown() = 0;
+
+    /**
+     * @brief Calibra a conversao ns -> ciclos para a frequencia do contador.
+     * @param min_delta_cycles Menor distancia que vale programar (custo de programacao/latencia do disparo).
+     * @param max_delta_cycles Maior distancia representavel pelo comparador.
+     */
+    void configure(uint64_t frequency_hz, uint64_t min_delta_cycles, uint64_t max_delta_cycles);
+
+    // ns -> ciclos, limitado a max_delta_ns
+    uint64_t ns_to_cycles(uint64_t ns) const;
+
+    /**
+     * @brief Modo one-shot: dispara em expires_ns (relogio do kernel), respeitando os limites.
+     * * Um vencimento ja passado ou mais perto que min_delta_ns dispara em min_delta_ns;
+     *   alem de max_delta_ns dispara antes, e o IRQ (sem timers vencidos) reprograma.
+     */
+    bool program_event(uint64_t expires_ns, uint64_t now_ns);
+
+    // Modo periodico a cada period_ns
+    bool program_periodic(uint64_t period_ns);
+
+    void stop();
+
+    const char* name = "";
+    uint32_t features = 0;
+    uint64_t frequency_hz = 0;
+    uint32_t mult = 0;              // ciclos = (ns * mult) >> shift
+    uint32_t shift = 0;
+    uint64_t min_delta_ns = 0;
+    uint64_t max_delta_ns = 0;
+    ClockEventState state = CLOCK_EVT_STATE_SHUTDOWN;
+};
+
+} // namespace kernel
+} // namespace comandro
+
+#endif // COMANDRO_KERNEL_CORE_CLOCK_EVENT_H
@@ -1,114 +1,859 @@
 #include "KernelTimer.h"
+#include "ClockEvent.h"
+#include "scheduler/Timeline.h" // Fila precisa: arvore ordenada pelo vencimento exato
+#include "scheduler/LatencyHistogram.h" // Latencia de drenagem da fila softirq
 #include <comandro/kernel/log.h>
+#include <comandro/kernel/list.h>
+#include <comandro/kernel/cpu_topology.h> // Para cpu::get_current_cpu_id()
 #include <comandro/kernel/scheduler.h>
-#include <list>
+#include <comandro/kernel/trace.h>
+#include <atomic>
+#include <new>
+#include <string>
 
 namespace comandro {
 namespace kernel {
 
 using kernel::Log;
 using kernel::Scheduler;
+using scheduler::LatencyHistogram;
+using scheduler::LatencySnapshot;
+using scheduler::Timeline;
+using scheduler::TimelineNode;
 
 static constexpr const char* TAG = "KernelTimer";
-static constexpr Nanoseconds HW_TICK_RATE = Nanoseconds(1000000); // 1ms por tick
+static constexpr Nanoseconds HW_TICK_RATE = Nanoseconds(1000000); // 1ms por tick (modo periodico)
+
+// =====================================================================
+// Timing wheel hierarquica
+// Nivel 0: 64 slots de 2^20 ns (~1ms); cada nivel seguinte tem slots 64x
+// maiores (~67ms, ~4.3s, ~4.6min, ~4.9h). Um timer entra no slot do seu
+// vencimento no menor nivel que o alcanca e desce de nivel (cascata) quando
+// o slot vence: inserir, cancelar e vencer sao O(1) amortizado.
+// Timers do tick atual de nivel 0 ficam na fila precisa (arvore pelo
+// vencimento exato, em geral pequena): a resolucao nao fica presa ao slot.
+// =====================================================================
+
+static constexpr int WHEEL_LEVELS = 5;
+static constexpr int WHEEL_SLOT_BITS = 6;
+static constexpr int WHEEL_SLOTS = 1 << WHEEL_SLOT_BITS;
+static constexpr int WHEEL_TICK_SHIFT = 20; // Granularidade do nivel 0: 2^20 ns
+
+// Timers alocados de uma vez quando o pool esvazia (nunca devolvidos)
+static constexpr uint32_t TIMER_POOL_CHUNK = 256;
+// Blocos do pool: ate 1M timers armados ao mesmo tempo
+static constexpr uint32_t TIMER_POOL_MAX_CHUNKS = 4096;
+// Timers livres movidos de uma vez entre a lista de uma base e o deposito global
+static constexpr uint32_t TIMER_CACHE_BATCH = 32;
+// Timers livres guardados por base (acima disso, o excedente volta ao deposito)
+static constexpr uint32_t TIMER_CACHE_CAPACITY = 2 * TIMER_CACHE_BATCH;
+
+// Callbacks vencidos que o IRQ de uma CPU enfileira antes de a thread softirq drenar (potencia de 2)
+static constexpr uint32_t TIMER_SOFTIRQ_RING_SIZE = 128;
+
+// Nivel de um timer que esta na fila precisa, e nao num slot da wheel
+static constexpr int8_t TIMER_LEVEL_QUEUE = -1;
+// Base de um timer livre (no pool, sem handle valido)
+static constexpr int16_t TIMER_CPU_NONE = -1;
 
 // Estrutura interna para um temporizador de software
 struct SoftwareTimer {
-    uint32_t id;
-    Nanoseconds expiry_time;
-    Nanoseconds duration;
+    list_head wheel_node;           // Slot da wheel (level >= 0)
+    TimelineNode queue_node;        // Fila precisa (level == TIMER_LEVEL_QUEUE)
+    SoftwareTimer* free_next;       // Lista livre da base ou do deposito
+    uint64_t expiry_ns;             // Instante de disparo (ordena a wheel e programa o hardware)
+    uint64_t soft_expiry_ns;        // Instante pedido: o mais cedo que pode vencer
+    uint64_t slack_ns;
+    uint64_t period_ns;             // 0 = one-shot
     TimerCallback callback;
     void* context;
-    bool periodic;
+    uint32_t index;                 // Posicao no pool (metade baixa do handle)
+    uint32_t generation;            // Muda a cada liberacao: handles antigos deixam de valer
+    std::atomic<int16_t> cpu;       // Base onde esta armado; so muda com o lock dessa base
+    int8_t level;
+    uint8_t slot;
+};
 
-    bool operator<(const SoftwareTimer& other) const {
-        return expiry_time < other.expiry_time;
+/**
+ * @brief Base de timers de uma CPU: wheel, fila precisa e estoque livre, sob o lock proprio.
+ * * Cada CPU arma na sua base e o IRQ local so vence a sua: CPUs diferentes nao
+ *   disputam o lock, a nao ser para cancelar/rearmar timers umas das outras.
+ */
+struct alignas(64) TimerBase {
+    SpinLock lock;
+    int16_t cpu;
+    list_head wheel[WHEEL_LEVELS][WHEEL_SLOTS];
+    uint64_t pending[WHEEL_LEVELS];     // Bit N = slot N do nivel nao vazio
+    Timeline queue;
+    uint64_t clock_tick;                // Ultimo tick de nivel 0 processado (ns >> WHEEL_TICK_SHIFT)
+    uint64_t programmed_ns;             // Evento pedido ao hardware (UINT64_MAX = nenhum)
+    ClockEventDevice* clockevent;       // Timer de hardware da CPU (nullptr = ainda nao registrado)
+    bool high_res;                      // One-shot no vencimento exato; false = tick fixo de HW_TICK_RATE
+    SoftwareTimer* free_timers;
+    uint32_t nr_free;
+
+    TimerBase() : cpu(0), pending(), clock_tick(0), programmed_ns(UINT64_MAX), clockevent(nullptr), high_res(false),
+                  free_timers(nullptr), nr_free(0) {
+        for (int level = 0; level < WHEEL_LEVELS; ++level) {
+            for (int slot = 0; slot < WHEEL_SLOTS; ++slot) {
+                INIT_LIST_HEAD(&wheel[level][slot]);
+            }
+        }
     }
 };
 
-static std::list<SoftwareTimer> s_active_timers; // Lista ordenada por tempo de expiracao
+/**
+ * @brief Memoria dos timers, compartilhada pelas bases.
+ * * chunks so cresce (publicado por nr_chunks): um handle acha o seu timer sem lock.
+ * * O deposito (sob lock) so e tocado a cada TIMER_CACHE_BATCH alocacoes/liberacoes de uma base.
+ */
+struct TimerPool {
+    SoftwareTimer* chunks[TIMER_POOL_MAX_CHUNKS];
+    std::atomic<uint32_t> nr_chunks;
+    SpinLock lock;
+    SoftwareTimer* depot;
+
+    TimerPool() : chunks(), nr_chunks(0), depot(nullptr) {}
+};
+
+/**
+ * @brief Callback vencido a caminho da thread softirq: so ponteiros e contadores, sem captura.
+ */
+struct DeferredTimerCall {
+    TimerCallback callback;
+    void* context;
+    uint64_t raised_ns;             // IRQ que enfileirou (latencia de drenagem)
+    uint32_t overruns;
+};
+
+/**
+ * @brief Fila softirq de uma CPU: anel de capacidade fixa, vencer um timer nunca aloca.
+ * * Um produtor por vez (o IRQ da CPU, ou a propria thread softirq, com o lock da base)
+ *   e um consumidor (a thread softirq da CPU), sem lock: tail e publicado com release.
+ * * Fila cheia: o IRQ para de vencer e marca overflow; os timers vencidos esperam na
+ *   base e a thread softirq os vence depois de drenar (nada se perde nem reordena).
+ */
+struct alignas(64) TimerSoftirq {
+    DeferredTimerCall ring[TIMER_SOFTIRQ_RING_SIZE];
+    // Lado do produtor
+    alignas(64) std::atomic<uint32_t> tail;
+    std::atomic<uint32_t> max_depth;
+    std::atomic<uint64_t> overflows;
+    std::atomic<bool> overflow;
+    // Lado do consumidor
+    alignas(64) std::atomic<uint32_t> head;
+    std::atomic<uint64_t> batches;
+    LatencyHistogram drain_latency;
+
+    TimerSoftirq() : ring(), tail(0), max_depth(0), overflows(0), overflow(false), head(0), batches(0) {}
+};
+
+static TimerBase s_timer_bases[cpu::MAX_CPU_CORES];
+static TimerSoftirq s_timer_softirqs[cpu::MAX_CPU_CORES];
+static TimerPool s_timer_pool;
+static std::atomic<bool> s_high_res_enabled{true};
+
+static inline uint64_t tick_of(uint64_t time_ns) {
+    return time_ns >> WHEEL_TICK_SHIFT;
+}
+
+static inline uint64_t rotate_right(uint64_t value, int bits) {
+    return bits == 0 ? value : (value >> bits) | (value << (WHEEL_SLOTS - bits));
+}
+
+/**
+ * @brief Instante de disparo de um timer com folga: o maior multiplo da maior potencia
+ * de 2 <= slack_ns que nao passa de soft_ns + slack_ns (sempre > soft_ns).
+ * * Timers com folgas da mesma ordem caem nos mesmos pontos da grade e vencem no
+ *   mesmo IRQ, mesmo armados em instantes diferentes.
+ */
+static inline uint64_t coalesced_expiry(uint64_t soft_ns, uint64_t slack_ns) {
+    if (slack_ns == 0) {
+        return soft_ns;
+    }
+    if (slack_ns > UINT64_MAX - soft_ns) {
+        slack_ns = UINT64_MAX - soft_ns;
+    }
+    uint64_t granule = 1ULL << (63 - __builtin_clzll(slack_ns));
+    return (soft_ns + slack_ns) & ~(granule - 1);
+}
+
+static inline void set_expiry(SoftwareTimer* timer, uint64_t soft_ns) {
+    timer->soft_expiry_ns = soft_ns;
+    timer->expiry_ns = coalesced_expiry(soft_ns, timer->slack_ns);
+}
+
+static TimerBase* local_base() {
+    int cpu = cpu::get_current_cpu_id();
+    if (cpu < 0 || cpu >= cpu::MAX_CPU_CORES) {
+        cpu = 0;
+    }
+    return &s_timer_bases[cpu];
+}
+
+// =====================================================================
+// Pool e handles
+// Handle = geracao << 32 | indice no pool. A geracao nunca e 0, entao um
+// handle valido nunca e 0; ao liberar o timer ela avanca, e um handle
+// guardado de um timer ja vencido/cancelado nao acha o slot reutilizado.
+// =====================================================================
+
+static inline TimerHandle handle_of(const SoftwareTimer* timer) {
+    return (static_cast<TimerHandle>(timer->generation) << 32) | timer->index;
+}
+
+/**
+ * @brief Aloca um bloco de timers e o encadeia no deposito. O chamador segura s_timer_pool.lock.
+ */
+static bool grow_pool() {
+    uint32_t nr_chunks = s_timer_pool.nr_chunks.load(std::memory_order_relaxed);
+    if (nr_chunks == TIMER_POOL_MAX_CHUNKS) {
+        return false;
+    }
+    SoftwareTimer* chunk = new (std::nothrow) SoftwareTimer[TIMER_POOL_CHUNK];
+    if (chunk == nullptr) {
+        return false;
+    }
+    uint32_t first_index = nr_chunks * TIMER_POOL_CHUNK;
+    for (int i = TIMER_POOL_CHUNK - 1; i >= 0; --i) {
+        chunk[i].index = first_index + i;
+        chunk[i].generation = 1;
+        chunk[i].cpu.store(TIMER_CPU_NONE, std::memory_order_relaxed);
+        chunk[i].free_next = s_timer_pool.depot;
+        s_timer_pool.depot = &chunk[i];
+    }
+    s_timer_pool.chunks[nr_chunks] = chunk;
+    s_timer_pool.nr_chunks.store(nr_chunks + 1, std::memory_order_release);
+    return true;
+}
+
+/**
+ * @brief Busca um lote no deposito (crescendo o pool se estiver vazio). O chamador segura base->lock.
+ */
+static bool refill_free_timers(TimerBase* base) {
+    SpinLock::Guard lock(s_timer_pool.lock);
+    if (s_timer_pool.depot == nullptr && !grow_pool()) {
+        return false;
+    }
+    while (base->nr_free < TIMER_CACHE_BATCH && s_timer_pool.depot != nullptr) {
+        SoftwareTimer* timer = s_timer_pool.depot;
+        s_timer_pool.depot = timer->free_next;
+        timer->free_next = base->free_timers;
+        base->free_timers = timer;
+        base->nr_free++;
+    }
+    return true;
+}
+
+/**
+ * @brief Devolve ao deposito o que passa de TIMER_CACHE_BATCH timers livres. O chamador segura base->lock.
+ * * Os liberados mais recentemente (inicio da lista) ficam: ainda devem estar no cache.
+ */
+static void flush_free_timers(TimerBase* base) {
+    SoftwareTimer* last_kept = base->free_timers;
+    for (uint32_t i = 1; i < TIMER_CACHE_BATCH; ++i) {
+        last_kept = last_kept->free_next;
+    }
+    SoftwareTimer* first = last_kept->free_next;
+    SoftwareTimer* last = first;
+    while (last->free_next != nullptr) {
+        last = last->free_next;
+    }
+    last_kept->free_next = nullptr;
+    base->nr_free = TIMER_CACHE_BATCH;
+
+    SpinLock::Guard lock(s_timer_pool.lock);
+    last->free_next = s_timer_pool.depot;
+    s_timer_pool.depot = first;
+}
+
+static SoftwareTimer* alloc_timer(TimerBase* base) {
+    if (base->free_timers == nullptr && !refill_free_timers(base)) {
+        return nullptr;
+    }
+    SoftwareTimer* timer = base->free_timers;
+    base->free_timers = timer->free_next;
+    base->nr_free--;
+    timer->cpu.store(base->cpu, std::memory_order_relaxed);
+    return timer;
+}
+
+static void free_timer(TimerBase* base, SoftwareTimer* timer) {
+    timer->cpu.store(TIMER_CPU_NONE, std::memory_order_relaxed);
+    if (++timer->generation == 0) {
+        timer->generation = 1;
+    }
+    timer->free_next = base->free_timers;
+    base->free_timers = timer;
+    if (++base->nr_free > TIMER_CACHE_CAPACITY) {
+        flush_free_timers(base);
+    }
+}
+
+/**
+ * @brief Timer armado do handle, com a base onde ele esta travada, em O(1).
+ * * O timer pode migrar de base entre a leitura de cpu e o lock: confere de novo
+ *   com a base travada (cpu so muda com o lock da base atual).
+ * @return nullptr, sem nenhum lock, se o handle ja nao vale.
+ */
+static SoftwareTimer* lock_timer_base(TimerHandle handle, TimerBase** locked_base) {
+    uint32_t index = static_cast<uint32_t>(handle);
+    uint32_t chunk = index / TIMER_POOL_CHUNK;
+    if (chunk >= s_timer_pool.nr_chunks.load(std::memory_order_acquire)) {
+        return nullptr;
+    }
+    SoftwareTimer* timer = &s_timer_pool.chunks[chunk][index % TIMER_POOL_CHUNK];
+
+    for (;;) {
+        int16_t cpu = timer->cpu.load(std::memory_order_relaxed);
+        if (cpu == TIMER_CPU_NONE) {
+            return nullptr;
+        }
+        TimerBase* base = &s_timer_bases[cpu];
+        base->lock.lock();
+        if (timer->cpu.load(std::memory_order_relaxed) == cpu) {
+            if (timer->generation != static_cast<uint32_t>(handle >> 32)) {
+                base->lock.unlock();
+                return nullptr;
+            }
+            *locked_base = base;
+            return timer;
+        }
+        base->lock.unlock();
+    }
+}
+
+// =====================================================================
+// Wheel (chamados com base->lock travado)
+// =====================================================================
+
+/**
+ * @brief Arma o timer relativo ao relogio da wheel: fila precisa se vence ate o tick
+ * atual, senao o slot do vencimento no menor nivel que o alcanca.
+ */
+static void enqueue_timer(TimerBase* base, SoftwareTimer* timer) {
+    uint64_t expiry_tick = tick_of(timer->expiry_ns);
+    if (expiry_tick <= base->clock_tick) {
+        timer->level = TIMER_LEVEL_QUEUE;
+        base->queue.insert(&timer->queue_node, timer->expiry_ns);
+        return;
+    }
+
+    int level = 0;
+    while (level < WHEEL_LEVELS - 1 &&
+           (expiry_tick >> (level * WHEEL_SLOT_BITS)) - (base->clock_tick >> (level * WHEEL_SLOT_BITS)) >= WHEEL_SLOTS) {
+        level++;
+    }
+    uint64_t unit = expiry_tick >> (level * WHEEL_SLOT_BITS);
+    uint64_t last_unit = (base->clock_tick >> (level * WHEEL_SLOT_BITS)) + WHEEL_SLOTS - 1;
+    if (unit > last_unit) {
+        unit = last_unit; // Alem do alcance da wheel: o ultimo slot cascateia de novo
+    }
+
+    timer->level = static_cast<int8_t>(level);
+    timer->slot = static_cast<uint8_t>(unit & (WHEEL_SLOTS - 1));
+    list_add_tail(&timer->wheel_node, &base->wheel[level][timer->slot]);
+    base->pending[level] |= 1ULL << timer->slot;
+}
+
+static void dequeue_timer(TimerBase* base, SoftwareTimer* timer) {
+    if (timer->level == TIMER_LEVEL_QUEUE) {
+        base->queue.erase(&timer->queue_node);
+        return;
+    }
+    list_del_init(&timer->wheel_node);
+    if (list_empty(&base->wheel[timer->level][timer->slot])) {
+        base->pending[timer->level] &= ~(1ULL << timer->slot);
+    }
+}
+
+/**
+ * @brief Rearma os timers de um slot vencido relativo ao relogio novo (nivel abaixo ou fila precisa).
+ */
+static void cascade_slot(TimerBase* base, int level, int slot) {
+    // Esvazia o slot antes: um timer alem do alcance pode voltar para ele
+    list_head due;
+    INIT_LIST_HEAD(&due);
+    list_head* head = &base->wheel[level][slot];
+    due.next = head->next;
+    due.prev = head->prev;
+    due.next->prev = &due;
+    due.prev->next = &due;
+    INIT_LIST_HEAD(head);
+    base->pending[level] &= ~(1ULL << slot);
+
+    while (!list_empty(&due)) {
+        SoftwareTimer* timer = list_entry(due.next, SoftwareTimer, wheel_node);
+        list_del_init(&timer->wheel_node);
+        enqueue_timer(base, timer);
+    }
+}
+
+/**
+ * @brief Avanca o relogio da wheel ate now_ns, cascateando os slots vencidos de cada nivel.
+ * * Custo proporcional aos slots ocupados, nao ao tempo passado: um IRQ atrasado
+ *   (CPU ociosa em NO_HZ) nao percorre tick a tick.
+ */
+static void advance_wheel(TimerBase* base, uint64_t now_ns) {
+    uint64_t old_tick = base->clock_tick;
+    uint64_t new_tick = tick_of(now_ns);
+    if (new_tick <= old_tick) {
+        return;
+    }
+    base->clock_tick = new_tick;
+
+    // De baixo para cima: o que desce de um nivel superior cai em slots futuros
+    for (int level = 0; level < WHEEL_LEVELS; ++level) {
+        int shift = level * WHEEL_SLOT_BITS;
+        uint64_t old_unit = old_tick >> shift;
+        uint64_t elapsed = (new_tick >> shift) - old_unit;
+        if (elapsed == 0) {
+            break; // Nenhum nivel acima virou de slot
+        }
+
+        uint64_t due = base->pending[level];
+        if (elapsed < WHEEL_SLOTS) {
+            int first = static_cast<int>((old_unit + 1) & (WHEEL_SLOTS - 1));
+            uint64_t range = (1ULL << elapsed) - 1;
+            due &= rotate_right(range, (WHEEL_SLOTS - first) & (WHEEL_SLOTS - 1));
+        }
+        while (due != 0) {
+            int slot = __builtin_ctzll(due);
+            due &= due - 1;
+            cascade_slot(base, level, slot);
+        }
+    }
+}
+
+/**
+ * @brief Proximo instante em que o hardware precisa disparar: o vencimento exato mais
+ * proximo (fila precisa e primeiro slot de nivel 0), ou o inicio do primeiro slot
+ * ocupado dos niveis de cima (cascata).
+ */
+static uint64_t next_event_ns(const TimerBase* base) {
+    uint64_t next = UINT64_MAX;
+    TimelineNode* first = base->queue.leftmost();
+    if (first != nullptr) {
+        next = first->key;
+    }
+
+    for (int level = 0; level < WHEEL_LEVELS; ++level) {
+        if (base->pending[level] == 0) {
+            continue;
+        }
+        int shift = level * WHEEL_SLOT_BITS;
+        uint64_t unit = base->clock_tick >> shift;
+        int first_slot = static_cast<int>((unit + 1) & (WHEEL_SLOTS - 1));
+        uint64_t due_unit = unit + 1 + __builtin_ctzll(rotate_right(base->pending[level], first_slot));
+        uint64_t start_ns = (due_unit << shift) << WHEEL_TICK_SHIFT;
+        if (start_ns >= next) {
+            continue;
+        }
+        if (level == 0) {
+            // Slot de ~1ms (poucos timers): o vencimento exato evita um IRQ so de cascata
+            const list_head* head = &base->wheel[0][due_unit & (WHEEL_SLOTS - 1)];
+            for (const list_head* pos = head->next; pos != head; pos = pos->next) {
+                uint64_t expiry_ns = list_entry(pos, SoftwareTimer, wheel_node)->expiry_ns;
+                if (expiry_ns < next) {
+                    next = expiry_ns;
+                }
+            }
+        } else {
+            next = start_ns;
+        }
+    }
+    return next;
+}
+
+/**
+ * @brief Modo alta resolucao: programa o comparador da CPU da base para o proximo
+ * evento exato da wheel (NO_HZ). So reprograma se o evento mudou.
+ * * Sem timers pendentes o comparador para: o hardware so dispara pelo tick do
+ *   scheduler (que para nas CPUs ociosas).
+ * * Tick fixo (ou sem timer de hardware registrado): nada a programar, o IRQ
+ *   periodico confere a base a cada HW_TICK_RATE.
+ */
+static void program_next_hw_event(TimerBase* base) {
+    ClockEventDevice* device = base->clockevent;
+    if (device == nullptr || !base->high_res) {
+        return;
+    }
+    // Fila softirq cheia com timers ja vencidos na base: um IRQ agora nao venceria
+    // nada; a thread softirq reprograma depois de drenar
+    if (s_timer_softirqs[base->cpu].overflow.load(std::memory_order_relaxed)) {
+        return;
+    }
+    uint64_t next = next_event_ns(base);
+    if (next == base->programmed_ns) {
+        return;
+    }
+    base->programmed_ns = next;
+    if (next == UINT64_MAX) {
+        device->stop();
+        return;
+    }
+    device->program_event(next, static_cast<uint64_t>(Scheduler::getKernelTime().count()));
+}
+
+/**
+ * @brief Poe o timer de hardware da base em one-shot (alta resolucao) ou no tick fixo. O chamador segura base->lock.
+ * * Um dispositivo so one-shot fica em one-shot mesmo com o modo de alta resolucao desligado.
+ */
+static void set_clockevent_mode(TimerBase* base, bool high_res) {
+    ClockEventDevice* device = base->clockevent;
+    bool oneshot = (device->features & CLOCK_EVT_FEAT_ONESHOT) != 0;
+    bool periodic = (device->features & CLOCK_EVT_FEAT_PERIODIC) != 0;
+    base->high_res = oneshot && (high_res || !periodic);
+    if (base->high_res) {
+        base->programmed_ns = 0; // Forca a programacao do proximo evento
+        program_next_hw_event(base);
+    } else {
+        base->programmed_ns = UINT64_MAX;
+        device->program_periodic(static_cast<uint64_t>(HW_TICK_RATE.count()));
+    }
+}
+
+/**
+ * @brief Vence os timers da base ate now_ns, enfileirando os callbacks na fila softirq da CPU.
+ * O chamador segura base->lock (IRQ, ou a thread softirq depois de um overflow).
+ * * So ponteiros vao para o anel: nenhuma alocacao em contexto de IRQ.
+ * @return true se ha trabalho para a thread softirq.
+ */
+static bool expire_timers(TimerBase* base, uint64_t current_time) {
+    TimerSoftirq* softirq = &s_timer_softirqs[base->cpu];
+    uint32_t tail = softirq->tail.load(std::memory_order_relaxed);
+    bool raise = false;
+
+    // Slots vencidos descem de nivel; os do tick atual vao para a fila precisa
+    advance_wheel(base, current_time);
+
+    // Na ordem do disparo: vencem os que ja passaram do instante mais cedo (soft_expiry_ns).
+    // Timers com folga logo atras do que acordou a CPU saem no mesmo IRQ, em vez de
+    // pedir outro; para no primeiro que ainda nao pode vencer.
+    TimelineNode* node;
+    while ((node = base->queue.leftmost()) != nullptr &&
+           timeline_entry(node, SoftwareTimer, queue_node)->soft_expiry_ns <= current_time) {
+        uint32_t depth = tail - softirq->head.load(std::memory_order_acquire);
+        if (depth == TIMER_SOFTIRQ_RING_SIZE) {
+            // Fila cheia: o resto fica vencido na base ate a thread softirq drenar
+            softirq->overflow.store(true, std::memory_order_release);
+            softirq->overflows.fetch_add(1, std::memory_order_relaxed);
+            raise = true;
+            break;
+        }
+
+        SoftwareTimer* expired_timer = timeline_entry(node, SoftwareTimer, queue_node);
+        base->queue.erase(node);
+
+        KTRACE(TIMER_EXPIRED, handle_of(expired_timer));
+
+        // Periodico atrasado (IRQ com atraso de varios periodos): um disparo so, com os
+        // periodos perdidos em overruns, em vez de vencer de novo a cada volta deste loop
+        uint64_t missed = 0;
+        if (expired_timer->period_ns != 0) {
+            missed = (current_time - expired_timer->soft_expiry_ns) / expired_timer->period_ns;
+            if (missed != 0) {
+                KTRACE(TIMER_OVERRUN, handle_of(expired_timer), missed);
+            }
+        }
+
+        // O callback roda na thread softirq da CPU (contexto de kernel thread), nao no IRQ
+        DeferredTimerCall* call = &softirq->ring[tail & (TIMER_SOFTIRQ_RING_SIZE - 1)];
+        call->callback = expired_timer->callback;
+        call->context = expired_timer->context;
+        call->raised_ns = current_time;
+        call->overruns = (missed > UINT32_MAX) ? UINT32_MAX : static_cast<uint32_t>(missed);
+        ++tail;
+        softirq->tail.store(tail, std::memory_order_release);
+        if (depth + 1 > softirq->max_depth.load(std::memory_order_relaxed)) {
+            softirq->max_depth.store(depth + 1, std::memory_order_relaxed);
+        }
+        raise = true;
+
+        if (expired_timer->period_ns != 0) {
+            // Reagendar na grade da fase original: o primeiro soft + k * periodo depois de agora
+            set_expiry(expired_timer, expired_timer->soft_expiry_ns + (missed + 1) * expired_timer->period_ns);
+            enqueue_timer(base, expired_timer);
+        } else {
+            free_timer(base, expired_timer);
+        }
+    }
+    return raise;
+}
+
+// =====================================================================
+// API
+// =====================================================================
 
 KernelTimer& KernelTimer::instance() {
     static KernelTimer s_instance;
     return s_instance;
 }
 
-uint32_t KernelTimer::setTimer(Nanoseconds duration, TimerCallback callback, void* context, bool periodic) {
-    SpinLock::Guard lock(m_lock);
-    
-    if (duration.count() == 0) {
+KernelTimer::KernelTimer() {
+    uint64_t clock_tick = tick_of(static_cast<uint64_t>(Scheduler::getKernelTime().count()));
+    for (int cpu = 0; cpu < cpu::MAX_CPU_CORES; ++cpu) {
+        s_timer_bases[cpu].cpu = static_cast<int16_t>(cpu);
+        s_timer_bases[cpu].clock_tick = clock_tick;
+    }
+}
+
+TimerHandle KernelTimer::setTimer(Nanoseconds duration, TimerCallback callback, void* context, bool periodic,
+                                  Nanoseconds slack) {
+    if (duration.count() <= 0 || slack.count() < 0) {
         Log::error(TAG, "Duracao do temporizador invalida.");
         return 0;
     }
-    
+
+    // Sempre na base local: armar em varias CPUs ao mesmo tempo nao disputa lock
+    TimerBase* base = local_base();
+    SpinLock::Guard lock(base->lock);
+
+    SoftwareTimer* timer = alloc_timer(base);
+    if (timer == nullptr) {
+        Log::error(TAG, "Sem memoria para o temporizador.");
+        return 0;
+    }
+
     // Calcula o tempo de expiracao a partir do tempo atual de alta resolucao
     Nanoseconds current_time = Scheduler::getKernelTime();
-    uint32_t new_id = ++m_next_timer_id;
-    
-    SoftwareTimer new_timer = {
-        .id = new_id,
-        .expiry_time = current_time + duration,
-        .duration = duration,
-        .callback = callback,
-        .context = context,
-        .periodic = periodic
-    };
-
-    // Insere na lista ordenada (mantendo o proximo timer a expirar no inicio)
-    s_active_timers.push_back(new_timer);
-    s_active_timers.sort(); 
-
-    Log::debug(TAG, "Temporizador setado. ID: " + std::to_string(new_id) + ", Expira em: " + std::to_string(duration.count()) + "ns");
+    timer->slack_ns = static_cast<uint64_t>(slack.count());
+    set_expiry(timer, static_cast<uint64_t>((current_time + duration).count()));
+    timer->period_ns = periodic ? static_cast<uint64_t>(duration.count()) : 0;
+    timer->callback = callback;
+    timer->context = context;
+    enqueue_timer(base, timer);
+
+    TimerHandle handle = handle_of(timer);
+    KTRACE(TIMER_SET, handle, duration.count());
 
     // O hardware do timer precisa ser re-agendado se este for o mais proximo.
-    // Exemplo: Scheduler::rescheduleNextHwTick(s_active_timers.front().expiry_time);
-    
-    return new_id;
+    program_next_hw_event(base);
+
+    return handle;
 }
 
 void KernelTimer::handleHwTimerIrq() {
     // Esta funcao e chamada em contexto de IRQ/SoftIRQ. Deve ser rapida.
-    SpinLock::Guard lock(m_lock);
-    
-    Nanoseconds current_time = Scheduler::getKernelTime();
-    
-    while (!s_active_timers.empty() && s_active_timers.front().expiry_time <= current_time) {
-        SoftwareTimer expired_timer = s_active_timers.front();
-        s_active_timers.pop_front();
-        
-        Log::info(TAG, "Temporizador " + std::to_string(expired_timer.id) + " expirou.");
-        
-        // Dispara o callback (executado em contexto de kernel thread)
-        // Isso deve ser delegado a uma thread de kernel para nao bloquear o IRQ.
-        Scheduler::dispatchDeferredCall([=]() {
-            expired_timer.callback(expired_timer.context);
-        });
-
-        if (expired_timer.periodic) {
-            // Reagendar o temporizador periodico
-            expired_timer.expiry_time += expired_timer.duration;
-            s_active_timers.push_back(expired_timer);
-            s_active_timers.sort();
-        }
-    }
-    
-    // Reagendar o proximo tick de hardware com base no proximo timer (se existir)
-    // if (!s_active_timers.empty()) { ... }
-}
-
-bool KernelTimer::cancelTimer(uint32_t timer_id) {
-    SpinLock::Guard lock(m_lock);
-
-    for (auto it = s_active_timers.begin(); it != s_active_timers.end(); ++it) {
-        if (it->id == timer_id) {
-            s_active_timers.erase(it);
-            Log::info(TAG, "Temporizador ID " + std::to_string(timer_id) + " cancelado.");
-            // Verificar se o hardware precisa de reagendamento
-            return true;
-        }
-    }
-    Log::warn(TAG, "Tentativa de cancelar ID " + std::to_string(timer_id) + " nao encontrado.");
-    return false;
+    // Cada CPU vence so a sua base (os timers de CPUs ociosas ja migraram para ca).
+    TimerBase* base = local_base();
+    bool raise;
+    {
+        SpinLock::Guard lock(base->lock);
+        raise = expire_timers(base, static_cast<uint64_t>(Scheduler::getKernelTime().count()));
+
+        // Reagendar o proximo tick de hardware com base no proximo timer (se existir).
+        // O evento programado foi consumido por este IRQ: reprograma sempre.
+        base->programmed_ns = 0;
+        program_next_hw_event(base);
+    }
+
+    // Os callbacks rodam na thread softirq da CPU, fora do IRQ
+    if (raise) {
+        Scheduler::raiseTimerSoftirq(base->cpu);
+    }
+}
+
+int KernelTimer::runSoftirq() {
+    int cpu = local_base()->cpu;
+    TimerSoftirq* softirq = &s_timer_softirqs[cpu];
+    int ran = 0;
+
+    for (;;) {
+        uint32_t head = softirq->head.load(std::memory_order_relaxed);
+        uint32_t tail = softirq->tail.load(std::memory_order_acquire);
+        if (head == tail) {
+            if (!softirq->overflow.load(std::memory_order_acquire)) {
+                break;
+            }
+            // O IRQ parou com a fila cheia: vence o resto da base agora que ha espaco
+            TimerBase* base = &s_timer_bases[cpu];
+            SpinLock::Guard lock(base->lock);
+            softirq->overflow.store(false, std::memory_order_relaxed);
+            expire_timers(base, static_cast<uint64_t>(Scheduler::getKernelTime().count()));
+            base->programmed_ns = 0;
+            program_next_hw_event(base);
+            continue;
+        }
+
+        // Um lote: tudo o que o IRQ publicou ate aqui. A posicao e liberada antes do
+        // callback, que pode armar timers (e um IRQ pode enfileirar no meio do lote).
+        softirq->batches.fetch_add(1, std::memory_order_relaxed);
+        for (; head != tail; ++head) {
+            DeferredTimerCall call = softirq->ring[head & (TIMER_SOFTIRQ_RING_SIZE - 1)];
+            softirq->head.store(head + 1, std::memory_order_release);
+            uint64_t now = static_cast<uint64_t>(Scheduler::getKernelTime().count());
+            softirq->drain_latency.record(now > call.raised_ns ? now - call.raised_ns : 0);
+            call.callback(call.context, call.overruns);
+            ++ran;
+        }
+    }
+    return ran;
+}
+
+bool KernelTimer::softirqPending(int cpu) {
+    if (cpu < 0 || cpu >= cpu::MAX_CPU_CORES) {
+        return false;
+    }
+    const TimerSoftirq* softirq = &s_timer_softirqs[cpu];
+    return softirq->head.load(std::memory_order_relaxed) != softirq->tail.load(std::memory_order_acquire) ||
+           softirq->overflow.load(std::memory_order_acquire);
+}
+
+bool KernelTimer::getSoftirqStats(int cpu, TimerSoftirqStats* out) {
+    if (cpu < 0 || cpu >= cpu::MAX_CPU_CORES || out == nullptr) {
+        return false;
+    }
+    const TimerSoftirq* softirq = &s_timer_softirqs[cpu];
+    LatencySnapshot snapshot;
+    snapshot.add(softirq->drain_latency);
+
+    out->depth = softirq->tail.load(std::memory_order_relaxed) - softirq->head.load(std::memory_order_relaxed);
+    out->max_depth = softirq->max_depth.load(std::memory_order_relaxed);
+    out->batches = softirq->batches.load(std::memory_order_relaxed);
+    out->callbacks = snapshot.count;
+    out->overflows = softirq->overflows.load(std::memory_order_relaxed);
+    out->drain_mean_ns = snapshot.mean_ns();
+    out->drain_p50_ns = snapshot.percentile(0.50);
+    out->drain_p99_ns = snapshot.percentile(0.99);
+    out->drain_max_ns = snapshot.max_ns;
+    return true;
+}
+
+bool KernelTimer::registerClockEventDevice(int cpu, ClockEventDevice* device) {
+    if (cpu < 0 || cpu >= cpu::MAX_CPU_CORES || device == nullptr ||
+        (device->features & (CLOCK_EVT_FEAT_ONESHOT | CLOCK_EVT_FEAT_PERIODIC)) == 0 || device->mult == 0) {
+        Log::error(TAG, "Timer de hardware invalido (sem modo suportado ou nao calibrado).");
+        return false;
+    }
+    TimerBase* base = &s_timer_bases[cpu];
+    SpinLock::Guard lock(base->lock);
+    if (base->clockevent != nullptr && base->clockevent != device) {
+        base->clockevent->stop();
+    }
+    base->clockevent = device;
+    set_clockevent_mode(base, s_high_res_enabled.load(std::memory_order_relaxed));
+    Log::info(TAG, std::string("CPU ") + std::to_string(cpu) + ": timer de hardware " + device->name +
+                   (base->high_res ? " em modo alta resolucao." : " em tick fixo."));
+    return true;
+}
+
+void KernelTimer::setHighResEnabled(bool enabled) {
+    s_high_res_enabled.store(enabled, std::memory_order_relaxed);
+    for (int cpu = 0; cpu < cpu::MAX_CPU_CORES; ++cpu) {
+        TimerBase* base = &s_timer_bases[cpu];
+        SpinLock::Guard lock(base->lock);
+        if (base->clockevent != nullptr) {
+            set_clockevent_mode(base, enabled);
+        }
+    }
+}
+
+bool KernelTimer::isHighResActive(int cpu) {
+    if (cpu < 0 || cpu >= cpu::MAX_CPU_CORES) {
+        return false;
+    }
+    TimerBase* base = &s_timer_bases[cpu];
+    SpinLock::Guard lock(base->lock);
+    return base->high_res;
+}
+
+bool KernelTimer::cancelTimer(TimerHandle handle) {
+    TimerBase* base;
+    SoftwareTimer* timer = lock_timer_base(handle, &base);
+    if (timer == nullptr) {
+        // Comum: o scheduler cancela timers de sleep/DL que podem ja ter disparado
+        KTRACE(TIMER_CANCEL_MISS, handle);
+        return false;
+    }
+
+    dequeue_timer(base, timer);
+    free_timer(base, timer);
+    KTRACE(TIMER_CANCEL, handle);
+
+    // Sem o mais proximo, o hardware nao precisa acordar no instante antigo. Base de
+    // outra CPU fica como esta: um IRQ sem timers vencidos custa menos que um IPI.
+    if (base == local_base()) {
+        program_next_hw_event(base);
+    }
+    base->lock.unlock();
+    return true;
+}
+
+bool KernelTimer::rearmTimer(TimerHandle handle, Nanoseconds duration) {
+    if (duration.count() <= 0) {
+        Log::error(TAG, "Duracao do temporizador invalida.");
+        return false;
+    }
+
+    TimerBase* base;
+    SoftwareTimer* timer = lock_timer_base(handle, &base);
+    if (timer == nullptr) {
+        KTRACE(TIMER_CANCEL_MISS, handle);
+        return false;
+    }
+
+    // Mesmo slot do pool, mesma base e mesmo handle: so muda o vencimento (e o periodo); a folga fica
+    dequeue_timer(base, timer);
+    set_expiry(timer, static_cast<uint64_t>((Scheduler::getKernelTime() + duration).count()));
+    if (timer->period_ns != 0) {
+        timer->period_ns = static_cast<uint64_t>(duration.count());
+    }
+    enqueue_timer(base, timer);
+    KTRACE(TIMER_SET, handle, duration.count());
+
+    program_next_hw_event(base);
+    base->lock.unlock();
+    return true;
+}
+
+void KernelTimer::migrateTimers(int from_cpu, int to_cpu) {
+    if (from_cpu == to_cpu || from_cpu < 0 || from_cpu >= cpu::MAX_CPU_CORES ||
+        to_cpu < 0 || to_cpu >= cpu::MAX_CPU_CORES) {
+        return;
+    }
+    TimerBase* from = &s_timer_bases[from_cpu];
+    TimerBase* to = &s_timer_bases[to_cpu];
+
+    // Ordem fixa (menor CPU primeiro): duas migracoes cruzadas nao se travam
+    TimerBase* first = (from_cpu < to_cpu) ? from : to;
+    TimerBase* second = (from_cpu < to_cpu) ? to : from;
+    first->lock.lock();
+    second->lock.lock();
+
+    // Rearma cada timer relativo ao relogio da base de destino (vencimento inalterado)
+    uint64_t moved = 0;
+    for (int level = 0; level < WHEEL_LEVELS; ++level) {
+        while (from->pending[level] != 0) {
+            int slot = __builtin_ctzll(from->pending[level]);
+            list_head* head = &from->wheel[level][slot];
+            while (!list_empty(head)) {
+                SoftwareTimer* timer = list_entry(head->next, SoftwareTimer, wheel_node);
+                list_del_init(&timer->wheel_node);
+                timer->cpu.store(to->cpu, std::memory_order_relaxed);
+                enqueue_timer(to, timer);
+                moved++;
+            }
+            from->pending[level] &= ~(1ULL << slot);
+        }
+    }
+    TimelineNode* node;
+    while ((node = from->queue.leftmost()) != nullptr) {
+        SoftwareTimer* timer = timeline_entry(node, SoftwareTimer, queue_node);
+        from->queue.erase(node);
+        timer->cpu.store(to->cpu, std::memory_order_relaxed);
+        enqueue_timer(to, timer);
+        moved++;
+    }
+
+    if (moved != 0) {
+        KTRACE(TIMER_MIGRATE, moved, from_cpu, to_cpu);
+        program_next_hw_event(from); // Nada pendente: o comparador da CPU ociosa fica parado
+        program_next_hw_event(to);
+    }
+
+    second->lock.unlock();
+    first->lock.unlock();
 }
 
 } // namespace kernel
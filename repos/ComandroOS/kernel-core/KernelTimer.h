@@ -10,10 +10,47 @@ namespace kernel {
 
 using Nanoseconds = std::chrono::nanoseconds;
 
-using TimerCallback = void (*)(void* context);
+/**
+ * @brief Callback de um temporizador (contexto de kernel thread).
+ * @param overruns Periodos perdidos de um timer periodico atrasado (IRQ ou kernel thread
+ *        travados): vencem todos numa chamada so, nao em rajada. 0 no one-shot.
+ */
+using TimerCallback = void (*)(void* context, uint32_t overruns);
+
+class ClockEventDevice;
+
+/**
+ * @brief Handle opaco de um temporizador armado (0 = nenhum/falha).
+ * * Codifica o slot do pool e a sua geracao: cancelar e rearmar sao O(1), e um
+ *   handle guardado de um timer que ja venceu ou foi cancelado nunca atinge o
+ *   timer que reutilizou o mesmo slot.
+ */
+using TimerHandle = uint64_t;
+
+/**
+ * @brief Contadores da fila softirq de timers de uma CPU (Nucleum, dexter).
+ */
+struct TimerSoftirqStats {
+    uint32_t depth;             // Callbacks enfileirados agora
+    uint32_t max_depth;         // Maior profundidade vista (capacidade fixa do anel)
+    uint64_t batches;           // Lotes drenados pela thread softirq
+    uint64_t callbacks;
+    uint64_t overflows;         // IRQs que acharam a fila cheia (os timers esperaram na base)
+    uint64_t drain_mean_ns;     // IRQ -> inicio do callback
+    uint64_t drain_p50_ns;
+    uint64_t drain_p99_ns;
+    uint64_t drain_max_ns;
+};
 
 /**
  * @brief Gerencia os temporizadores de hardware e software do kernel.
+ * * Uma base de timers por CPU, cada uma com o seu lock: setTimer() arma na base
+ *   local e o IRQ de cada CPU so vence a sua base.
+ * * Callbacks vencidos vao para um anel fixo por CPU (sem alocar no IRQ) e rodam na
+ *   thread softirq de timers da CPU, em lotes (runSoftirq()).
+ * * Modo alta resolucao (padrao, com timer de hardware one-shot): o comparador de cada
+ *   CPU e reprogramado para o vencimento exato mais proximo ao armar, cancelar e
+ *   vencer; a resolucao dos timers e a do contador, nao a do tick.
  */
 class KernelTimer {
 public:
@@ -22,15 +59,66 @@ public:
     // Funcao critica chamada pelo IRQ do timer de hardware.
     void handleHwTimerIrq();
 
-    // Registra um temporizador de software one-shot ou periodico.
-    uint32_t setTimer(Nanoseconds duration, TimerCallback callback, void* context, bool periodic);
+    /**
+     * @brief Roda os callbacks vencidos da CPU atual, em lotes, ate a fila esvaziar.
+     * * Chamado so pela thread softirq de timers da CPU (Scheduler::raiseTimerSoftirq a acorda).
+     * @return Callbacks executados.
+     */
+    int runSoftirq();
+
+    // true se a fila softirq da CPU tem callbacks (ou timers vencidos esperando espaco).
+    bool softirqPending(int cpu);
+
+    // @return false se a CPU nao existe.
+    bool getSoftirqStats(int cpu, TimerSoftirqStats* out);
+
+    /**
+     * @brief Registra um temporizador de software one-shot ou periodico.
+     * * Periodico: vence em agora + k * duration (sem deriva); os periodos que passaram
+     *   sem disparo sao contados em overruns, e o timer segue na mesma fase.
+     * @param slack Atraso tolerado alem de duration. Timers nao criticos (polling de GPS,
+     *        bateria, upload de logs) vencem juntos dentro da folga: um wakeup da CPU
+     *        atende varios. 0 = disparo no instante exato.
+     */
+    TimerHandle setTimer(Nanoseconds duration, TimerCallback callback, void* context, bool periodic,
+                         Nanoseconds slack = Nanoseconds(0));
     
-    bool cancelTimer(uint32_t timer_id);
+    // false se o timer ja venceu (one-shot) ou foi cancelado.
+    bool cancelTimer(TimerHandle handle);
+
+    /**
+     * @brief Rearma um timer ainda armado para vencer daqui a duration (mantem o handle e a folga).
+     * * Periodico: duration passa a ser o periodo.
+     * @return false se o timer ja venceu (one-shot) ou foi cancelado; o chamador arma outro.
+     */
+    bool rearmTimer(TimerHandle handle, Nanoseconds duration);
+
+    /**
+     * @brief Move os timers armados na base de from_cpu para a de to_cpu (handles continuam valendo).
+     * * Chamado pelo scheduler quando from_cpu para o tick (ociosa, NO_HZ): os timers
+     *   passam a vencer numa CPU ocupada e a ociosa nao acorda por eles.
+     * * O(timers da base). Os vencimentos nao mudam; o hardware das duas CPUs e reprogramado.
+     */
+    void migrateTimers(int from_cpu, int to_cpu);
+
+    /**
+     * @brief Registra o timer de hardware (ja calibrado, ver ClockEventDevice::configure) de uma CPU.
+     * * Chamado pelo codigo de arquitetura no boot de cada CPU. One-shot com o modo de
+     *   alta resolucao ligado; senao tick fixo de 1ms.
+     */
+    bool registerClockEventDevice(int cpu, ClockEventDevice* device);
+
+    /**
+     * @brief Liga/desliga o modo de alta resolucao em todas as CPUs.
+     * * Desligado: tick fixo de 1ms e timers com a resolucao do tick (comparacao, hardware
+     *   com one-shot instavel).
+     */
+    void setHighResEnabled(bool enabled);
+
+    bool isHighResActive(int cpu);
 
 private:
-    KernelTimer() = default;
-    SpinLock m_lock;
-    uint32_t m_next_timer_id;
+    KernelTimer();
 };
 
 } // namespace kernel
@@ -9,7 +9,6 @@ namespace binder {
 namespace server {
 
 using kernel::Log;
-using kernel::Scheduler;
 
 static constexpr const char* TAG = "BinderCpuMask";
 
@@ -68,8 +67,8 @@ bool CpuMaskManager::setThreadAffinity(kernel::Thread::TID tid, CpuMaskArray mas
     Log::info(TAG, "Aplicando cpumask " + std::to_string(mask) + " a thread Binder TID: " + std::to_string(tid));
     
     // Chamada critica para o agendador do kernel
-    // O Scheduler e responsavel por mover a thread para um dos cores setados.
-    if (!Scheduler::setAffinity(tid, mask)) {
+    // O ComandroScheduler acha a thread pela TID e a move para um dos cores setados.
+    if (!scheduler::ComandroScheduler::instance().set_thread_affinity(static_cast<uint32_t>(tid), mask)) {
         Log::critical(TAG, "Falha ao definir a afinidade da thread Binder no Scheduler.");
         return false;
     }
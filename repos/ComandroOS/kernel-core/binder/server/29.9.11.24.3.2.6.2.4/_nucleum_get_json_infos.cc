@@ -15,8 +15,35 @@ namespace kernel {
 namespace binder {
 namespace nucleum {
 
-// Tamanho maximo do buffer JSON de diagnostico.
-static constexpr size_t JSON_BUFFER_SIZE = 4096;
+// Pior caso de cada parte do JSON de diagnostico (campos numericos com 20 digitos)
+static constexpr size_t JSON_FIXED_SIZE = 2048;          // sistema, memoria, binder, throttle
+static constexpr size_t JSON_CORE_ENTRY_SIZE = 160;      // Um nucleo em "cpus"
+static constexpr size_t JSON_LATENCY_LEVEL_SIZE = 448;   // Um nivel de "latencia_agendamento", sem as CPUs
+static constexpr size_t JSON_LATENCY_CPU_SIZE = 112;     // Uma CPU dentro de um nivel
+
+/**
+ * @brief Tamanho do buffer JSON de diagnostico para a topologia atual.
+ * * Os histogramas por CPU dominam: LATENCY_PRIORITY_LEVELS entradas por CPU (~50 KB com 64 CPUs).
+ */
+static size_t diagnostic_json_capacity() {
+    size_t cores = static_cast<size_t>(cpu::get_topology_info().total_core_count);
+    size_t sched_cpus = static_cast<size_t>(scheduler::ComandroScheduler::instance().get_cpu_count());
+    return JSON_FIXED_SIZE + cores * JSON_CORE_ENTRY_SIZE +
+           scheduler::LATENCY_PRIORITY_LEVELS * (JSON_LATENCY_LEVEL_SIZE + sched_cpus * JSON_LATENCY_CPU_SIZE);
+}
+
+/**
+ * @brief true se o documento foi escrito inteiro: sobrou espaco no buffer e ele termina no "}" final.
+ * * Um JSON cortado (ou com appends descartados) nao pode chegar ao Dexter como se fosse valido.
+ */
+static bool diagnostic_json_complete(const StringBuffer& json, size_t capacity) {
+    size_t size = json.get_size();
+    if (size < 2 || size + 1 >= capacity) {
+        return false;
+    }
+    const char* text = json.get_string();
+    return text[size - 2] == '}' && text[size - 1] == '\n';
+}
 
 /**
  * @brief Serializa o estado atual do kernel em um buffer JSON.
@@ -24,7 +51,7 @@ static constexpr size_t JSON_BUFFER_SIZE = 4096;
  */
 StringBuffer get_diagnostic_json() {
     // Usa StringBuffer do kernel para construcao eficiente de strings.
-    StringBuffer json_output(JSON_BUFFER_SIZE);
+    StringBuffer json_output(diagnostic_json_capacity());
     
     // =================================================================
     // 1. DADOS BASE (Memoria, Uptime)
@@ -72,7 +99,53 @@ StringBuffer get_diagnostic_json() {
         json_output.append("      \"carga_perc\": %u\n", load);
         json_output.append("    }%s\n", (i < topo.total_core_count - 1 ? "," : ""));
     }
-    json_output.append("  ]\n"); // Fim de "cpus"
+    json_output.append("  ],\n"); // Fim de "cpus"
+
+    // =================================================================
+    // 4. LATENCIA WAKEUP -> EXECUCAO (histogramas do ComandroScheduler)
+    // =================================================================
+    auto& sched = scheduler::ComandroScheduler::instance();
+    int sched_cpus = sched.get_cpu_count();
+
+    json_output.append("  \"latencia_agendamento\": [\n");
+    for (int level = 0; level < scheduler::LATENCY_PRIORITY_LEVELS; ++level) {
+        scheduler::SchedLatencySummary total;
+        sched.get_wakeup_latency(level, -1, &total);
+
+        json_output.append("    {\n");
+        json_output.append("      \"nivel\": \"%s\",\n", scheduler::LATENCY_LEVEL_NAMES[level]);
+        json_output.append("      \"prioridade\": %d,\n", total.priority);
+        json_output.append("      \"amostras\": %lu,\n", total.samples);
+        json_output.append("      \"media_ns\": %lu,\n", total.mean_ns);
+        json_output.append("      \"p50_ns\": %lu,\n", total.p50_ns);
+        json_output.append("      \"p90_ns\": %lu,\n", total.p90_ns);
+        json_output.append("      \"p99_ns\": %lu,\n", total.p99_ns);
+        json_output.append("      \"p999_ns\": %lu,\n", total.p999_ns);
+        json_output.append("      \"max_ns\": %lu,\n", total.max_ns);
+
+        // Por CPU: so a cauda, para localizar o nucleo que causa a regressao
+        json_output.append("      \"cpus\": [");
+        for (int cpu = 0; cpu < sched_cpus; ++cpu) {
+            scheduler::SchedLatencySummary per_cpu;
+            sched.get_wakeup_latency(level, cpu, &per_cpu);
+            json_output.append("{\"id\": %d, \"amostras\": %lu, \"p99_ns\": %lu, \"p999_ns\": %lu}%s",
+                               cpu, per_cpu.samples, per_cpu.p99_ns, per_cpu.p999_ns,
+                               (cpu < sched_cpus - 1 ? ", " : ""));
+        }
+        json_output.append("]\n");
+        json_output.append("    }%s\n", (level < scheduler::LATENCY_PRIORITY_LEVELS - 1 ? "," : ""));
+    }
+    json_output.append("  ],\n"); // Fim de "latencia_agendamento"
+
+    // 5. THROTTLE DO SCHEDULER (orcamento RT por CPU e cota do grupo background)
+    scheduler::SchedThrottleStats throttle;
+    sched.get_throttle_stats(-1, &throttle);
+    json_output.append("  \"throttle_agendamento\": {\n");
+    json_output.append("    \"rt_throttles\": %lu,\n", throttle.rt_throttle_count);
+    json_output.append("    \"rt_throttled_ns\": %lu,\n", throttle.rt_throttled_ns);
+    json_output.append("    \"background_throttles\": %lu,\n", throttle.bg_throttle_count);
+    json_output.append("    \"background_throttled_ns\": %lu\n", throttle.bg_throttled_ns);
+    json_output.append("  }\n"); // Fim de "throttle_agendamento"
 
     json_output.append("}\n"); // Fim do Objeto Principal
 
@@ -91,6 +164,10 @@ int handle_json_info_command(StringBuffer& output_buffer) {
         output_buffer.append("ERROR: Falha ao gerar JSON do Nucleum.");
         return -1;
     }
+    if (!diagnostic_json_complete(json_data, diagnostic_json_capacity())) {
+        output_buffer.append("ERROR: JSON do Nucleum truncado (buffer de diagnostico pequeno demais).");
+        return -1;
+    }
     
     // Copia a string JSON para o buffer de resposta do Dexter.
     output_buffer.append(json_data.get_string());
@@ -1,6 +1,7 @@
 #include "ComandroIpcBus.h"
 #include <comandro/kernel/spinlock.h>
 #include <comandro/kernel/log.h>
+#include <comandro/kernel/cpu_topology.h> // Para cpu::get_current_cpu_id()
 #include <cstring>
 
 namespace comandro {
@@ -10,6 +11,8 @@ namespace ipc {
 using kernel::Log;
 using kernel::SpinLock;
 using kernel::Thread;
+using scheduler::ComandroScheduler;
+using scheduler::ThreadDescriptor;
 
 static constexpr const char* TAG = "ComandroIpcBus";
 static SpinLock s_registration_lock;
@@ -27,6 +30,10 @@ ComandroIpcBus::ComandroIpcBus() : m_next_node_id(1) {
         m_nodes[i].message_semaphore.init(0); 
         m_nodes[i].rx_buffer.head = 0;
         m_nodes[i].rx_buffer.tail = 0;
+        INIT_LIST_HEAD(&m_nodes[i].pending_calls);
+        m_nodes[i].nr_pending_calls = 0;
+        m_nodes[i].active_call = nullptr;
+        m_nodes[i].server_thread = nullptr;
     }
     Log::info(TAG, "Comandro IPC Bus (C-Bus) inicializado. Max nos: " + std::to_string(MAX_BUS_NODES));
 }
@@ -156,6 +163,121 @@ bool ComandroIpcBus::receive(BusNodeID self_id, IpcMessage& out_message, std::ch
     return true;
 }
 
+// --- Chamadas Sincronas (request/reply com troca direta de CPU) ---
+
+bool ComandroIpcBus::call_replied(void* context) {
+    return static_cast<SyncCall*>(context)->replied.load();
+}
+
+bool ComandroIpcBus::has_pending_calls(void* context) {
+    return static_cast<BusNode*>(context)->nr_pending_calls.load() != 0;
+}
+
+bool ComandroIpcBus::call(BusNodeID destination, const IpcMessage& request, IpcMessage& out_reply) {
+    if (destination == 0 || destination >= MAX_BUS_NODES || !m_nodes[destination].is_active) {
+        Log::warn(TAG, "Chamada sincrona para no inativo/invalido: " + std::to_string(destination));
+        return false;
+    }
+
+    ComandroScheduler& sched = ComandroScheduler::instance();
+    ThreadDescriptor* client = sched.get_current_thread(cpu::get_current_cpu_id());
+    if (client == nullptr) {
+        return false;
+    }
+
+    BusNode& node = m_nodes[destination];
+    SyncCall call;
+    call.request = &request;
+    call.reply = &out_reply;
+    call.client = client;
+    call.replied = false;
+
+    // Acorda o servidor (com call_lock: ele nao sai de receiveCall no meio) e passa a CPU
+    // direto para ele enquanto espera a resposta. A barreira pareia com a de block_until:
+    // o servidor ve a chamada ou o wakeup.
+    node.call_lock.lock();
+    list_add_tail(&call.link, &node.pending_calls);
+    node.nr_pending_calls.fetch_add(1);
+    ThreadDescriptor* server = node.server_thread;
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (server != nullptr) {
+        sched.wake_up_thread(server);
+    }
+    node.call_lock.unlock();
+    while (!call.replied.load()) {
+        sched.block_until(&ComandroIpcBus::call_replied, &call, server);
+        server = nullptr; // Acordou sem resposta: volta a esperar, sem nova doacao
+    }
+    return true;
+}
+
+bool ComandroIpcBus::receiveCall(BusNodeID self_id, IpcMessage& out_request) {
+    if (self_id == 0 || self_id >= MAX_BUS_NODES || !m_nodes[self_id].is_active) {
+        return false;
+    }
+
+    ComandroScheduler& sched = ComandroScheduler::instance();
+    ThreadDescriptor* self = sched.get_current_thread(cpu::get_current_cpu_id());
+    if (self == nullptr) {
+        return false;
+    }
+
+    BusNode& node = m_nodes[self_id];
+    node.call_lock.lock();
+    if (node.active_call != nullptr) {
+        node.call_lock.unlock();
+        Log::error(TAG, "receiveCall com chamada ainda sem resposta no no " + std::to_string(self_id));
+        return false;
+    }
+    node.server_thread = self;
+    while (list_empty(&node.pending_calls)) {
+        node.call_lock.unlock();
+        sched.block_until(&ComandroIpcBus::has_pending_calls, &node, nullptr);
+        node.call_lock.lock();
+    }
+
+    SyncCall* call = list_entry(node.pending_calls.next, SyncCall, link);
+    list_del_init(&call->link);
+    node.nr_pending_calls.fetch_sub(1);
+    node.active_call = call;
+    // So e acordado quem espera em receiveCall: um descritor guardado depois disso pode
+    // ser de uma thread que ja saiu (e o slab o reutilizar)
+    node.server_thread = nullptr;
+    node.call_lock.unlock();
+
+    // O cliente fica bloqueado ate reply(): a requisicao continua valida
+    out_request = *call->request;
+    return true;
+}
+
+bool ComandroIpcBus::reply(BusNodeID self_id, const IpcMessage& reply_message) {
+    if (self_id == 0 || self_id >= MAX_BUS_NODES || !m_nodes[self_id].is_active) {
+        return false;
+    }
+
+    BusNode& node = m_nodes[self_id];
+    node.call_lock.lock();
+    SyncCall* call = node.active_call;
+    node.active_call = nullptr;
+    node.call_lock.unlock();
+    if (call == nullptr) {
+        Log::warn(TAG, "reply sem chamada pendente no no " + std::to_string(self_id));
+        return false;
+    }
+
+    // Depois de replied o cliente pode retornar e desfazer a SyncCall: so client e usado
+    ThreadDescriptor* client = call->client;
+    *call->reply = reply_message;
+    call->replied.store(true);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    // O cliente (tipicamente mais urgente) roda ja; o servidor volta a fila
+    ComandroScheduler& sched = ComandroScheduler::instance();
+    sched.wake_up_thread(client);
+    sched.yield_to(client);
+    return true;
+}
+
 } // namespace ipc
 } // namespace kernel
 } // namespace comandro
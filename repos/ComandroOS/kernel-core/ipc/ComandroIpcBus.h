@@ -3,7 +3,11 @@
 
 #include <comandro/kernel/thread.h>
 #include <comandro/kernel/semaphore.h>
+#include <comandro/kernel/spinlock.h>
+#include <comandro/kernel/list.h>
+#include <comandro/kernel/scheduler.h> // ComandroScheduler (troca direta no IPC sincrono)
 #include <comandro/kernel/types.h>
+#include <atomic>
 #include <string>
 #include <chrono>
 
@@ -59,8 +63,38 @@ public:
      */
     bool receive(BusNodeID self_id, IpcMessage& out_message, std::chrono::milliseconds timeout);
 
+    /**
+     * @brief Chamada sincrona: envia a requisicao e bloqueia ate o servico responder.
+     * * A requisicao vai direto ao servidor, sem passar pelo ring buffer. Se o servidor
+     *   estiver pronto nesta CPU, o cliente lhe entrega a CPU (yield_to) em vez de
+     *   passar por um pick completo.
+     * @return false se o destino e invalido ou o chamador nao e uma thread do scheduler.
+     */
+    bool call(BusNodeID destination, const IpcMessage& request, IpcMessage& out_reply);
+
+    /**
+     * @brief Servidor: bloqueia ate a proxima chamada sincrona para este no.
+     * @return false se o no e invalido ou a chamada anterior ainda nao foi respondida.
+     */
+    bool receiveCall(BusNodeID self_id, IpcMessage& out_request);
+
+    /**
+     * @brief Servidor: responde a chamada recebida por receiveCall e entrega a CPU ao cliente.
+     * @return false se nao ha chamada pendente de resposta.
+     */
+    bool reply(BusNodeID self_id, const IpcMessage& reply_message);
+
 private:
     ComandroIpcBus();
+
+    // Chamada sincrona em andamento: vive na pilha do cliente ate a resposta
+    struct SyncCall {
+        const IpcMessage* request;
+        IpcMessage* reply;
+        scheduler::ThreadDescriptor* client;
+        std::atomic<bool> replied;
+        list_head link;                 // Em BusNode::pending_calls
+    };
     
     // Estrutura de dados para cada no no barramento
     struct BusNode {
@@ -69,8 +103,19 @@ private:
         RingBuffer rx_buffer; // Buffer de Recebimento
         kernel::Semaphore message_semaphore; // Para sinalizar mensagens (sleep/wake)
         bool is_active;
+
+        // Chamadas sincronas (call/receiveCall/reply), protegidas por call_lock
+        kernel::SpinLock call_lock;
+        list_head pending_calls;                    // SyncCall ainda nao recebidas (FIFO)
+        std::atomic<uint32_t> nr_pending_calls;     // Lido sem lock pela espera do servidor
+        SyncCall* active_call;                      // Recebida e ainda sem resposta
+        scheduler::ThreadDescriptor* server_thread; // Thread esperando em receiveCall (nullptr fora dele)
     };
 
+    // Condicoes de espera do scheduler (block_until)
+    static bool call_replied(void* context);
+    static bool has_pending_calls(void* context);
+
     BusNode m_nodes[MAX_BUS_NODES];
     volatile BusNodeID m_next_node_id;
 };
@@ -0,0 +1,41 @@
+#ifndef COMANDRO_KERNEL_SCHEDULER_BANDWIDTH_H
+#define COMANDRO_KERNEL_SCHEDULER_BANDWIDTH_H
+
+#include <stdint.h>
+
+namespace comandro {
+namespace kernel {
+namespace scheduler {
+
+// =====================================================================
+// Controle de banda: orcamento RT por CPU e cota do grupo CRAN_BACKGROUND
+// Uma classe throttled so roda numa CPU que, sem ela, ficaria ociosa:
+// o limite protege quem esta esperando (UI, input) sem desperdicar CPU.
+// =====================================================================
+
+// RT: ate 8ms a cada 10ms por CPU (a UI recebe pelo menos 2ms por periodo)
+static constexpr uint64_t RT_PERIOD_NS_DEFAULT = 10000000;
+static constexpr uint64_t RT_RUNTIME_NS_DEFAULT = 8000000;
+
+// CRAN_BACKGROUND (e abaixo): ate metade da capacidade total de CPU a cada 20ms
+static constexpr uint64_t BG_PERIOD_NS_DEFAULT = 20000000;
+static constexpr uint32_t BG_QUOTA_PERCENT_DEFAULT = 50;
+// Fatia da cota global que uma CPU retira de cada vez (evita disputar o pool a cada tick)
+static constexpr uint64_t BG_SLICE_NS = 1000000;
+
+/**
+ * @brief Contadores de throttle de uma CPU (ou de todas), para diagnostico.
+ * * *_throttled_ns soma os intervalos ja encerrados (um throttle em curso conta ao terminar).
+ */
+struct SchedThrottleStats {
+    uint64_t rt_throttle_count;
+    uint64_t rt_throttled_ns;
+    uint64_t bg_throttle_count;
+    uint64_t bg_throttled_ns;
+};
+
+} // namespace scheduler
+} // namespace kernel
+} // namespace comandro
+
+#endif // COMANDRO_KERNEL_SCHEDULER_BANDWIDTH_H
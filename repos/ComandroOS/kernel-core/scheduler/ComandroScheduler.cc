@@ -2,23 +2,249 @@
 #include <comandro/kernel/log.h>
 #include <comandro/kernel/lock.h> // Simula um spinlock
 #include <comandro/kernel/system_time.h> // Para SystemTime::get_current_ns()
+#include <comandro/kernel/cpu_topology.h> // Para cpu::get_current_cpu_id()
+#include <comandro/kernel/KernelTimer.h> // Timers one-shot do sleep
+#include <comandro/kernel/trace.h> // KTRACE (tracing binario do hot path)
 
 namespace comandro {
 namespace kernel {
 namespace scheduler {
 
-// O Spinlock protege as filas de execucao (runqueues)
-static SpinLock runqueue_lock; 
 static constexpr const char* TAG = "ComandroScheduler";
 
-ComandroScheduler::ComandroScheduler() {
-    // Inicializa as listas do RT runqueue (uma lista para cada prioridade)
-    for (int i = 0; i < 100; ++i) {
-        INIT_LIST_HEAD(&rt_runqueue[i]);
+// Intervalo do balanceamento periodico entre CPUs
+static constexpr uint64_t BALANCE_INTERVAL_NS = 4000000; // 4ms
+// Limite de threads migradas por rodada de balanceamento
+static constexpr int MAX_PULL_PER_BALANCE = 8;
+// Limite de nos CRAN inspecionados ao procurar uma thread migravel
+static constexpr int MAX_MIGRATE_SCAN = 32;
+// Threads da wake_list ativadas por aquisicao do lock (limita o tempo com o lock seguro)
+static constexpr int WAKE_LIST_BATCH = 16;
+// Utilizacao inicial de uma thread nova, ate o PELT ter historico
+static constexpr uint32_t PELT_INITIAL_UTIL = SCHED_CAPACITY_SCALE / 4;
+// Campos de CpuRunqueue::util_snapshot (util_avg ocupa os bits 0-10)
+static constexpr uint64_t UTIL_SNAPSHOT_IDLE = 1ULL << 11;
+static constexpr int UTIL_SNAPSHOT_TIME_SHIFT = 12;
+static constexpr uint64_t UTIL_SNAPSHOT_UTIL_MASK = UTIL_SNAPSHOT_IDLE - 1;
+
+// Threads com prioridade >= V-Sync vao para as filas RT; o resto e CRAN.
+static inline bool is_rt_priority(Priority priority) {
+    return priority >= PRIORITY_RT_DISPLAY_VSYNC;
+}
+
+static inline CpuAffinityMask cpu_bit(int cpu) {
+    return 1ULL << cpu;
+}
+
+// Grupo background: servicos CRAN_BACKGROUND e abaixo (rede, GC, uploads de log)
+static inline bool is_background_priority(Priority priority) {
+    return priority <= PRIORITY_CRAN_BACKGROUND;
+}
+
+// =====================================================================
+// Tabela de Pesos CRAN
+// =====================================================================
+
+// Granularidade minima de uma fatia CRAN; threads novas comecam uma fatia atras
+static constexpr uint64_t CRAN_MIN_GRANULARITY_NS = 750000; // 0.75ms
+// Credito maximo de uma thread que acorda (metade da latencia alvo de 6ms)
+static constexpr uint64_t CRAN_WAKEUP_CREDIT_NS = 3000000; // 3ms
+
+// Peso de referencia: PRIORITY_CRAN_NORMAL tem vruntime igual ao tempo real
+static constexpr uint32_t CRAN_WEIGHT_NORMAL = 1024;
+
+// Escala geometrica de 40 degraus (~1.25x por degrau, ~10% de CPU por degrau).
+// Indice 20 = peso de referencia.
+static constexpr uint32_t CRAN_WEIGHT_STEPS[40] = {
+    88761, 71755, 56483, 46273, 36291,
+    29154, 23254, 18705, 14949, 11916,
+     9548,  7620,  6100,  4904,  3906,
+     3121,  2501,  1991,  1586,  1277,
+     1024,   820,   655,   526,   423,
+      335,   272,   215,   172,   137,
+      110,    87,    70,    56,    45,
+       36,    29,    23,    18,    15,
+};
+
+/**
+ * @brief Degrau da escala para um nivel CRAN.
+ * * PRIORITY_CRAN_NORMAL (50) = degrau 20; PRIORITY_UI_INTERACTIVE (70) = degrau 10 (~9x);
+ * * PRIORITY_CRAN_BACKGROUND (20) = degrau 32 (~1/15); PRIORITY_VERY_LOW (1) = degrau 39 (~1/68).
+ */
+static constexpr int cran_weight_step(int priority) {
+    if (priority >= PRIORITY_CRAN_NORMAL) {
+        return 20 - (priority - PRIORITY_CRAN_NORMAL) / 2;
+    }
+    return 20 + ((PRIORITY_CRAN_NORMAL - priority) * 19 + 24) / 49;
+}
+
+// Peso de cada nivel CRAN (0..PRIORITY_UI_INTERACTIVE), calculado em tempo de compilacao
+struct CranWeightTable {
+    uint32_t weight[PRIORITY_UI_INTERACTIVE + 1];
+
+    constexpr CranWeightTable() : weight() {
+        for (int priority = 0; priority <= PRIORITY_UI_INTERACTIVE; ++priority) {
+            weight[priority] = CRAN_WEIGHT_STEPS[cran_weight_step(priority < 1 ? 1 : priority)];
+        }
+    }
+};
+
+static constexpr CranWeightTable s_cran_weights;
+
+static_assert(s_cran_weights.weight[PRIORITY_CRAN_NORMAL] == CRAN_WEIGHT_NORMAL,
+              "PRIORITY_CRAN_NORMAL deve ter o peso de referencia");
+
+static inline uint32_t cran_weight(Priority priority) {
+    return s_cran_weights.weight[priority <= PRIORITY_UI_INTERACTIVE ? priority : PRIORITY_UI_INTERACTIVE];
+}
+
+/**
+ * @brief Converte tempo real em tempo virtual: delta * peso_referencia / peso_da_thread.
+ */
+static inline uint64_t calc_delta_fair(uint64_t delta_ns, const ThreadDescriptor* td) {
+    uint32_t weight = cran_weight(td->priority);
+    if (weight == CRAN_WEIGHT_NORMAL) {
+        return delta_ns;
+    }
+    return delta_ns * CRAN_WEIGHT_NORMAL / weight;
+}
+
+// =====================================================================
+// Classe Deadline (EDF + CBS)
+// =====================================================================
+
+// Banda em ponto fixo: (1 << DL_BW_SHIFT) = uma CPU inteira
+static constexpr int DL_BW_SHIFT = 20;
+// Banda DL maxima por CPU (95%): RT e CRAN nunca ficam sem CPU, mesmo com as reservas cheias
+static constexpr uint64_t DL_BANDWIDTH_LIMIT = (95ULL << DL_BW_SHIFT) / 100;
+
+// Classe de agendamento efetiva de uma thread
+enum SchedClass {
+    SCHED_CLASS_DL,
+    SCHED_CLASS_RT,
+    SCHED_CLASS_CRAN,
+};
+
+static inline bool is_dl_thread(const ThreadDescriptor* td) {
+    return td->dl.runtime_ns != 0;
+}
+
+static inline SchedClass sched_class_of(const ThreadDescriptor* td) {
+    if (is_dl_thread(td)) {
+        return SCHED_CLASS_DL;
+    }
+    return is_rt_priority(td->priority) ? SCHED_CLASS_RT : SCHED_CLASS_CRAN;
+}
+
+// Timeline CRAN da thread: o grupo background tem a sua, para o throttle da cota
+static inline Timeline* cran_timeline_of(CpuRunqueue* rq, const ThreadDescriptor* td) {
+    return is_background_priority(td->priority) ? &rq->bg_timeline : &rq->cran_timeline;
+}
+
+// Enfileirada, a chave e o vruntime: a comparacao nao sai da linha de cache do no
+static inline uint64_t cran_vruntime_of(TimelineNode* node) {
+    return node->key;
+}
+
+static inline bool valid_dl_params(const DeadlineParams& params) {
+    return params.runtime_ns > 0 && params.runtime_ns <= params.deadline_ns &&
+           params.deadline_ns <= params.period_ns;
+}
+
+static inline uint64_t dl_bandwidth_of(const DeadlineParams& params) {
+    return (params.runtime_ns << DL_BW_SHIFT) / params.period_ns;
+}
+
+/**
+ * @brief Reserva 'add' e devolve 'remove' da banda DL da CPU, se o total couber no limite.
+ */
+static bool dl_reserve_bandwidth(CpuRunqueue* rq, uint64_t add, uint64_t remove) {
+    uint64_t used = rq->dl_bandwidth.load(std::memory_order_relaxed);
+    uint64_t updated;
+    do {
+        updated = used - remove + add;
+        if (add > remove && updated > DL_BANDWIDTH_LIMIT) {
+            return false;
+        }
+    } while (!rq->dl_bandwidth.compare_exchange_weak(used, updated, std::memory_order_relaxed));
+    return true;
+}
+
+/**
+ * @brief A thread recem-enfileirada deve tirar a atual da CPU sem esperar o tick?
+ * * Classe mais alta (DL > RT > CRAN, com RT_EMERGENCY acima de tudo), deadline mais
+ *   proximo entre threads DL, ou prioridade mais alta nas demais.
+ */
+static bool should_preempt(const ThreadDescriptor* td, const ThreadDescriptor* current) {
+    if (current == nullptr || current == td) {
+        return current == nullptr;
+    }
+    if (td->priority == PRIORITY_RT_EMERGENCY || current->priority == PRIORITY_RT_EMERGENCY) {
+        return td->priority > current->priority;
+    }
+    SchedClass td_class = sched_class_of(td);
+    SchedClass current_class = sched_class_of(current);
+    if (td_class != current_class) {
+        return td_class < current_class;
+    }
+    if (td_class == SCHED_CLASS_DL) {
+        return td->dl_deadline_ns < current->dl_deadline_ns;
+    }
+    return td->priority > current->priority;
+}
+
+// Novo periodo a partir de agora: orcamento cheio, deadline = agora + prazo relativo
+static inline void start_dl_period(ThreadDescriptor* td, uint64_t now_ns) {
+    td->dl_deadline_ns = now_ns + td->dl.deadline_ns;
+    td->dl_runtime_left_ns = static_cast<int64_t>(td->dl.runtime_ns);
+}
+
+// Inicio do proximo periodo da thread (quando o orcamento de uma thread throttled e reposto)
+static inline uint64_t dl_next_period_ns(const ThreadDescriptor* td) {
+    return td->dl_deadline_ns - td->dl.deadline_ns + td->dl.period_ns;
+}
+
+/**
+ * @brief Reposicao CBS: um periodo a mais de deadline por orcamento recarregado, ate quitar
+ * o excesso consumido. Se o deadline resultante ja passou, recomeca a partir de agora.
+ */
+static void replenish_dl(ThreadDescriptor* td, uint64_t now_ns) {
+    while (td->dl_runtime_left_ns <= 0) {
+        td->dl_deadline_ns += td->dl.period_ns;
+        td->dl_runtime_left_ns += static_cast<int64_t>(td->dl.runtime_ns);
+    }
+    if (td->dl_deadline_ns <= now_ns) {
+        start_dl_period(td, now_ns);
+    }
+}
+
+ComandroScheduler::ComandroScheduler()
+    : ComandroScheduler(cpu::get_topology_info().total_core_count) {}
+
+ComandroScheduler::ComandroScheduler(int nr_cpus) {
+    if (nr_cpus < 1) {
+        nr_cpus = 1;
+    } else if (nr_cpus > SCHED_MAX_CPUS) {
+        nr_cpus = SCHED_MAX_CPUS;
+    }
+    m_nr_cpus = nr_cpus;
+    m_bg_quota_ns = BG_PERIOD_NS_DEFAULT * BG_QUOTA_PERCENT_DEFAULT / 100 * nr_cpus;
+
+    for (int cpu = 0; cpu < SCHED_MAX_CPUS; ++cpu) {
+        CpuRunqueue* rq = &m_runqueues[cpu];
+        rq->cpu = cpu;
+        // Inicializa as listas do RT runqueue (uma lista para cada prioridade)
+        for (int i = 0; i < RT_PRIORITY_LEVELS; ++i) {
+            INIT_LIST_HEAD(&rq->rt_runqueue[i]);
+        }
     }
-    // Inicializa a lista do CRAN runqueue
-    INIT_LIST_HEAD(&cran_runqueue); 
-    Log::info(TAG, "ComandroScheduler inicializado. Modo hibrido RT/CRAN ativo.");
+    Log::info(TAG, "ComandroScheduler inicializado. Modo hibrido RT/CRAN ativo em " +
+                   std::to_string(m_nr_cpus) + " CPUs.");
+}
+
+ComandroScheduler& ComandroScheduler::instance() {
+    static ComandroScheduler s_instance;
+    return s_instance;
 }
 
 // =====================================================================
@@ -26,104 +252,236 @@ ComandroScheduler::ComandroScheduler() {
 // =====================================================================
 
 /**
- * @brief Funcao principal chamada pelo timer interrupt.
+ * @brief Funcao principal chamada pelo timer interrupt (em cada CPU).
  */
 void ComandroScheduler::schedule() {
-    // 1. Desabilita interrupcoes e adquire o lock
-    runqueue_lock.lock(); 
-    
-    // 2. Conta o tempo de execucao da thread atual
+    CpuRunqueue* rq = &m_runqueues[cpu::get_current_cpu_id()];
+
+    // 0. Ativa as threads acordadas por outras CPUs desde o ultimo tick
+    drain_wake_list(rq);
+
+    // 1. Desabilita interrupcoes e adquire o lock desta CPU
+    rq->lock.lock();
+
+    uint64_t current_time = SystemTime::get_current_ns();
+
+    // 2. Conta a execucao da thread atual e a devolve a fila (ou tira do runqueue)
+    PrevThreadWork work;
+    put_prev_thread(rq, current_time, &work);
+
+    // 3. Balanceamento periodico (respeitando as mascaras de afinidade)
+    if (current_time >= rq->next_balance_ns) {
+        load_balance(rq, current_time);
+        nohz_balance_kick(rq);
+    }
+
+    // 4. Escolhe a proxima thread; uma CPU ociosa tenta roubar trabalho
+    ThreadDescriptor* next_td = pick_next_thread(rq);
+    if (next_td == nullptr && steal_work(rq)) {
+        next_td = pick_next_thread(rq);
+    }
+
+    // 5. Troca de contexto
+    set_next_thread(rq, next_td, current_time);
+
+    // 6. Proximo tick desta CPU: periodico, reduzido (uma thread) ou parado (ociosa)
+    bool tick_was_stopped = (rq->tick_mode == TICK_STOPPED);
+    update_tick(rq, current_time);
+    bool tick_stopped = !tick_was_stopped && rq->tick_mode == TICK_STOPPED;
+
+    // 7. Libera o lock e reabilita interrupcoes
+    rq->lock.unlock();
+
+    finish_prev_thread(rq, &work);
+
+    // 8. CPU entrando em ociosidade: os seus timers passam a vencer numa CPU ocupada
+    if (tick_stopped) {
+        int target_cpu = find_timer_target(rq);
+        if (target_cpu >= 0) {
+            KernelTimer::instance().migrateTimers(rq->cpu, target_cpu);
+        }
+    }
+}
+
+/**
+ * @brief Conta o tempo de execucao da thread atual e a devolve a fila. O chamador segura rq->lock.
+ * * Atualiza a utilizacao PELT, o vruntime (CRAN) ou o orcamento (DL), e a banda RT/background.
+ * * Uma thread que bloqueou/dormiu sai do runqueue ate o wake-up; migracao e timer de
+ *   reposicao DL ficam em work, para depois de soltar o lock (finish_prev_thread).
+ */
+void ComandroScheduler::put_prev_thread(CpuRunqueue* rq, uint64_t now_ns, PrevThreadWork* work) {
+    work->migrating = nullptr;
+    work->dl_throttled = nullptr;
+    work->dl_throttle_delay_ns = 0;
+
+    update_load_avg(rq, now_ns);
+    ThreadDescriptor* current_thread = rq->current_thread;
+    uint64_t rt_runtime = 0;
+    uint64_t background_runtime = 0;
     if (current_thread) {
-        uint64_t current_time = SystemTime::get_current_ns();
-        uint64_t actual_runtime = current_time - current_thread->exec_start_time_ns;
-        
-        // Atualiza vruntime se for uma thread CRAN
-        if (current_thread->priority <= PRIORITY_UI_INTERACTIVE) {
+        uint64_t actual_runtime = now_ns - current_thread->exec_start_time_ns;
+
+        // Atualiza vruntime (CRAN) ou consome o orcamento do periodo (DL)
+        SchedClass sched_class = sched_class_of(current_thread);
+        if (sched_class == SCHED_CLASS_CRAN) {
             update_vruntime(current_thread, actual_runtime);
+        } else if (sched_class == SCHED_CLASS_DL &&
+                   update_dl_runtime(current_thread, actual_runtime, now_ns)) {
+            // Orcamento esgotado: fica fora da fila EDF ate o proximo periodo
+            work->dl_throttled = current_thread;
+            work->dl_throttle_delay_ns = dl_next_period_ns(current_thread) - now_ns;
         }
         current_thread->total_runtime_ns += actual_runtime;
-        
-        // Coloca a thread atual de volta na fila se nao estiver bloqueada
-        if (current_thread->list_node.prev == nullptr) { // Simplificacao: verifica se a thread foi removida (ex: por sleep)
-             enqueue_thread(current_thread);
+        current_thread->exec_start_time_ns = now_ns; // O mesmo intervalo nao e contado duas vezes
+        if (sched_class == SCHED_CLASS_RT) {
+            rt_runtime = actual_runtime;
+        } else if (sched_class == SCHED_CLASS_CRAN && is_background_priority(current_thread->priority)) {
+            background_runtime = actual_runtime;
+        }
+
+        // Coloca a thread atual de volta na fila (ela sai da fila ao ser escolhida),
+        // a menos que tenha bloqueado/dormido: nesse caso sai do runqueue ate o wake-up.
+        if (current_thread->state != THREAD_RUNNABLE) {
+            deactivate_thread(rq, current_thread);
+        } else if (!is_queued(current_thread)) {
+            if (current_thread->cpus_allowed & cpu_bit(rq->cpu)) {
+                enqueue_thread(current_thread);
+            } else {
+                // A afinidade mudou enquanto rodava: migra apos liberar o lock
+                detach_thread(rq, current_thread);
+                work->migrating = current_thread;
+                rq->current_thread = nullptr;
+            }
         }
     }
-    
-    // 3. Escolhe a proxima thread
-    ThreadDescriptor* next_td = pick_next_thread();
-    
-    if (next_td != nullptr && next_td != current_thread) {
+    update_min_vruntime(rq);
+
+    // Orcamento RT da CPU e cota do grupo background (throttle / fim do throttle)
+    update_rt_bandwidth(rq, rt_runtime, now_ns);
+    update_bg_bandwidth(rq, background_runtime, now_ns);
+}
+
+/**
+ * @brief Poe next_td (ja escolhida e ainda na fila) em execucao. O chamador segura rq->lock.
+ */
+void ComandroScheduler::set_next_thread(CpuRunqueue* rq, ThreadDescriptor* next_td, uint64_t now_ns) {
+    if (next_td != nullptr) {
         dequeue_thread(next_td); // Remove da fila antes da troca de contexto
-        
-        // Marca o tempo de inicio de execucao
-        next_td->exec_start_time_ns = SystemTime::get_current_ns();
-        
-        // 4. Troca de Contexto (Simulacao)
-        Log::debug(TAG, "Troca de contexto: TID " + std::to_string(current_thread ? current_thread->tid : 0) + 
-                         " -> TID " + std::to_string(next_td->tid) + 
-                         " Prio: " + std::to_string(next_td->priority));
-        
-        // context_switch(current_thread, next_td); // Chamada ASM/hardware
-        current_thread = next_td;
+        // Marca o tempo de inicio de execucao (tambem quando a mesma thread continua)
+        next_td->exec_start_time_ns = now_ns;
+        // A espera na fila nao conta como execucao no PELT
+        pelt_update(&next_td->avg, now_ns, false, 0);
+    }
+
+    if (next_td != rq->current_thread) {
+        if (next_td != nullptr) {
+            // Latencia wakeup -> execucao: contadores atomicos por CPU, sem lock adicional
+            if (next_td->wakeup_time_ns != 0) {
+                uint64_t latency = (now_ns > next_td->wakeup_time_ns) ? now_ns - next_td->wakeup_time_ns : 0;
+                rq->wakeup_latency[latency_level_of(next_td->priority)].record(latency);
+                next_td->wakeup_time_ns = 0;
+            }
+
+            // Troca de Contexto (Simulacao)
+            KTRACE(SCHED_SWITCH, rq->current_thread ? rq->current_thread->tid : 0, next_td->tid, next_td->priority);
+        }
+
+        // context_switch(rq->current_thread, next_td); // Chamada ASM/hardware
+        rq->current_thread = next_td;
+        publish_util(rq); // A CPU pode ter ficado ociosa (ou deixado de ficar)
     }
+}
 
-    // 5. Libera o lock e reabilita interrupcoes
-    runqueue_lock.unlock(); 
+/**
+ * @brief Trabalho de put_prev_thread que trava outros locks (sem rq->lock).
+ */
+void ComandroScheduler::finish_prev_thread(CpuRunqueue* rq, const PrevThreadWork* work) {
+    if (work->migrating != nullptr) {
+        push_thread(work->migrating, select_cpu_for_thread(work->migrating, rq->cpu));
+    }
+    if (work->dl_throttled != nullptr) {
+        start_dl_replenish_timer(work->dl_throttled, work->dl_throttle_delay_ns);
+    }
 }
 
 /**
  * @brief Escolhe a thread com maior prioridade para rodar.
  */
-ThreadDescriptor* ComandroScheduler::pick_next_thread() {
-    // Prioridade 1: RT (Real-Time)
-    ThreadDescriptor* rt_thread = pick_next_rt();
+ThreadDescriptor* ComandroScheduler::pick_next_thread(CpuRunqueue* rq) {
+    // Com o orcamento RT esgotado, RT (inclusive RT_EMERGENCY) cede a vez as outras classes
+    bool rt_allowed = !rq->rt_throttled;
+
+    // Prioridade 1: RT_EMERGENCY (watchdogs, abort de hardware) passa ate as reservas DL
+    if (rt_allowed && rq->rt_bitmap.test(PRIORITY_RT_EMERGENCY)) {
+        return pick_next_rt(rq);
+    }
+
+    // Prioridade 2: DL (EDF; o CBS limita a banda de cada thread)
+    ThreadDescriptor* dl_thread = pick_next_dl(rq);
+    if (dl_thread) {
+        return dl_thread;
+    }
+
+    // Prioridade 3: RT (Real-Time)
+    ThreadDescriptor* rt_thread = rt_allowed ? pick_next_rt(rq) : nullptr;
     if (rt_thread) {
         return rt_thread;
     }
-    
-    // Prioridade 2: CRAN (Cranberry / Fair)
-    return pick_next_cran();
+
+    // Prioridade 4: CRAN (Cranberry / Fair)
+    ThreadDescriptor* cran_thread = pick_next_cran(rq);
+    if (cran_thread) {
+        return cran_thread;
+    }
+
+    // Sem mais ninguem esperando, RT throttled roda em vez de deixar a CPU ociosa
+    return pick_next_rt(rq);
+}
+
+/**
+ * @brief Selecao para Fila Deadline (DL) - EDF: o deadline absoluto mais proximo.
+ */
+ThreadDescriptor* ComandroScheduler::pick_next_dl(CpuRunqueue* rq) {
+    TimelineNode* leftmost = rq->dl_timeline.leftmost();
+    if (leftmost == nullptr) {
+        return nullptr;
+    }
+    return timeline_entry(leftmost, ThreadDescriptor, run_node);
 }
 
 /**
  * @brief Selecao para Fila de Tempo Real (RT) - Lista simples por prioridade.
+ * O bitmap de ocupacao indica o nivel mais alto nao vazio (find-first-set),
+ * sem percorrer as filas vazias a cada tick.
  */
-ThreadDescriptor* ComandroScheduler::pick_next_rt() {
-    // Percorre as filas RT de maior prioridade (99) para menor (70)
-    for (int i = PRIORITY_RT_EMERGENCY; i >= PRIORITY_UI_INTERACTIVE; --i) {
-        if (!list_empty(&rt_runqueue[i])) {
-            // Pega o primeiro da lista (FIFO dentro do mesmo nivel de RT)
-            return list_entry(rt_runqueue[i].next, ThreadDescriptor, list_node);
-        }
+ThreadDescriptor* ComandroScheduler::pick_next_rt(CpuRunqueue* rq) {
+    int level = rq->rt_bitmap.highest();
+    if (level < 0) {
+        return nullptr;
     }
-    return nullptr;
+    // Pega o primeiro da lista (FIFO dentro do mesmo nivel de RT)
+    return list_entry(rq->rt_runqueue[level].next, ThreadDescriptor, list_node);
 }
 
 /**
  * @brief Selecao para Fila Cranberry (CRAN) - Baseada em vruntime.
- * Esta lista deve ser idealmente uma estrutura de arvore (e.g., RB-Tree)
- * para encontrar o menor vruntime rapidamente. Aqui, simplificamos com uma lista.
+ * A timeline mantem em cache o no de menor vruntime, entao a escolha e O(1).
  */
-ThreadDescriptor* ComandroScheduler::pick_next_cran() {
-    if (list_empty(&cran_runqueue)) {
+ThreadDescriptor* ComandroScheduler::pick_next_cran(CpuRunqueue* rq) {
+    TimelineNode* leftmost = rq->cran_timeline.leftmost();
+
+    // O grupo background disputa pelo vruntime, exceto com a cota esgotada:
+    // ai so roda se nao houver outra thread CRAN esperando
+    TimelineNode* bg_leftmost = rq->bg_timeline.leftmost();
+    if (bg_leftmost != nullptr &&
+        (leftmost == nullptr || (!rq->bg_throttled && cran_vruntime_of(bg_leftmost) < cran_vruntime_of(leftmost)))) {
+        leftmost = bg_leftmost;
+    }
+    if (leftmost == nullptr) {
         return nullptr;
     }
-    
-    ThreadDescriptor* best_td = nullptr;
-    uint64_t min_vruntime = (uint64_t)-1; // Valor maximo
 
-    // Itera sobre a lista CRAN para encontrar o menor vruntime (O(n) - lento)
-    list_head *pos;
-    list_for_each(pos, &cran_runqueue) {
-        ThreadDescriptor *td = list_entry(pos, ThreadDescriptor, list_node);
-        
-        if (td->vruntime_ns < min_vruntime) {
-            min_vruntime = td->vruntime_ns;
-            best_td = td;
-        }
-    }
-    
-    return best_td; // A thread com o menor vruntime e a mais "faminta"
+    return timeline_entry(leftmost, ThreadDescriptor, run_node); // A thread com o menor vruntime e a mais "faminta"
 }
 
 // =====================================================================
@@ -131,87 +489,1497 @@ ThreadDescriptor* ComandroScheduler::pick_next_cran() {
 // =====================================================================
 
 void ComandroScheduler::enqueue_thread(ThreadDescriptor* td) {
-    if (td->priority >= PRIORITY_RT_DISPLAY_VSYNC) {
+    CpuRunqueue* rq = runqueue_of(td);
+    SchedClass sched_class = sched_class_of(td);
+    if (sched_class == SCHED_CLASS_DL) {
+        // Uma thread throttled espera fora da fila; o timer de reposicao a reenfileira
+        if (td->dl_throttled) {
+            return;
+        }
+        rq->dl_timeline.insert(&td->run_node, td->dl_deadline_ns);
+    } else if (sched_class == SCHED_CLASS_RT) {
         // Enfileira na lista RT correspondente a prioridade
-        list_add_tail(&td->list_node, &rt_runqueue[td->priority]);
+        list_add_tail(&td->list_node, &rq->rt_runqueue[td->priority]);
+        rq->rt_bitmap.set(td->priority);
     } else {
-        // Enfileira na lista CRAN (sera ordenada por vruntime na selecao)
-        list_add_tail(&td->list_node, &cran_runqueue);
+        // Insere na timeline CRAN (ou do grupo background), ordenada por vruntime (O(log n))
+        cran_timeline_of(rq, td)->insert(&td->run_node, td->vruntime_ns);
+    }
+
+    // Uma CPU sem tick periodico precisa reavaliar (ha uma thread esperando);
+    // com tick periodico, so se a thread nova deve preemptar a atual
+    if (rq->tick_mode != TICK_PERIODIC || should_preempt(td, rq->current_thread)) {
+        kick_cpu(rq);
     }
 }
 
 void ComandroScheduler::dequeue_thread(ThreadDescriptor* td) {
-    list_del_init(&td->list_node);
+    CpuRunqueue* rq = runqueue_of(td);
+    SchedClass sched_class = sched_class_of(td);
+    if (sched_class == SCHED_CLASS_DL) {
+        if (Timeline::is_queued(&td->run_node)) {
+            rq->dl_timeline.erase(&td->run_node);
+        }
+    } else if (sched_class == SCHED_CLASS_RT) {
+        list_del_init(&td->list_node);
+        if (list_empty(&rq->rt_runqueue[td->priority])) {
+            rq->rt_bitmap.clear(td->priority);
+        }
+    } else if (Timeline::is_queued(&td->run_node)) {
+        cran_timeline_of(rq, td)->erase(&td->run_node);
+    }
+}
+
+bool ComandroScheduler::is_queued(const ThreadDescriptor* td) const {
+    if (sched_class_of(td) == SCHED_CLASS_RT) {
+        return !list_empty(&td->list_node);
+    }
+    return Timeline::is_queued(&td->run_node);
+}
+
+CpuAffinityMask ComandroScheduler::online_cpu_mask() const {
+    return (m_nr_cpus >= SCHED_MAX_CPUS) ? CPU_AFFINITY_ALL : (cpu_bit(m_nr_cpus) - 1);
 }
 
 void ComandroScheduler::update_vruntime(ThreadDescriptor* td, uint64_t actual_runtime_ns) {
-    // A logica real envolveria pesos baseados na prioridade (PRIORITY_UI_INTERACTIVE a PRIORITY_VERY_LOW)
-    // Threads de prioridade mais alta CRAN (ex: UI) terao um fator de peso menor (vruntime cresce mais devagar).
-    
-    uint64_t weighted_runtime = actual_runtime_ns;
-    // Simplificacao: Threads de baixa prioridade (muito_low) tem vruntime 4x mais rapido
-    if (td->priority == PRIORITY_VERY_LOW) {
-        weighted_runtime *= 4; 
+    // Threads de prioridade mais alta CRAN (ex: UI) tem peso maior (vruntime cresce mais devagar).
+    // A fatia de CPU de cada thread e proporcional ao seu peso na tabela.
+    td->vruntime_ns += calc_delta_fair(actual_runtime_ns, td);
+}
+
+/**
+ * @brief Avanca o min_vruntime do runqueue (nunca retrocede). O chamador segura rq->lock.
+ */
+void ComandroScheduler::update_min_vruntime(CpuRunqueue* rq) {
+    bool found = false;
+    uint64_t vruntime = 0;
+
+    ThreadDescriptor* curr = rq->current_thread;
+    if (curr != nullptr && sched_class_of(curr) == SCHED_CLASS_CRAN && !is_queued(curr)) {
+        vruntime = curr->vruntime_ns;
+        found = true;
+    }
+
+    Timeline* timelines[] = {&rq->cran_timeline, &rq->bg_timeline};
+    for (Timeline* timeline : timelines) {
+        TimelineNode* leftmost = timeline->leftmost();
+        if (leftmost != nullptr) {
+            uint64_t leftmost_vruntime = cran_vruntime_of(leftmost);
+            vruntime = found ? (leftmost_vruntime < vruntime ? leftmost_vruntime : vruntime) : leftmost_vruntime;
+            found = true;
+        }
+    }
+
+    if (found && vruntime > rq->min_vruntime) {
+        rq->min_vruntime = vruntime;
     }
-    
-    td->vruntime_ns += weighted_runtime;
 }
 
-void ComandroScheduler::add_thread(ThreadDescriptor* td) {
-    runqueue_lock.lock();
-    td->vruntime_ns = 0; // Inicia com vruntime zero
-    td->exec_start_time_ns = 0;
-    td->total_runtime_ns = 0;
-    enqueue_thread(td);
-    Log::debug(TAG, "Thread TID " + std::to_string(td->tid) + " adicionada.");
-    runqueue_lock.unlock();
+/**
+ * @brief Posiciona uma thread CRAN relativa ao min_vruntime do runqueue.
+ * * initial: thread nova comeca uma fatia atras (nao passa a frente de quem ja roda).
+ * * acordando: recebe no maximo CRAN_WAKEUP_CREDIT_NS de credito, sem recuperar
+ *   todo o tempo que passou dormindo.
+ */
+void ComandroScheduler::place_thread(CpuRunqueue* rq, ThreadDescriptor* td, bool initial) {
+    uint64_t vruntime = rq->min_vruntime;
+
+    if (initial) {
+        td->vruntime_ns = vruntime + calc_delta_fair(CRAN_MIN_GRANULARITY_NS, td);
+        return;
+    }
+
+    vruntime -= (vruntime < CRAN_WAKEUP_CREDIT_NS) ? vruntime : CRAN_WAKEUP_CREDIT_NS;
+    if (td->vruntime_ns < vruntime) {
+        td->vruntime_ns = vruntime;
+    }
 }
 
-void ComandroScheduler::set_thread_priority(ThreadDescriptor* td, Priority new_priority) {
-    runqueue_lock.lock();
-    
-    bool needs_reschedule = (new_priority > td->priority);
-    
-    dequeue_thread(td);
-    td->priority = new_priority;
+/**
+ * @brief Consome o orcamento DL da thread que rodou. O chamador segura o lock do runqueue.
+ * @return true se a thread foi throttled (o chamador arma o timer de reposicao).
+ */
+bool ComandroScheduler::update_dl_runtime(ThreadDescriptor* td, uint64_t actual_runtime_ns, uint64_t now_ns) {
+    td->dl_runtime_left_ns -= static_cast<int64_t>(actual_runtime_ns);
+    if (td->dl_runtime_left_ns > 0) {
+        return false;
+    }
+
+    // O proximo periodo ja comecou: repoe agora, sem throttle
+    if (dl_next_period_ns(td) <= now_ns) {
+        replenish_dl(td, now_ns);
+        return false;
+    }
+
+    td->dl_throttled = true;
+    return true;
+}
+
+/**
+ * @brief Regra de wakeup do CBS. O chamador segura o lock do runqueue.
+ * * Se o orcamento restante nao cabe ate o deadline sem exceder a banda reservada
+ *   (restante / (deadline - agora) > runtime / period), comeca um periodo novo;
+ *   assim uma thread que dormiu nao acumula credito para roubar a CPU das outras.
+ * @return true se a thread acordou sem orcamento e precisa de um timer de reposicao.
+ */
+bool ComandroScheduler::update_dl_on_wakeup(ThreadDescriptor* td, uint64_t now_ns) {
+    if (td->dl_throttled) {
+        return false; // Reposicao ja agendada
+    }
+
+    if (td->dl_deadline_ns <= now_ns) {
+        start_dl_period(td, now_ns);
+        return false;
+    }
+
+    if (td->dl_runtime_left_ns <= 0) {
+        td->dl_throttled = true;
+        return true;
+    }
+
+    unsigned __int128 left = static_cast<uint64_t>(td->dl_runtime_left_ns);
+    unsigned __int128 laxity = td->dl_deadline_ns - now_ns;
+    if (left * td->dl.period_ns > laxity * td->dl.runtime_ns) {
+        start_dl_period(td, now_ns);
+    }
+    return false;
+}
+
+/**
+ * @brief Arma o timer one-shot que repoe o orcamento de uma thread throttled (sem locks).
+ */
+void ComandroScheduler::start_dl_replenish_timer(ThreadDescriptor* td, uint64_t delay_ns) {
+    TimerHandle timer_id = KernelTimer::instance().setTimer(std::chrono::nanoseconds(delay_ns > 0 ? delay_ns : 1),
+                                                         &ComandroScheduler::dl_replenish_timer_expired, td, false);
+
+    // Registra para cancelamento; se a thread ja foi reposta (ou saiu da classe DL), o timer sobra
+    CpuRunqueue* rq = lock_thread_runqueue(td);
+    bool armed = td->dl_throttled && timer_id != 0;
+    if (armed) {
+        td->dl_timer_id = timer_id;
+    }
+    rq->lock.unlock();
+
+    if (!armed && timer_id != 0) {
+        KernelTimer::instance().cancelTimer(timer_id);
+    }
+}
+
+/**
+ * @brief Fim do throttle: repoe o orcamento e devolve a thread a fila EDF, se ainda pronta.
+ */
+void ComandroScheduler::replenish_dl_thread(ThreadDescriptor* td) {
+    CpuRunqueue* rq = lock_thread_runqueue(td);
+    if (td->dl_throttled) {
+        td->dl_throttled = false;
+        td->dl_timer_id = 0;
+        replenish_dl(td, SystemTime::get_current_ns());
+        if (td->on_rq && td != rq->current_thread && !is_queued(td)) {
+            enqueue_thread(td);
+        }
+    }
+    rq->lock.unlock();
+}
+
+/**
+ * @brief Callback do KernelTimer (contexto de kernel thread): inicio do proximo periodo DL.
+ */
+void ComandroScheduler::dl_replenish_timer_expired(void* context, uint32_t /*overruns*/) {
+    instance().replenish_dl_thread(static_cast<ThreadDescriptor*>(context));
+}
+
+/**
+ * @brief Controle de admissao: reserva a banda na CPU permitida com mais banda DL livre.
+ * @return CPU escolhida, ou -1 se a banda nao cabe em nenhuma.
+ */
+int ComandroScheduler::admit_dl_thread(const ThreadDescriptor* td, uint64_t bandwidth) {
+    for (int attempt = 0; attempt < m_nr_cpus; ++attempt) {
+        int best_cpu = -1;
+        uint64_t best_used = 0;
+        for (int cpu = 0; cpu < m_nr_cpus; ++cpu) {
+            if (!(td->cpus_allowed & cpu_bit(cpu))) {
+                continue;
+            }
+            uint64_t used = m_runqueues[cpu].dl_bandwidth.load(std::memory_order_relaxed);
+            if (used + bandwidth > DL_BANDWIDTH_LIMIT) {
+                continue;
+            }
+            if (best_cpu < 0 || used < best_used) {
+                best_cpu = cpu;
+                best_used = used;
+            }
+        }
+        if (best_cpu < 0) {
+            return -1;
+        }
+        if (dl_reserve_bandwidth(&m_runqueues[best_cpu], bandwidth, 0)) {
+            return best_cpu;
+        }
+        // Outra admissao concorrente ocupou a banda: reavalia
+    }
+    return -1;
+}
+
+// =====================================================================
+// Associacao Thread <-> Runqueue
+// =====================================================================
+
+/**
+ * @brief Trava o runqueue que possui a thread (revalida apos travar, pois ela pode migrar).
+ */
+CpuRunqueue* ComandroScheduler::lock_thread_runqueue(ThreadDescriptor* td) {
+    for (;;) {
+        CpuRunqueue* rq = runqueue_of(td);
+        rq->lock.lock();
+        if (rq == runqueue_of(td)) {
+            return rq;
+        }
+        rq->lock.unlock();
+    }
+}
+
+/**
+ * @brief Associa a thread ao runqueue e a enfileira. O chamador segura rq->lock.
+ */
+void ComandroScheduler::activate_thread(CpuRunqueue* rq, ThreadDescriptor* td) {
+    td->cpu = rq->cpu;
+    td->on_rq = true;
     enqueue_thread(td);
-    
-    // Se a prioridade foi elevada, forca um reschedule imediato
-    if (needs_reschedule) {
-        Log::info(TAG, "Prioridade de TID " + std::to_string(td->tid) + " elevada. Reschedule forcado.");
-        // comandro_trigger_reschedule_interrupt(); // Simula uma interrupcao de reschedule
+    rq->nr_running.fetch_add(1, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Desassocia a thread do runqueue (retirando-a da fila, se enfileirada).
+ */
+void ComandroScheduler::deactivate_thread(CpuRunqueue* rq, ThreadDescriptor* td) {
+    if (is_queued(td)) {
+        dequeue_thread(td);
     }
-    
-    runqueue_lock.unlock();
+    td->on_rq = false;
+    rq->nr_running.fetch_sub(1, std::memory_order_relaxed);
 }
 
-void ComandroScheduler::yield() {
-    runqueue_lock.lock();
-    
-    // Atualiza o vruntime para threads CRAN antes de ceder
-    if (current_thread && current_thread->priority <= PRIORITY_UI_INTERACTIVE) {
-        uint64_t current_time = SystemTime::get_current_ns();
-        uint64_t actual_runtime = current_time - current_thread->exec_start_time_ns;
-        update_vruntime(current_thread, actual_runtime);
-    }
-    
-    // Forca o scheduler a rodar
-    // comandro_trigger_reschedule_interrupt(); 
-    
-    runqueue_lock.unlock();
-}
-
-// Simples simulacao de sleep (para ser usado pelo user space/framework)
-void ComandroScheduler::sleep(std::chrono::milliseconds duration) {
-    // Na implementacao real:
-    // 1. current_thread->state = THREAD_BLOCKED;
-    // 2. Add current_thread a uma lista de timers;
-    // 3. dequeue_thread(current_thread);
-    // 4. schedule();
-    Log::debug(TAG, "Thread chamou sleep por " + std::to_string(duration.count()) + "ms.");
-    // A thread bloqueia, e o scheduler a acordara quando o timer estourar.
+/**
+ * @brief Retira a thread do runqueue para migracao; o vruntime passa a ser relativo ao min_vruntime de origem.
+ */
+void ComandroScheduler::detach_thread(CpuRunqueue* src, ThreadDescriptor* td) {
+    detach_load(src, td);
+    deactivate_thread(src, td);
+    td->vruntime_ns -= src->min_vruntime; // Aritmetica modular: o valor relativo pode ser "negativo"
 }
 
-} // namespace scheduler
-} // namespace kernel
-} // namespace comandro
+/**
+ * @brief Associa uma thread migrada ao runqueue de destino, re-ancorando o vruntime.
+ */
+void ComandroScheduler::attach_thread(CpuRunqueue* dst, ThreadDescriptor* td) {
+    attach_load(dst, td);
+    td->vruntime_ns += dst->min_vruntime;
+    activate_thread(dst, td);
+}
+
+/**
+ * @brief Enfileira uma thread desassociada (detach_thread) no runqueue de outra CPU.
+ */
+void ComandroScheduler::push_thread(ThreadDescriptor* td, int dst_cpu) {
+    CpuRunqueue* dst = &m_runqueues[dst_cpu];
+    dst->lock.lock();
+    attach_thread(dst, td);
+    dst->lock.unlock();
+}
+
+/**
+ * @brief Escolhe a CPU permitida com menos threads (empate favorece a CPU atual).
+ * * Leitura sem lock dos contadores: e apenas uma heuristica de posicionamento.
+ */
+int ComandroScheduler::select_cpu_for_thread(const ThreadDescriptor* td, int this_cpu) const {
+    int best_cpu = -1;
+    uint32_t best_load = UINT32_MAX;
+
+    for (int cpu = 0; cpu < m_nr_cpus; ++cpu) {
+        if (!(td->cpus_allowed & cpu_bit(cpu))) {
+            continue;
+        }
+        uint32_t load = m_runqueues[cpu].nr_running.load(std::memory_order_relaxed);
+        if (load < best_load || (load == best_load && cpu == this_cpu)) {
+            best_cpu = cpu;
+            best_load = load;
+        }
+    }
+    return (best_cpu >= 0) ? best_cpu : this_cpu;
+}
+
+// =====================================================================
+// Balanceamento de Carga (Work Stealing)
+// =====================================================================
+
+/**
+ * @brief Encontra a CPU com mais threads (pelo menos uma na fila alem da atual).
+ */
+CpuRunqueue* ComandroScheduler::find_busiest_runqueue(const CpuRunqueue* this_rq) {
+    CpuRunqueue* busiest = nullptr;
+    uint32_t busiest_load = 1;
+
+    for (int cpu = 0; cpu < m_nr_cpus; ++cpu) {
+        if (cpu == this_rq->cpu) {
+            continue;
+        }
+        uint32_t load = m_runqueues[cpu].nr_running.load(std::memory_order_relaxed);
+        if (load > busiest_load) {
+            busiest = &m_runqueues[cpu];
+            busiest_load = load;
+        }
+    }
+    return busiest;
+}
+
+/**
+ * @brief Trava o runqueue remoto segurando o local, sempre na ordem de CPU (evita deadlock).
+ * * Pode liberar this_rq->lock momentaneamente; o chamador deve reavaliar o seu estado.
+ */
+void ComandroScheduler::double_lock_balance(CpuRunqueue* this_rq, CpuRunqueue* busiest) {
+    if (busiest->cpu < this_rq->cpu) {
+        this_rq->lock.unlock();
+        busiest->lock.lock();
+        this_rq->lock.lock();
+    } else {
+        busiest->lock.lock();
+    }
+}
+
+/**
+ * @brief Procura na CPU de origem uma thread enfileirada que possa rodar em dst_cpu.
+ * * RT do nivel mais alto primeiro, depois CRAN a partir do menor vruntime.
+ * * A thread atual da origem nunca e migrada.
+ */
+ThreadDescriptor* ComandroScheduler::find_migratable_thread(CpuRunqueue* src, int dst_cpu) {
+    CpuAffinityMask dst_bit = cpu_bit(dst_cpu);
+
+    int level = src->rt_bitmap.highest();
+    if (level >= 0) {
+        list_head* pos;
+        list_for_each(pos, &src->rt_runqueue[level]) {
+            ThreadDescriptor* td = list_entry(pos, ThreadDescriptor, list_node);
+            if (td != src->current_thread && (td->cpus_allowed & dst_bit)) {
+                return td;
+            }
+        }
+    }
+
+    int scanned = 0;
+    Timeline* timelines[] = {&src->cran_timeline, &src->bg_timeline};
+    for (Timeline* timeline : timelines) {
+        for (TimelineNode* node = timeline->leftmost();
+             node != nullptr && scanned < MAX_MIGRATE_SCAN;
+             node = Timeline::next(node), ++scanned) {
+            ThreadDescriptor* td = timeline_entry(node, ThreadDescriptor, run_node);
+            if (td != src->current_thread && (td->cpus_allowed & dst_bit)) {
+                return td;
+            }
+        }
+    }
+    return nullptr;
+}
+
+/**
+ * @brief Move ate max_threads threads de busiest para this_rq. Ambos os locks estao travados.
+ */
+int ComandroScheduler::pull_threads(CpuRunqueue* this_rq, CpuRunqueue* busiest, int max_threads) {
+    int moved = 0;
+    while (moved < max_threads) {
+        ThreadDescriptor* td = find_migratable_thread(busiest, this_rq->cpu);
+        if (td == nullptr) {
+            break;
+        }
+        detach_thread(busiest, td);
+        attach_thread(this_rq, td);
+        ++moved;
+    }
+    return moved;
+}
+
+/**
+ * @brief Chamado por uma CPU sem threads prontas: rouba uma thread da CPU mais ocupada.
+ * @return true se a fila local deve ser reavaliada.
+ */
+bool ComandroScheduler::steal_work(CpuRunqueue* this_rq) {
+    CpuRunqueue* busiest = find_busiest_runqueue(this_rq);
+    if (busiest == nullptr) {
+        return false;
+    }
+
+    double_lock_balance(this_rq, busiest);
+    pull_threads(this_rq, busiest, 1);
+    busiest->lock.unlock();
+    return true;
+}
+
+/**
+ * @brief Balanceamento periodico: puxa metade do desequilibrio da CPU mais ocupada.
+ */
+void ComandroScheduler::load_balance(CpuRunqueue* this_rq, uint64_t now_ns) {
+    this_rq->next_balance_ns = now_ns + BALANCE_INTERVAL_NS;
+
+    CpuRunqueue* busiest = find_busiest_runqueue(this_rq);
+    if (busiest == nullptr) {
+        return;
+    }
+
+    double_lock_balance(this_rq, busiest);
+
+    uint32_t busiest_load = busiest->nr_running.load(std::memory_order_relaxed);
+    uint32_t this_load = this_rq->nr_running.load(std::memory_order_relaxed);
+    if (busiest_load > this_load + 1) {
+        int imbalance = static_cast<int>((busiest_load - this_load) / 2);
+        pull_threads(this_rq, busiest, imbalance < MAX_PULL_PER_BALANCE ? imbalance : MAX_PULL_PER_BALANCE);
+    }
+
+    busiest->lock.unlock();
+}
+
+/**
+ * @brief CPUs em NO_HZ nao balanceiam sozinhas: uma CPU com threads esperando
+ * acorda a CPU em NO_HZ menos carregada para que ela puxe trabalho.
+ */
+void ComandroScheduler::nohz_balance_kick(CpuRunqueue* this_rq) {
+    CpuAffinityMask nohz = m_nohz_mask.load(std::memory_order_relaxed) & ~cpu_bit(this_rq->cpu);
+    uint32_t this_load = this_rq->nr_running.load(std::memory_order_relaxed);
+    if (nohz == 0 || this_load < 2) {
+        return;
+    }
+
+    CpuRunqueue* target = nullptr;
+    uint32_t target_load = this_load - 1;
+    for (; nohz != 0; nohz &= nohz - 1) {
+        CpuRunqueue* rq = &m_runqueues[__builtin_ctzll(nohz)];
+        uint32_t load = rq->nr_running.load(std::memory_order_relaxed);
+        if (load < target_load) {
+            target = rq;
+            target_load = load;
+        }
+    }
+    if (target != nullptr) {
+        kick_cpu(target);
+    }
+}
+
+// =====================================================================
+// Tick Dinamico (NO_HZ)
+// =====================================================================
+
+/**
+ * @brief Escolhe o modo do tick apos schedule(). O chamador segura rq->lock.
+ * * Threads esperando na fila: tick periodico (preempcao e balanceamento).
+ * * So a thread atual: nada a preemptar; tick residual para a contabilidade, ou
+ *   o fim do orcamento se ela for Deadline (throttle no instante certo).
+ * * Ociosa: tick parado. Wakeups, pushes e reposicoes DL chamam kick_cpu().
+ */
+void ComandroScheduler::update_tick(CpuRunqueue* rq, uint64_t now_ns) {
+    ThreadDescriptor* current_thread = rq->current_thread;
+    bool waiting = !rq->rt_bitmap.empty() || !rq->dl_timeline.empty() || !rq->cran_timeline.empty() ||
+                   !rq->bg_timeline.empty();
+
+    // Os ticks ficam na grade de SCHED_TICK_NS, mesmo apos um schedule() fora do tick (sleep, yield)
+    uint64_t grid_ns = now_ns - now_ns % SCHED_TICK_NS;
+
+    TickMode mode;
+    uint64_t next_tick_ns;
+    if (waiting || !m_nohz_enabled.load(std::memory_order_relaxed)) {
+        mode = TICK_PERIODIC;
+        next_tick_ns = grid_ns + SCHED_TICK_NS;
+    } else if (current_thread == nullptr) {
+        mode = TICK_STOPPED;
+        next_tick_ns = UINT64_MAX;
+    } else {
+        mode = TICK_REDUCED;
+        next_tick_ns = grid_ns + SCHED_TICK_REDUCED_NS;
+        if (is_dl_thread(current_thread) && current_thread->dl_runtime_left_ns > 0 &&
+            static_cast<uint64_t>(current_thread->dl_runtime_left_ns) < SCHED_TICK_REDUCED_NS) {
+            next_tick_ns = now_ns + static_cast<uint64_t>(current_thread->dl_runtime_left_ns);
+        }
+    }
+
+    if (mode != rq->tick_mode) {
+        if (mode == TICK_PERIODIC) {
+            m_nohz_mask.fetch_and(~cpu_bit(rq->cpu), std::memory_order_relaxed);
+        } else {
+            m_nohz_mask.fetch_or(cpu_bit(rq->cpu), std::memory_order_relaxed);
+        }
+        rq->tick_mode = mode;
+    }
+    rq->next_tick_ns.store(next_tick_ns);
+
+    // Um wakeup remoto empilhado depois do drain (sem lock) pode ter sido sobrescrito acima
+    if (rq->wake_list.load() != nullptr) {
+        rq->next_tick_ns.store(0);
+    }
+}
+
+/**
+ * @brief CPU que recebe os timers de uma CPU que parou o tick: a proxima com threads
+ * (a partir da vizinha, para espalhar), ou -1 se todas estao ociosas. Sem lock.
+ * * Uma escolha que fica velha so custa um wakeup da CPU errada: o hardware dela
+ *   e programado junto com a migracao.
+ */
+int ComandroScheduler::find_timer_target(const CpuRunqueue* rq) const {
+    for (int i = 1; i < m_nr_cpus; ++i) {
+        int cpu = (rq->cpu + i) % m_nr_cpus;
+        if (m_runqueues[cpu].nr_running.load(std::memory_order_relaxed) != 0) {
+            return cpu;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Pede um schedule() imediato na CPU (IPI de reschedule). Sem lock.
+ */
+void ComandroScheduler::kick_cpu(CpuRunqueue* rq) {
+    rq->next_tick_ns.store(0);
+    // comandro_send_reschedule_ipi(rq->cpu);
+}
+
+// =====================================================================
+// Utilizacao PELT
+// =====================================================================
+
+// Capacidade atual da CPU (tipo de nucleo e frequencia); CPU fora do modelo conta como referencia
+static inline uint32_t current_capacity(int cpu) {
+    uint32_t capacity = EnergyModel::instance().cpu_current_capacity(cpu);
+    return (capacity != 0) ? capacity : SCHED_CAPACITY_SCALE;
+}
+
+/**
+ * @brief Avanca a utilizacao da CPU e da thread em execucao ate now_ns e publica o resultado.
+ */
+void ComandroScheduler::update_load_avg(CpuRunqueue* rq, uint64_t now_ns) {
+    uint32_t capacity = current_capacity(rq->cpu);
+    ThreadDescriptor* current_thread = rq->current_thread;
+    pelt_update(&rq->avg, now_ns, current_thread != nullptr, capacity);
+    if (current_thread != nullptr) {
+        pelt_update(&current_thread->avg, now_ns, true, capacity);
+    }
+    publish_util(rq);
+}
+
+/**
+ * @brief A utilizacao da thread passa a contar neste runqueue (thread nova ou migrada).
+ */
+void ComandroScheduler::attach_load(CpuRunqueue* rq, ThreadDescriptor* td) {
+    uint64_t now_ns = SystemTime::get_current_ns();
+    update_load_avg(rq, now_ns);
+    pelt_update(&td->avg, now_ns, false, 0);
+    pelt_attach(&rq->avg, &td->avg);
+    publish_util(rq);
+}
+
+/**
+ * @brief Retira a utilizacao da thread do runqueue de origem antes de uma migracao.
+ * * Uma thread que dorme continua somada (decaindo): so a migracao leva a carga embora.
+ */
+void ComandroScheduler::detach_load(CpuRunqueue* rq, ThreadDescriptor* td) {
+    uint64_t now_ns = SystemTime::get_current_ns();
+    update_load_avg(rq, now_ns);
+    if (td != rq->current_thread) {
+        pelt_update(&td->avg, now_ns, false, 0);
+    }
+    pelt_detach(&rq->avg, &td->avg);
+    publish_util(rq);
+}
+
+void ComandroScheduler::publish_util(CpuRunqueue* rq) {
+    uint64_t util = (rq->avg.util_avg < SCHED_CAPACITY_SCALE) ? rq->avg.util_avg : SCHED_CAPACITY_SCALE;
+    uint64_t idle = (rq->current_thread == nullptr) ? UTIL_SNAPSHOT_IDLE : 0;
+    rq->util_snapshot.store(util | idle | (rq->avg.last_update_us << UTIL_SNAPSHOT_TIME_SHIFT),
+                            std::memory_order_relaxed);
+}
+
+// =====================================================================
+// Controle de banda (orcamento RT e cota background)
+// =====================================================================
+
+/**
+ * @brief Contabiliza ran_ns de RT na CPU e liga/desliga o throttle RT. O chamador segura rq->lock.
+ * * A cada periodo que passa o consumo acumulado cai de um orcamento inteiro.
+ * * RT rodando throttled so ocupa tempo que ficaria ocioso: nao conta no orcamento.
+ */
+void ComandroScheduler::update_rt_bandwidth(CpuRunqueue* rq, uint64_t ran_ns, uint64_t now_ns) {
+    uint64_t runtime = m_rt_runtime_ns.load(std::memory_order_relaxed);
+    uint64_t period = m_rt_period_ns.load(std::memory_order_relaxed);
+
+    uint64_t elapsed = now_ns - rq->rt_period_start_ns;
+    if (runtime >= period) {
+        // Sem limite
+        rq->rt_period_start_ns = now_ns;
+        rq->rt_time_ns = 0;
+    } else {
+        if (elapsed >= period) {
+            uint64_t periods = elapsed / period;
+            uint64_t refill = periods * runtime;
+            rq->rt_period_start_ns += periods * period;
+            rq->rt_time_ns = (rq->rt_time_ns > refill) ? rq->rt_time_ns - refill : 0;
+        }
+        if (!rq->rt_throttled) {
+            rq->rt_time_ns += ran_ns;
+        }
+    }
+
+    if (!rq->rt_throttled && rq->rt_time_ns >= runtime) {
+        rq->rt_throttled = true;
+        rq->rt_throttled_since_ns = now_ns;
+        rq->rt_throttle_count.fetch_add(1, std::memory_order_relaxed);
+        KTRACE(SCHED_RT_THROTTLE, rq->cpu, rq->rt_time_ns);
+    } else if (rq->rt_throttled && rq->rt_time_ns < runtime) {
+        rq->rt_throttled = false;
+        rq->rt_throttled_ns.fetch_add(now_ns - rq->rt_throttled_since_ns, std::memory_order_relaxed);
+    }
+}
+
+/**
+ * @brief Contabiliza ran_ns do grupo background na CPU e liga/desliga o throttle. O chamador segura rq->lock.
+ * * A cota e global: cada CPU retira fatias de BG_SLICE_NS do pool e so volta a
+ *   disputa-lo quando a fatia local acaba. A primeira CPU que ve o periodo virar
+ *   recarrega o pool.
+ */
+void ComandroScheduler::update_bg_bandwidth(CpuRunqueue* rq, uint64_t ran_ns, uint64_t now_ns) {
+    uint64_t quota = m_bg_quota_ns.load(std::memory_order_relaxed);
+    uint64_t period = m_bg_period_ns.load(std::memory_order_relaxed);
+
+    bool throttle = false;
+    if (quota != 0) {
+        uint64_t period_start = m_bg_period_start_ns.load(std::memory_order_relaxed);
+        if (now_ns >= period_start + period) {
+            uint64_t new_start = now_ns - (now_ns - period_start) % period;
+            if (m_bg_period_start_ns.compare_exchange_strong(period_start, new_start, std::memory_order_relaxed)) {
+                m_bg_pool_ns.store(static_cast<int64_t>(quota), std::memory_order_relaxed);
+                period_start = new_start;
+            }
+        }
+
+        // Periodo novo: a fatia (ou divida) do periodo anterior e descartada
+        if (rq->bg_period_start_ns != period_start) {
+            rq->bg_period_start_ns = period_start;
+            rq->bg_runtime_left_ns = 0;
+        } else if (!rq->bg_throttled) {
+            rq->bg_runtime_left_ns -= static_cast<int64_t>(ran_ns);
+        }
+
+        if (rq->bg_runtime_left_ns <= 0 && (ran_ns != 0 || rq->bg_throttled)) {
+            int64_t want = static_cast<int64_t>(BG_SLICE_NS) - rq->bg_runtime_left_ns;
+            int64_t pool = m_bg_pool_ns.load(std::memory_order_relaxed);
+            int64_t take = 0;
+            while (pool > 0) {
+                take = (pool < want) ? pool : want;
+                if (m_bg_pool_ns.compare_exchange_weak(pool, pool - take, std::memory_order_relaxed)) {
+                    break;
+                }
+                take = 0;
+            }
+            rq->bg_runtime_left_ns += take;
+            throttle = (rq->bg_runtime_left_ns <= 0);
+        }
+    }
+
+    if (throttle && !rq->bg_throttled) {
+        rq->bg_throttled = true;
+        rq->bg_throttled_since_ns = now_ns;
+        rq->bg_throttle_count.fetch_add(1, std::memory_order_relaxed);
+        KTRACE(SCHED_BG_THROTTLE, rq->cpu);
+    } else if (!throttle && rq->bg_throttled) {
+        rq->bg_throttled = false;
+        rq->bg_throttled_ns.fetch_add(now_ns - rq->bg_throttled_since_ns, std::memory_order_relaxed);
+
+        // Parado, o grupo ficou para tras no vruntime; sem isto ele gastaria a cota
+        // inteira de uma vez no inicio do periodo, atrasando as threads CRAN normais
+        TimelineNode* leftmost = rq->cran_timeline.leftmost();
+        if (leftmost != nullptr) {
+            uint64_t floor_vruntime = cran_vruntime_of(leftmost);
+            TimelineNode* node;
+            while ((node = rq->bg_timeline.leftmost()) != nullptr && cran_vruntime_of(node) < floor_vruntime) {
+                ThreadDescriptor* td = timeline_entry(node, ThreadDescriptor, run_node);
+                rq->bg_timeline.erase(node);
+                td->vruntime_ns = floor_vruntime;
+                rq->bg_timeline.insert(node, floor_vruntime);
+            }
+        }
+    }
+}
+
+// =====================================================================
+// API Publica
+// =====================================================================
+
+bool ComandroScheduler::add_thread(ThreadDescriptor* td) {
+    // Mascara pedida antes da criacao (Binder, processo pai) vale ja no primeiro posicionamento
+    if (td->cpus_allowed == 0) {
+        td->cpus_allowed = CPU_AFFINITY_ALL;
+    } else if ((td->cpus_allowed & online_cpu_mask()) == 0) {
+        Log::error(TAG, "Mascara de afinidade sem CPUs validas para TID " + std::to_string(td->tid) + ".");
+        return false;
+    }
+    td->exec_start_time_ns = 0;
+    td->total_runtime_ns = 0;
+    td->state = THREAD_RUNNABLE;
+    td->on_rq = false;
+    td->sleep_timer_id = 0;
+    td->wakeup_time_ns = 0;
+    td->wake_next = nullptr;
+    pelt_init(&td->avg, SystemTime::get_current_ns(), PELT_INITIAL_UTIL);
+    td->dl_throttled = false;
+    td->dl_timer_id = 0;
+    INIT_LIST_HEAD(&td->list_node);
+    INIT_LIST_HEAD(&td->wait_node);
+    Timeline::clear_node(&td->run_node);
+
+    int cpu;
+    if (is_dl_thread(td)) {
+        // Controle de admissao: a soma das bandas DL de cada CPU nao passa de DL_BANDWIDTH_LIMIT
+        if (!valid_dl_params(td->dl)) {
+            Log::error(TAG, "Parametros Deadline invalidos para TID " + std::to_string(td->tid) + ".");
+            return false;
+        }
+        cpu = admit_dl_thread(td, dl_bandwidth_of(td->dl));
+        if (cpu < 0) {
+            Log::error(TAG, "Admissao Deadline recusada para TID " + std::to_string(td->tid) + ": banda insuficiente.");
+            return false;
+        }
+    } else {
+        cpu = select_cpu_for_thread(td, cpu::get_current_cpu_id());
+    }
+
+    // Cada CPU tem o seu lock: threads adicionadas em CPUs diferentes nao disputam o mesmo lock
+    CpuRunqueue* rq = &m_runqueues[cpu];
+    rq->lock.lock();
+    if (is_dl_thread(td)) {
+        start_dl_period(td, SystemTime::get_current_ns());
+    } else {
+        place_thread(rq, td, true); // Comeca no min_vruntime do runqueue, nao em zero
+    }
+    attach_load(rq, td);
+    activate_thread(rq, td);
+    rq->lock.unlock();
+
+    m_tid_lock.lock();
+    ThreadDescriptor** bucket = &m_tid_hash[td->tid & (TID_HASH_SIZE - 1)];
+    td->tid_next = *bucket;
+    *bucket = td;
+    m_tid_lock.unlock();
+
+    KTRACE(SCHED_ADD_THREAD, td->tid, td->cpu);
+    return true;
+}
+
+void ComandroScheduler::unhash_thread(ThreadDescriptor* td) {
+    m_tid_lock.lock();
+    ThreadDescriptor** link = &m_tid_hash[td->tid & (TID_HASH_SIZE - 1)];
+    while (*link != nullptr && *link != td) {
+        link = &(*link)->tid_next;
+    }
+    if (*link == td) {
+        *link = td->tid_next;
+        td->tid_next = nullptr;
+    }
+    m_tid_lock.unlock();
+}
+
+ThreadDescriptor* ComandroScheduler::find_thread_locked(uint32_t tid) const {
+    ThreadDescriptor* td = m_tid_hash[tid & (TID_HASH_SIZE - 1)];
+    while (td != nullptr && td->tid != tid) {
+        td = td->tid_next;
+    }
+    return td;
+}
+
+void ComandroScheduler::set_thread_priority(ThreadDescriptor* td, Priority new_priority) {
+    CpuRunqueue* rq = lock_thread_runqueue(td);
+
+    bool needs_reschedule = (new_priority > td->priority);
+
+    // A thread em execucao nao esta em nenhuma fila; so e movida se estiver enfileirada
+    bool queued = is_queued(td);
+    if (queued) {
+        dequeue_thread(td);
+    }
+    // Uma thread RT que vira CRAN nao pode trazer um vruntime antigo (passaria a frente de todos).
+    // Threads DL continuam na classe Deadline: a prioridade so vale quando sairem dela.
+    if (!is_dl_thread(td) && is_rt_priority(td->priority) && !is_rt_priority(new_priority)) {
+        place_thread(rq, td, false);
+    }
+    td->priority = new_priority;
+    if (queued) {
+        enqueue_thread(td);
+    }
+
+    // Se a prioridade foi elevada, forca um reschedule imediato
+    if (needs_reschedule) {
+        Log::info(TAG, "Prioridade de TID " + std::to_string(td->tid) + " elevada. Reschedule forcado.");
+        // comandro_trigger_reschedule_interrupt(); // Simula uma interrupcao de reschedule
+    }
+
+    rq->lock.unlock();
+}
+
+bool ComandroScheduler::set_thread_deadline(ThreadDescriptor* td, const DeadlineParams& params) {
+    bool to_dl = (params.runtime_ns != 0);
+    if (to_dl && !valid_dl_params(params)) {
+        Log::error(TAG, "Parametros Deadline invalidos para TID " + std::to_string(td->tid) + ".");
+        return false;
+    }
+
+    CpuRunqueue* rq = lock_thread_runqueue(td);
+
+    // A banda e reservada na CPU atual da thread (threads DL nao migram)
+    uint64_t old_bandwidth = is_dl_thread(td) ? dl_bandwidth_of(td->dl) : 0;
+    uint64_t new_bandwidth = to_dl ? dl_bandwidth_of(params) : 0;
+    if (to_dl && !(td->cpus_allowed & cpu_bit(rq->cpu))) {
+        rq->lock.unlock();
+        Log::error(TAG, "TID " + std::to_string(td->tid) + " nao pode rodar na CPU da reserva Deadline.");
+        return false;
+    }
+    if (!dl_reserve_bandwidth(rq, new_bandwidth, old_bandwidth)) {
+        rq->lock.unlock();
+        Log::error(TAG, "Admissao Deadline recusada para TID " + std::to_string(td->tid) + ": banda insuficiente.");
+        return false;
+    }
+
+    // Retira da fila da classe antiga; uma thread throttled (fora da fila) tambem volta a esperar
+    bool was_dl = is_dl_thread(td);
+    bool waiting = is_queued(td) || (td->dl_throttled && td->on_rq && td != rq->current_thread);
+    if (is_queued(td)) {
+        dequeue_thread(td);
+    }
+    TimerHandle stale_timer = td->dl_timer_id;
+    td->dl_throttled = false;
+    td->dl_timer_id = 0;
+
+    td->dl = to_dl ? params : DeadlineParams{0, 0, 0};
+    if (to_dl) {
+        start_dl_period(td, SystemTime::get_current_ns());
+    } else if (was_dl && !is_rt_priority(td->priority)) {
+        place_thread(rq, td, false);
+    }
+    if (waiting) {
+        enqueue_thread(td);
+    }
+    rq->lock.unlock();
+
+    if (stale_timer != 0) {
+        KernelTimer::instance().cancelTimer(stale_timer);
+    }
+    return true;
+}
+
+bool ComandroScheduler::set_thread_affinity(ThreadDescriptor* td, CpuAffinityMask mask) {
+    mask &= online_cpu_mask();
+    if (mask == 0) {
+        Log::error(TAG, "Mascara de afinidade sem CPUs validas para TID " + std::to_string(td->tid) + ".");
+        return false;
+    }
+
+    CpuRunqueue* rq = lock_thread_runqueue(td);
+    if (is_dl_thread(td) && !(mask & cpu_bit(rq->cpu))) {
+        // A banda Deadline esta reservada nesta CPU
+        rq->lock.unlock();
+        Log::error(TAG, "Mascara de afinidade exclui a CPU da reserva Deadline de TID " + std::to_string(td->tid) + ".");
+        return false;
+    }
+    td->cpus_allowed = mask;
+
+    // Uma thread enfileirada numa CPU proibida e movida agora;
+    // se estiver rodando, schedule() a migra no proximo tick.
+    bool must_move = !(mask & cpu_bit(rq->cpu)) && is_queued(td);
+    if (must_move) {
+        detach_thread(rq, td);
+    }
+    rq->lock.unlock();
+
+    if (must_move) {
+        push_thread(td, select_cpu_for_thread(td, rq->cpu));
+    }
+    return true;
+}
+
+bool ComandroScheduler::set_thread_affinity(uint32_t tid, CpuAffinityMask mask) {
+    // Ordem de locks: m_tid_lock -> runqueue. O lock da tabela segura o descritor
+    // enquanto a mascara e aplicada (unhash_thread espera, e so depois vem o free).
+    m_tid_lock.lock();
+    ThreadDescriptor* td = find_thread_locked(tid);
+    bool applied = (td != nullptr) && set_thread_affinity(td, mask);
+    m_tid_lock.unlock();
+    if (td == nullptr) {
+        Log::warn(TAG, "Afinidade para TID desconhecida: " + std::to_string(tid) + ".");
+    }
+    return applied;
+}
+
+void ComandroScheduler::yield() {
+    CpuRunqueue* rq = &m_runqueues[cpu::get_current_cpu_id()];
+    rq->lock.lock();
+
+    // Uma thread CRAN passa para depois da mais a esquerda do seu grupo (chaves iguais
+    // ficam em ordem FIFO), para o pick seguinte nao a escolher de novo. O tempo ja
+    // executado e contado uma vez so, por schedule().
+    ThreadDescriptor* current_thread = rq->current_thread;
+    if (current_thread && sched_class_of(current_thread) == SCHED_CLASS_CRAN) {
+        TimelineNode* leftmost = cran_timeline_of(rq, current_thread)->leftmost();
+        if (leftmost != nullptr && cran_vruntime_of(leftmost) > current_thread->vruntime_ns) {
+            current_thread->vruntime_ns = cran_vruntime_of(leftmost);
+        }
+    }
+
+    rq->lock.unlock();
+
+    // Cede a CPU
+    schedule();
+}
+
+/**
+ * @brief A doacao direta so vale para uma thread pronta nesta CPU, e nao passa a frente
+ * de uma classe que o pick normal escolheria antes dela. O chamador segura rq->lock.
+ */
+bool ComandroScheduler::can_yield_to(CpuRunqueue* rq, ThreadDescriptor* target) {
+    if (target == nullptr || target == rq->current_thread || target->cpu != rq->cpu ||
+        target->state.load(std::memory_order_relaxed) != THREAD_RUNNABLE || !is_queued(target)) {
+        return false;
+    }
+
+    // Quem cede e continua pronto tambem esta esperando: nao doa a CPU para uma classe abaixo da sua
+    SchedClass target_class = sched_class_of(target);
+    ThreadDescriptor* prev = rq->current_thread;
+    if (prev && prev->state.load(std::memory_order_relaxed) == THREAD_RUNNABLE &&
+        sched_class_of(prev) < target_class) {
+        return false;
+    }
+
+    bool rt_waiting = !rq->rt_throttled && !rq->rt_bitmap.empty();
+    if (target_class == SCHED_CLASS_DL) {
+        // EDF: so a de deadline mais proximo; RT_EMERGENCY ainda passa na frente
+        return pick_next_dl(rq) == target && !(rt_waiting && rq->rt_bitmap.test(PRIORITY_RT_EMERGENCY));
+    }
+    if (target_class == SCHED_CLASS_RT) {
+        return !rq->rt_throttled && rq->rt_bitmap.highest() <= target->priority &&
+               (rq->dl_timeline.empty() || target->priority == PRIORITY_RT_EMERGENCY);
+    }
+    return !rt_waiting && rq->dl_timeline.empty();
+}
+
+bool ComandroScheduler::yield_to(ThreadDescriptor* target) {
+    CpuRunqueue* rq = &m_runqueues[cpu::get_current_cpu_id()];
+    rq->lock.lock();
+
+    if (!can_yield_to(rq, target)) {
+        rq->lock.unlock();
+        return false;
+    }
+
+    // Mesmo caminho de schedule(), sem balanceamento e sem pick: a proxima thread ja e conhecida
+    uint64_t current_time = SystemTime::get_current_ns();
+    PrevThreadWork work;
+    put_prev_thread(rq, current_time, &work);
+    set_next_thread(rq, target, current_time);
+    update_tick(rq, current_time);
+
+    rq->lock.unlock();
+
+    finish_prev_thread(rq, &work);
+    return true;
+}
+
+ThreadDescriptor* ComandroScheduler::get_current_thread(int cpu) {
+    if (cpu < 0 || cpu >= m_nr_cpus) {
+        return nullptr;
+    }
+    CpuRunqueue* rq = &m_runqueues[cpu];
+    SpinLock::Guard guard(rq->lock);
+    return rq->current_thread;
+}
+
+uint64_t ComandroScheduler::get_next_tick_ns(int cpu) const {
+    if (cpu < 0 || cpu >= m_nr_cpus) {
+        return UINT64_MAX;
+    }
+    return m_runqueues[cpu].next_tick_ns.load(std::memory_order_relaxed);
+}
+
+TickMode ComandroScheduler::get_tick_mode(int cpu) {
+    if (cpu < 0 || cpu >= m_nr_cpus) {
+        return TICK_PERIODIC;
+    }
+    CpuRunqueue* rq = &m_runqueues[cpu];
+    SpinLock::Guard guard(rq->lock);
+    return rq->tick_mode;
+}
+
+uint32_t ComandroScheduler::get_cpu_util(int cpu) const {
+    if (cpu < 0 || cpu >= m_nr_cpus) {
+        return 0;
+    }
+    uint64_t snapshot = m_runqueues[cpu].util_snapshot.load(std::memory_order_relaxed);
+    uint64_t util = snapshot & UTIL_SNAPSHOT_UTIL_MASK;
+    if (snapshot & UTIL_SNAPSHOT_IDLE) {
+        // Sem tick, ninguem atualiza a CPU ociosa: aplica o decaimento desde a ultima atualizacao
+        uint64_t last_update_us = snapshot >> UTIL_SNAPSHOT_TIME_SHIFT;
+        uint64_t now_us = SystemTime::get_current_ns() >> 10;
+        if (now_us > last_update_us) {
+            util = pelt_decay(util, (now_us - last_update_us) / PELT_PERIOD_US);
+        }
+    }
+    uint32_t capacity = EnergyModel::instance().cpu_capacity(cpu);
+    return (capacity != 0 && util > capacity) ? capacity : static_cast<uint32_t>(util);
+}
+
+void ComandroScheduler::set_nohz_enabled(bool enabled) {
+    m_nohz_enabled.store(enabled, std::memory_order_relaxed);
+    if (!enabled) {
+        // Cada CPU volta ao tick periodico no proximo schedule()
+        for (int cpu = 0; cpu < m_nr_cpus; ++cpu) {
+            kick_cpu(&m_runqueues[cpu]);
+        }
+    }
+    Log::info(TAG, std::string("NO_HZ ") + (enabled ? "habilitado." : "desabilitado."));
+}
+
+bool ComandroScheduler::set_rt_bandwidth(uint64_t runtime_ns, uint64_t period_ns) {
+    if (period_ns == 0) {
+        return false;
+    }
+    // Cada CPU passa a usar os novos valores no proximo schedule()
+    m_rt_period_ns.store(period_ns, std::memory_order_relaxed);
+    m_rt_runtime_ns.store(runtime_ns, std::memory_order_relaxed);
+    if (runtime_ns >= period_ns) {
+        Log::info(TAG, "Banda RT sem limite.");
+    } else {
+        Log::info(TAG, "Banda RT: " + std::to_string(runtime_ns) + "ns a cada " + std::to_string(period_ns) + "ns por CPU.");
+    }
+    return true;
+}
+
+bool ComandroScheduler::set_background_bandwidth(uint64_t quota_ns, uint64_t period_ns) {
+    if (period_ns == 0) {
+        return false;
+    }
+    m_bg_period_ns.store(period_ns, std::memory_order_relaxed);
+    m_bg_quota_ns.store(quota_ns, std::memory_order_relaxed);
+    // A nova cota vale ja no periodo atual
+    m_bg_pool_ns.store(static_cast<int64_t>(quota_ns), std::memory_order_relaxed);
+    if (quota_ns == 0) {
+        Log::info(TAG, "Cota do grupo background sem limite.");
+    } else {
+        Log::info(TAG, "Cota do grupo background: " + std::to_string(quota_ns) + "ns a cada " + std::to_string(period_ns) + "ns.");
+    }
+    return true;
+}
+
+bool ComandroScheduler::get_throttle_stats(int cpu, SchedThrottleStats* out) const {
+    if (cpu < -1 || cpu >= m_nr_cpus) {
+        return false;
+    }
+
+    *out = SchedThrottleStats{};
+    for (int i = 0; i < m_nr_cpus; ++i) {
+        if (cpu < 0 || cpu == i) {
+            const CpuRunqueue* rq = &m_runqueues[i];
+            out->rt_throttle_count += rq->rt_throttle_count.load(std::memory_order_relaxed);
+            out->rt_throttled_ns += rq->rt_throttled_ns.load(std::memory_order_relaxed);
+            out->bg_throttle_count += rq->bg_throttle_count.load(std::memory_order_relaxed);
+            out->bg_throttled_ns += rq->bg_throttled_ns.load(std::memory_order_relaxed);
+        }
+    }
+    return true;
+}
+
+bool ComandroScheduler::get_wakeup_latency(int level, int cpu, SchedLatencySummary* out) const {
+    if (level < 0 || level >= LATENCY_PRIORITY_LEVELS || cpu < -1 || cpu >= m_nr_cpus) {
+        return false;
+    }
+
+    LatencySnapshot snapshot;
+    for (int i = 0; i < m_nr_cpus; ++i) {
+        if (cpu < 0 || cpu == i) {
+            snapshot.add(m_runqueues[i].wakeup_latency[level]);
+        }
+    }
+
+    out->priority = LATENCY_LEVEL_PRIORITY[level];
+    out->samples = snapshot.count;
+    out->mean_ns = snapshot.mean_ns();
+    out->p50_ns = snapshot.percentile(0.50);
+    out->p90_ns = snapshot.percentile(0.90);
+    out->p99_ns = snapshot.percentile(0.99);
+    out->p999_ns = snapshot.percentile(0.999);
+    out->max_ns = snapshot.max_ns;
+    return true;
+}
+
+// =====================================================================
+// Bloqueio, Sleep e Wake-up
+// =====================================================================
+
+/**
+ * @brief Torna a thread RUNNABLE e a devolve a um runqueue.
+ * * A thread e reivindicada por CAS no estado (BLOCKED/SLEEPING -> WAKING): so um
+ *   wakeup vence, sem travar nada. Se ela pertence a outra CPU, entra na wake_list
+ *   daquela CPU e o lock remoto nunca e tocado; a CPU dona a ativa em schedule().
+ * * So o timer de sleep acorda SLEEPING; os demais wakeups so acordam BLOCKED. Um
+ *   wakeup atrasado (reply de IPC, servidor antigo) nao encurta um sleep sem relacao.
+ * * Enquanto nao for RUNNABLE a thread nao esta em nenhuma fila, entao td->cpu nao muda.
+ */
+bool ComandroScheduler::try_wake_up(ThreadDescriptor* td, bool timer_fired) {
+    ThreadState state = timer_fired ? THREAD_SLEEPING : THREAD_BLOCKED;
+    if (!td->state.compare_exchange_strong(state, THREAD_WAKING, std::memory_order_acq_rel)) {
+        return false; // Ja RUNNABLE, outro wakeup venceu, ou esperando por outro motivo
+    }
+
+    // O timer de sleep venceu: o ID nao vale mais
+    if (timer_fired) {
+        td->sleep_timer_id.store(0);
+    }
+
+    uint64_t now_ns = SystemTime::get_current_ns();
+    td->wakeup_time_ns = now_ns;
+
+    if (td->cpu != cpu::get_current_cpu_id()) {
+        queue_remote_wakeup(td);
+        return true;
+    }
+
+    int push_cpu = -1;
+    uint64_t dl_throttle_delay_ns = 0;
+    CpuRunqueue* rq = runqueue_of(td);
+    rq->lock.lock();
+    activate_woken_thread(rq, td, now_ns, &push_cpu, &dl_throttle_delay_ns);
+    rq->lock.unlock();
+
+    finish_wakeup(td, push_cpu, dl_throttle_delay_ns);
+    return true;
+}
+
+/**
+ * @brief WAKING -> RUNNABLE no runqueue dono da thread. O chamador segura rq->lock.
+ * * Se a thread ainda nao saiu da CPU (bloqueou mas schedule() nao rodou), basta
+ *   mudar o estado: schedule() a reenfileira em vez de retira-la.
+ * * push_cpu / dl_throttle_delay_ns: trabalho que finish_wakeup faz sem o lock.
+ */
+void ComandroScheduler::activate_woken_thread(CpuRunqueue* rq, ThreadDescriptor* td, uint64_t now_ns,
+                                              int* push_cpu, uint64_t* dl_throttle_delay_ns) {
+    *push_cpu = -1;
+    *dl_throttle_delay_ns = 0;
+    td->state.store(THREAD_RUNNABLE, std::memory_order_release);
+
+    if (td->on_rq) {
+        td->wakeup_time_ns = 0; // Nao chegou a sair da CPU: nao ha latencia a medir
+        return;
+    }
+
+    pelt_update(&td->avg, now_ns, false, 0); // Decai pelo tempo dormindo
+
+    int target_cpu = -1;
+    if (is_dl_thread(td)) {
+        if (update_dl_on_wakeup(td, now_ns)) {
+            *dl_throttle_delay_ns = dl_next_period_ns(td) - now_ns;
+        }
+    } else {
+        place_thread(rq, td, false);
+        if (!is_rt_priority(td->priority)) {
+            // CRAN: a CPU onde a thread gasta menos energia (big.LITTLE); -1 = modelo fora de jogo
+            int prev_cpu = (td->cpus_allowed & cpu_bit(rq->cpu)) ? rq->cpu : -1;
+            target_cpu = EnergyModel::instance().find_energy_efficient_cpu(td->avg.util_avg, td->cpus_allowed, prev_cpu);
+        }
+    }
+    if (target_cpu >= 0 && target_cpu != rq->cpu) {
+        detach_load(rq, td);
+        td->vruntime_ns -= rq->min_vruntime;
+        *push_cpu = target_cpu;
+    } else if (td->cpus_allowed & cpu_bit(rq->cpu)) {
+        // Volta para a ultima CPU (cache ainda quente)
+        activate_thread(rq, td);
+    } else {
+        detach_load(rq, td);
+        td->vruntime_ns -= rq->min_vruntime;
+        *push_cpu = select_cpu_for_thread(td, rq->cpu);
+    }
+}
+
+void ComandroScheduler::finish_wakeup(ThreadDescriptor* td, int push_cpu, uint64_t dl_throttle_delay_ns) {
+    if (push_cpu >= 0) {
+        push_thread(td, push_cpu);
+    }
+    if (dl_throttle_delay_ns != 0) {
+        start_dl_replenish_timer(td, dl_throttle_delay_ns);
+    }
+}
+
+/**
+ * @brief Empilha uma thread WAKING na wake_list da CPU dona (push de Treiber, sem lock).
+ * * Nao ha ABA: o unico consumidor retira a lista inteira de uma vez.
+ */
+void ComandroScheduler::queue_remote_wakeup(ThreadDescriptor* td) {
+    CpuRunqueue* rq = runqueue_of(td);
+    ThreadDescriptor* head = rq->wake_list.load(std::memory_order_relaxed);
+    do {
+        td->wake_next = head;
+    } while (!rq->wake_list.compare_exchange_weak(head, td, std::memory_order_release,
+                                                  std::memory_order_relaxed));
+
+    // Lista estava vazia: a CPU dona precisa passar por schedule() para ativar a thread
+    if (head == nullptr) {
+        kick_cpu(rq); // IPI de reschedule (uma por lote)
+    }
+}
+
+/**
+ * @brief Ativa as threads da wake_list desta CPU, na ordem de chegada.
+ * * Chamado apenas pela CPU dona, fora do lock; o lock e adquirido por lote de
+ *   WAKE_LIST_BATCH threads, e o trabalho que trava outros locks (push, timers DL)
+ *   e feito entre os lotes.
+ */
+void ComandroScheduler::drain_wake_list(CpuRunqueue* rq) {
+    if (rq->wake_list.load(std::memory_order_relaxed) == nullptr) {
+        return;
+    }
+    ThreadDescriptor* stack = rq->wake_list.exchange(nullptr, std::memory_order_acquire);
+
+    // A pilha e LIFO: inverte para acordar na ordem dos wakeups
+    ThreadDescriptor* pending = nullptr;
+    while (stack != nullptr) {
+        ThreadDescriptor* next = stack->wake_next;
+        stack->wake_next = pending;
+        pending = stack;
+        stack = next;
+    }
+
+    while (pending != nullptr) {
+        ThreadDescriptor* batch[WAKE_LIST_BATCH];
+        int push_cpu[WAKE_LIST_BATCH];
+        uint64_t dl_throttle_delay_ns[WAKE_LIST_BATCH];
+        int count = 0;
+
+        rq->lock.lock();
+        uint64_t now_ns = SystemTime::get_current_ns();
+        while (pending != nullptr && count < WAKE_LIST_BATCH) {
+            ThreadDescriptor* td = pending;
+            pending = td->wake_next;
+            td->wake_next = nullptr;
+            activate_woken_thread(rq, td, now_ns, &push_cpu[count], &dl_throttle_delay_ns[count]);
+            batch[count++] = td;
+        }
+        rq->lock.unlock();
+
+        for (int i = 0; i < count; ++i) {
+            finish_wakeup(batch[i], push_cpu[i], dl_throttle_delay_ns[i]);
+        }
+    }
+}
+
+/**
+ * @brief Callback do KernelTimer (contexto de kernel thread): o sleep expirou.
+ */
+void ComandroScheduler::sleep_timer_expired(void* context, uint32_t /*overruns*/) {
+    instance().try_wake_up(static_cast<ThreadDescriptor*>(context), true);
+}
+
+/**
+ * @brief Condicao do block_until da thread softirq: ha callbacks de timer na fila da CPU.
+ */
+bool ComandroScheduler::timer_softirq_pending(void* context) {
+    return KernelTimer::instance().softirqPending(static_cast<CpuRunqueue*>(context)->cpu);
+}
+
+void ComandroScheduler::timer_softirq_loop() {
+    CpuRunqueue* rq = &m_runqueues[cpu::get_current_cpu_id()];
+    rq->lock.lock();
+    ThreadDescriptor* td = rq->current_thread;
+    rq->lock.unlock();
+    if (td == nullptr) {
+        // Os callbacks desta CPU ficam na fila ate alguem rodar o laco numa thread de verdade
+        Log::critical(TAG, "timer_softirq_loop fora de uma thread na CPU " + std::to_string(rq->cpu) +
+                           ". Timers desta CPU nao vao disparar.");
+        return;
+    }
+    rq->timer_softirq_thread.store(td, std::memory_order_release);
+
+    for (;;) {
+        KernelTimer::instance().runSoftirq();
+        block_until(&ComandroScheduler::timer_softirq_pending, rq, nullptr);
+    }
+}
+
+void ComandroScheduler::raise_timer_softirq(int cpu) {
+    if (cpu < 0 || cpu >= m_nr_cpus) {
+        return;
+    }
+    ThreadDescriptor* td = m_runqueues[cpu].timer_softirq_thread.load(std::memory_order_acquire);
+    if (td != nullptr) {
+        try_wake_up(td, false);
+    }
+}
+
+bool ComandroScheduler::wake_up_thread(ThreadDescriptor* td) {
+    return try_wake_up(td, false);
+}
+
+void ComandroScheduler::block_on(WaitQueue* wq) {
+    CpuRunqueue* rq = &m_runqueues[cpu::get_current_cpu_id()];
+
+    // Ordem de locks: WaitQueue -> runqueue (quem acorda solta a WaitQueue antes)
+    wq->lock.lock();
+    rq->lock.lock();
+    ThreadDescriptor* td = rq->current_thread;
+    if (td == nullptr) {
+        rq->lock.unlock();
+        wq->lock.unlock();
+        return;
+    }
+    td->state = THREAD_BLOCKED;
+    rq->lock.unlock();
+    list_add_tail(&td->wait_node, &wq->waiters);
+    wq->lock.unlock();
+
+    // Sai da CPU; um wake-up que chegue antes disso apenas restaura RUNNABLE
+    schedule();
+}
+
+bool ComandroScheduler::block_until(bool (*condition)(void* context), void* context, ThreadDescriptor* handoff) {
+    CpuRunqueue* rq = &m_runqueues[cpu::get_current_cpu_id()];
+
+    rq->lock.lock();
+    ThreadDescriptor* td = rq->current_thread;
+    if (td == nullptr) {
+        rq->lock.unlock();
+        return false;
+    }
+    td->state = THREAD_BLOCKED;
+
+    // Par do wake_up_thread() de quem publica a condicao: ou ele ve BLOCKED, ou este teste ve a condicao.
+    // Testada ainda com o lock (interrupcoes desligadas): um tick entre BLOCKED e o teste tiraria a
+    // thread do runqueue depois de um wakeup que, vendo RUNNABLE, nao fez nada.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (condition(context)) {
+        // Desfaz o BLOCKED; se um wakeup concorrente ja o pegou, ele mesmo restaura RUNNABLE
+        ThreadState blocked = THREAD_BLOCKED;
+        td->state.compare_exchange_strong(blocked, THREAD_RUNNABLE, std::memory_order_acq_rel);
+        rq->lock.unlock();
+        return false;
+    }
+    rq->lock.unlock();
+
+    // Sai da CPU; um wake-up que chegue antes disso apenas restaura RUNNABLE
+    if (handoff == nullptr || !yield_to(handoff)) {
+        schedule();
+    }
+    return true;
+}
+
+bool ComandroScheduler::wake_up_one(WaitQueue* wq) {
+    wq->lock.lock();
+    if (list_empty(&wq->waiters)) {
+        wq->lock.unlock();
+        return false;
+    }
+    ThreadDescriptor* td = list_entry(wq->waiters.next, ThreadDescriptor, wait_node);
+    list_del_init(&td->wait_node);
+    wq->lock.unlock();
+
+    return try_wake_up(td, false);
+}
+
+int ComandroScheduler::wake_up_all(WaitQueue* wq) {
+    // Desliga a lista inteira sob o lock e acorda fora dele
+    list_head woken;
+    INIT_LIST_HEAD(&woken);
+
+    wq->lock.lock();
+    if (!list_empty(&wq->waiters)) {
+        woken.next = wq->waiters.next;
+        woken.prev = wq->waiters.prev;
+        woken.next->prev = &woken;
+        woken.prev->next = &woken;
+        INIT_LIST_HEAD(&wq->waiters);
+    }
+    wq->lock.unlock();
+
+    int count = 0;
+    while (!list_empty(&woken)) {
+        ThreadDescriptor* td = list_entry(woken.next, ThreadDescriptor, wait_node);
+        list_del_init(&td->wait_node);
+        if (try_wake_up(td, false)) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+void ComandroScheduler::sleep_current(std::chrono::nanoseconds duration, std::chrono::nanoseconds slack) {
+    CpuRunqueue* rq = &m_runqueues[cpu::get_current_cpu_id()];
+
+    rq->lock.lock();
+    ThreadDescriptor* td = rq->current_thread;
+    if (td == nullptr) {
+        rq->lock.unlock();
+        return;
+    }
+
+    // 1. Arma o timer one-shot que reenfileira a thread na expiracao, ainda com o lock
+    //    (interrupcoes desligadas): um tick entre publicar SLEEPING e armar o timer
+    //    tiraria a thread do runqueue sem nada que a acorde. O timer vai para a base
+    //    desta CPU, cujo IRQ nao roda enquanto o lock esta preso.
+    TimerHandle timer_id = KernelTimer::instance().setTimer(duration, &ComandroScheduler::sleep_timer_expired, td, false, slack);
+    if (timer_id == 0) {
+        // Duracao invalida (zero): nao ha o que esperar
+        rq->lock.unlock();
+        return;
+    }
+
+    // 2. Registra o timer (so ele acorda um SLEEPING, ver try_wake_up)
+    td->sleep_timer_id.store(timer_id);
+    td->state = THREAD_SLEEPING;
+    rq->lock.unlock();
+
+    // 3. Sai da CPU ate o timer expirar
+    schedule();
+}
+
+void ComandroScheduler::sleep(std::chrono::milliseconds duration, std::chrono::milliseconds slack) {
+    instance().sleep_current(duration, slack);
+}
+
+uint32_t ComandroScheduler::sleep_periodic(PeriodicClock* clock, std::chrono::nanoseconds slack) {
+    if (clock->period_ns == 0) {
+        return 0;
+    }
+    uint64_t now_ns = SystemTime::get_current_ns();
+    if (clock->next_ns == 0) {
+        clock->next_ns = now_ns + clock->period_ns;
+    }
+
+    // Ja passou do instante (trabalho da volta anterior maior que o periodo): nao dorme
+    uint64_t target_ns = clock->next_ns;
+    if (now_ns < target_ns) {
+        sleep_current(std::chrono::nanoseconds(target_ns - now_ns), slack);
+        now_ns = SystemTime::get_current_ns();
+    }
+
+    // Vence o periodo de target_ns; os que passaram depois dele ficam so na contagem
+    uint64_t missed = (now_ns > target_ns) ? (now_ns - target_ns) / clock->period_ns : 0;
+    clock->next_ns = target_ns + (missed + 1) * clock->period_ns;
+    return (missed > UINT32_MAX) ? UINT32_MAX : static_cast<uint32_t>(missed);
+}
+
+} // namespace scheduler
+} // namespace kernel
+} // namespace comandro
+
+// =====================================================================
+// Interface nativa para o dexter (sched_latency, sched_throttle)
+// =====================================================================
+
+extern "C" int native_get_sched_cpu_count() {
+    return comandro::kernel::scheduler::ComandroScheduler::instance().get_cpu_count();
+}
+
+extern "C" int native_get_sched_latency(int level, int cpu, comandro::kernel::scheduler::SchedLatencySummary* out) {
+    return comandro::kernel::scheduler::ComandroScheduler::instance().get_wakeup_latency(level, cpu, out) ? 0 : -1;
+}
+
+extern "C" int native_get_sched_throttle(int cpu, comandro::kernel::scheduler::SchedThrottleStats* out) {
+    return comandro::kernel::scheduler::ComandroScheduler::instance().get_throttle_stats(cpu, out) ? 0 : -1;
+}
@@ -2,8 +2,17 @@
 #define COMANDRO_KERNEL_SCHEDULER_H
 
 #include <comandro/kernel/thread.h>
+#include <comandro/kernel/KernelTimer.h> // TimerHandle
 #include <comandro/kernel/list.h> // Simula uma lista ligada do kernel
+#include <comandro/kernel/lock.h> // Simula um spinlock
+#include "Bandwidth.h"
+#include "EnergyModel.h"
+#include "LatencyHistogram.h"
+#include "Pelt.h"
+#include "RtPriorityBitmap.h"
+#include "Timeline.h"
 #include <stdint.h>
+#include <atomic>
 #include <chrono>
 
 namespace comandro {
@@ -21,65 +30,505 @@ enum Priority {
     PRIORITY_VERY_LOW = 1,          // Garbage Collector, Log Uploads
 };
 
-// Estrutura do Descritor de Thread
-struct ThreadDescriptor {
-    uint32_t tid;                   // ID da thread
+// Numero maximo de CPUs (mesma largura da mascara do CpuMaskManager do Binder)
+static constexpr int SCHED_MAX_CPUS = 64;
+
+// Mascara de afinidade: bit N = CPU N (mesma codificacao de binder::server::CpuMaskArray)
+using CpuAffinityMask = uint64_t;
+static constexpr CpuAffinityMask CPU_AFFINITY_ALL = ~0ULL;
+
+// Tabela TID -> ThreadDescriptor (afinidade aplicada por TID pelo Binder)
+static constexpr int TID_HASH_BITS = 10;
+static constexpr int TID_HASH_SIZE = 1 << TID_HASH_BITS;
+
+// Estado de uma thread perante o scheduler
+enum ThreadState {
+    THREAD_RUNNABLE = 0,    // Pronta ou em execucao
+    THREAD_BLOCKED,         // Esperando em uma WaitQueue
+    THREAD_SLEEPING,        // Dormindo ate um timer one-shot do KernelTimer
+    THREAD_WAKING,          // Acordada por outra CPU: na wake_list, aguardando a CPU dona
+};
+
+// Tick do scheduler (mesmo periodo do HW_TICK_RATE do KernelTimer)
+static constexpr uint64_t SCHED_TICK_NS = 1000000; // 1ms
+// Tick residual de uma CPU com uma unica thread (contabilidade de runtime)
+static constexpr uint64_t SCHED_TICK_REDUCED_NS = 10000000; // 10ms
+
+// Modo do tick de uma CPU (NO_HZ)
+enum TickMode {
+    TICK_PERIODIC = 0,      // Threads esperando: tick a cada SCHED_TICK_NS (preempcao, balanceamento)
+    TICK_REDUCED,           // Uma thread so: tick residual, ou o fim do orcamento DL
+    TICK_STOPPED,           // Ociosa: sem tick; acorda por IPI (timers do KernelTimer migram para uma CPU ocupada, se houver)
+};
+
+/**
+ * @brief Parametros da classe Deadline (EDF + Constant Bandwidth Server).
+ * * A cada periodo a thread recebe runtime_ns de CPU, que deve ser consumido ate
+ *   deadline_ns apos o inicio do periodo. Requer 0 < runtime <= deadline <= period.
+ * * runtime_ns == 0: a thread nao usa a classe Deadline (RT/CRAN pela prioridade).
+ */
+struct DeadlineParams {
+    uint64_t runtime_ns;            // Orcamento de CPU por periodo (pior caso)
+    uint64_t deadline_ns;           // Prazo relativo ao inicio do periodo
+    uint64_t period_ns;             // Periodo de ativacao (ex.: buffer de audio, frame)
+};
+
+/**
+ * @brief Descritor de Thread, agrupado por temperatura (linhas de cache de 64 bytes).
+ * * Linha 0 (quente): o que pick_next_* e enqueue/dequeue leem de cada candidata.
+ *   O pick CRAN compara a chave copiada em run_node, nao vruntime_ns.
+ * * Linha 1 (morna): contabilidade da troca de contexto (put_prev/set_next) e wakeup.
+ * * Resto (frio): PELT, estado DL, timers, WaitQueue e estatisticas.
+ * * Alocado pelo ThreadDescriptorCache (slab por CPU), que mantem o alinhamento.
+ */
+struct alignas(64) ThreadDescriptor {
+    // --- Linha 0: caminho do pick ---
+    // No da timeline CRAN (ordenada por vruntime) ou DL (ordenada por deadline absoluto)
+    TimelineNode run_node;
+    // No da lista RT (FIFO por nivel de prioridade)
+    list_head list_node;
     Priority priority;              // Prioridade atual
+    int cpu;                        // CPU cujo runqueue possui a thread
+
+    // --- Linha 1: troca de contexto e wakeup ---
     uint64_t vruntime_ns;           // Virtual Runtime (para agendamento CRAN)
     uint64_t exec_start_time_ns;    // Tempo de inicio da ultima execucao
+    DeadlineParams dl;              // Parametros Deadline pedidos (runtime_ns != 0: classe DL)
+    // BLOCKED/SLEEPING -> RUNNABLE|WAKING por CAS de quem acorda (sem lock); o resto sob o lock do runqueue
+    std::atomic<ThreadState> state;
+    uint32_t tid;                   // ID da thread
+    bool on_rq;                     // Contada em nr_running do runqueue (enfileirada ou em execucao)
+    uint64_t wakeup_time_ns;        // Enfileirada pelo wakeup neste instante (0 = nenhuma medicao pendente)
+
+    // --- Frio ---
+    ThreadDescriptor* wake_next;    // Proximo na wake_list da CPU (valido enquanto THREAD_WAKING)
+    CpuAffinityMask cpus_allowed;   // CPUs onde a thread pode rodar (0 no add_thread = todas)
+    ThreadDescriptor* tid_next;     // Proximo no bucket da tabela de TIDs (sob m_tid_lock)
+
+    // Utilizacao PELT da thread (protegida pelo lock do runqueue); acompanha a thread na migracao
+    SchedAvg avg;
+
+    // Estado da classe Deadline (protegido pelo lock do runqueue da thread)
+    uint64_t dl_deadline_ns;        // Deadline absoluto do periodo atual (chave EDF)
+    int64_t dl_runtime_left_ns;     // Orcamento restante no periodo atual
+    bool dl_throttled;              // Orcamento esgotado: fora da fila ate a reposicao
+    TimerHandle dl_timer_id;        // Timer de reposicao do orcamento (0 = nenhum)
+
+    std::atomic<TimerHandle> sleep_timer_id; // Timer do KernelTimer que acordara a thread (0 = nenhum)
     uint64_t total_runtime_ns;      // Tempo total de execucao
-    
-    // Ponteiros para listas do scheduler (RT ou CRAN)
-    list_head list_node; 
+    // No da WaitQueue em que a thread esta bloqueada
+    list_head wait_node;
 };
 
-class ComandroScheduler {
-private:
+static_assert(offsetof(ThreadDescriptor, cpu) + sizeof(int) <= 64,
+              "ThreadDescriptor: campos do pick devem caber na primeira linha de cache");
+static_assert(offsetof(ThreadDescriptor, wakeup_time_ns) + sizeof(uint64_t) <= 128,
+              "ThreadDescriptor: campos da troca de contexto devem caber na segunda linha de cache");
+
+/**
+ * @brief Fila de espera: threads BLOCKED aguardando um evento (semaforo, mensagem, I/O).
+ */
+struct WaitQueue {
+    SpinLock lock;
+    list_head waiters;
+
+    WaitQueue() { INIT_LIST_HEAD(&waiters); }
+};
+
+/**
+ * @brief Fase de um loop periodico do kernel (governor, monitor de seguranca), ver sleep_periodic().
+ * * next_ns avanca em multiplos exatos de period_ns: o tempo de trabalho de cada
+ *   volta nao acumula deriva.
+ */
+struct PeriodicClock {
+    uint64_t period_ns;
+    uint64_t next_ns;       // Proximo despertar (SystemTime); 0 = um periodo depois do primeiro sleep
+
+    explicit PeriodicClock(std::chrono::nanoseconds period)
+        : period_ns(static_cast<uint64_t>(period.count())), next_ns(0) {}
+};
+
+/**
+ * @brief Runqueue de uma CPU: cada nucleo agenda de forma independente, com o seu proprio lock.
+ */
+struct alignas(64) CpuRunqueue {
+    // O Spinlock protege as filas de execucao desta CPU
+    SpinLock lock;
+    
     // Fila para threads de Tempo Real (RT): Listas para cada nivel de prioridade RT.
-    list_head rt_runqueue[100]; // 99 -> 70
+    list_head rt_runqueue[RT_PRIORITY_LEVELS]; // 99 -> 85
+    // Bit setado = fila RT do nivel correspondente nao esta vazia
+    RtPriorityBitmap rt_bitmap;
     
-    // Fila para threads Cranberry (CRAN): Estrutura de arvore binaria ou lista ordenada.
-    list_head cran_runqueue; 
+    // Fila para threads Cranberry (CRAN): Arvore Rubro-Negra ordenada por vruntime.
+    Timeline cran_timeline; 
+    // Grupo CRAN_BACKGROUND (prioridade <= PRIORITY_CRAN_BACKGROUND): mesma escala de
+    // vruntime, fila separada para que a cota do grupo possa tira-lo da disputa
+    Timeline bg_timeline;
+
+    // Fila para threads Deadline (DL): EDF, ordenada por deadline absoluto.
+    Timeline dl_timeline;
+    // Banda DL reservada nesta CPU (soma de runtime/period, ponto fixo DL_BW_SHIFT)
+    std::atomic<uint64_t> dl_bandwidth{0};
     
     ThreadDescriptor* current_thread = nullptr;
 
-    // Funcoes internas
+    // Menor vruntime do runqueue (so cresce); referencia para posicionar threads novas/acordadas
+    uint64_t min_vruntime = 0;
+
+    // Threads associadas a esta CPU (enfileiradas + atual). Lido sem lock pelo balanceador.
+    std::atomic<uint32_t> nr_running{0};
+
+    // Wakeups vindos de outras CPUs: pilha lock-free MPSC (push por CAS, a CPU dona esvazia
+    // tudo de uma vez com exchange). Quem acorda nao toca no lock deste runqueue.
+    alignas(64) std::atomic<ThreadDescriptor*> wake_list{nullptr};
+    
+    uint64_t next_balance_ns = 0;   // Proximo balanceamento periodico
+    int cpu = 0;
+
+    // Thread softirq de timers desta CPU (nullptr ate ela entrar em timer_softirq_loop)
+    std::atomic<ThreadDescriptor*> timer_softirq_thread{nullptr};
+
+    // NO_HZ: modo atual e instante do proximo schedule() pedido ao timer local (0 = imediato).
+    // next_tick_ns e zerado sem lock por quem enfileira trabalho numa CPU fora do modo periodico.
+    TickMode tick_mode = TICK_PERIODIC;
+    std::atomic<uint64_t> next_tick_ns{0};
+
+    // Latencia wakeup -> execucao das threads que entraram nesta CPU, por nivel de prioridade
+    LatencyHistogram wakeup_latency[LATENCY_PRIORITY_LEVELS];
+
+    // Utilizacao PELT da CPU: tempo ocupado decaido, mais/menos as threads migradas
+    SchedAvg avg = {};
+    // Copia publicada para leitura sem lock: util_avg | ocioso << 11 | (ultima atualizacao >> 10) << 12
+    std::atomic<uint64_t> util_snapshot{0};
+
+    // Banda RT (sob o lock): tempo RT consumido no periodo atual desta CPU
+    uint64_t rt_period_start_ns = 0;
+    uint64_t rt_time_ns = 0;
+    bool rt_throttled = false;
+    uint64_t rt_throttled_since_ns = 0;
+
+    // Cota do grupo background (sob o lock): fatia local retirada do pool global
+    uint64_t bg_period_start_ns = 0;
+    int64_t bg_runtime_left_ns = 0;
+    bool bg_throttled = false;
+    uint64_t bg_throttled_since_ns = 0;
+
+    // Contadores de throttle (diagnostico, lidos sem lock)
+    std::atomic<uint64_t> rt_throttle_count{0};
+    std::atomic<uint64_t> rt_throttled_ns{0};
+    std::atomic<uint64_t> bg_throttle_count{0};
+    std::atomic<uint64_t> bg_throttled_ns{0};
+};
+
+class ComandroScheduler {
+private:
+    CpuRunqueue m_runqueues[SCHED_MAX_CPUS];
+    int m_nr_cpus;
+
+    // NO_HZ: CPUs com o tick parado ou reduzido (candidatas a receber trabalho)
+    std::atomic<CpuAffinityMask> m_nohz_mask{0};
+    std::atomic<bool> m_nohz_enabled{true};
+
+    // Banda RT por CPU (runtime >= period: sem limite)
+    std::atomic<uint64_t> m_rt_runtime_ns{RT_RUNTIME_NS_DEFAULT};
+    std::atomic<uint64_t> m_rt_period_ns{RT_PERIOD_NS_DEFAULT};
+
+    // Cota global do grupo background (quota 0: sem limite). O pool e recarregado
+    // pela primeira CPU que ve o periodo virar.
+    std::atomic<uint64_t> m_bg_quota_ns{0};
+    std::atomic<uint64_t> m_bg_period_ns{BG_PERIOD_NS_DEFAULT};
+    std::atomic<uint64_t> m_bg_period_start_ns{0};
+    std::atomic<int64_t> m_bg_pool_ns{0};
+
+    // Threads adicionadas, por TID (encadeadas por tid_next)
+    SpinLock m_tid_lock;
+    ThreadDescriptor* m_tid_hash[TID_HASH_SIZE] = {};
+
+    // Trabalho deixado por put_prev_thread para depois de soltar o lock do runqueue
+    struct PrevThreadWork {
+        ThreadDescriptor* migrating;    // A afinidade mudou enquanto rodava: push para outra CPU
+        ThreadDescriptor* dl_throttled; // Orcamento DL esgotado: arma o timer de reposicao
+        uint64_t dl_throttle_delay_ns;
+    };
+
+    // Funcoes internas (o chamador segura o lock do runqueue da thread)
     void enqueue_thread(ThreadDescriptor* td);
     void dequeue_thread(ThreadDescriptor* td);
-    ThreadDescriptor* pick_next_thread();
+    bool is_queued(const ThreadDescriptor* td) const;
+    ThreadDescriptor* pick_next_thread(CpuRunqueue* rq);
+    CpuAffinityMask online_cpu_mask() const;
+
+    // Tabela de TIDs (o chamador segura m_tid_lock)
+    ThreadDescriptor* find_thread_locked(uint32_t tid) const;
+
+    // Troca de contexto: schedule() e yield_to() (o chamador segura rq->lock, exceto finish_prev_thread)
+    void put_prev_thread(CpuRunqueue* rq, uint64_t now_ns, PrevThreadWork* work);
+    void set_next_thread(CpuRunqueue* rq, ThreadDescriptor* next_td, uint64_t now_ns);
+    void finish_prev_thread(CpuRunqueue* rq, const PrevThreadWork* work);
+    bool can_yield_to(CpuRunqueue* rq, ThreadDescriptor* target);
     
     // Logica de Tempo Real
-    ThreadDescriptor* pick_next_rt();
+    ThreadDescriptor* pick_next_rt(CpuRunqueue* rq);
     
+    // Logica Deadline (EDF + CBS)
+    ThreadDescriptor* pick_next_dl(CpuRunqueue* rq);
+    bool update_dl_runtime(ThreadDescriptor* td, uint64_t actual_runtime_ns, uint64_t now_ns);
+    bool update_dl_on_wakeup(ThreadDescriptor* td, uint64_t now_ns);
+    void start_dl_replenish_timer(ThreadDescriptor* td, uint64_t delay_ns);
+    void replenish_dl_thread(ThreadDescriptor* td);
+    static void dl_replenish_timer_expired(void* context, uint32_t overruns);
+    int admit_dl_thread(const ThreadDescriptor* td, uint64_t bandwidth);
+
     // Logica Cranberry (fair, mas focado em baixa latencia)
-    ThreadDescriptor* pick_next_cran();
+    ThreadDescriptor* pick_next_cran(CpuRunqueue* rq);
     void update_vruntime(ThreadDescriptor* td, uint64_t actual_runtime_ns);
+    void update_min_vruntime(CpuRunqueue* rq);
+    void place_thread(CpuRunqueue* rq, ThreadDescriptor* td, bool initial);
+
+    // Associacao thread <-> runqueue
+    CpuRunqueue* runqueue_of(const ThreadDescriptor* td) { return &m_runqueues[td->cpu]; }
+    CpuRunqueue* lock_thread_runqueue(ThreadDescriptor* td);
+    void activate_thread(CpuRunqueue* rq, ThreadDescriptor* td);
+    void deactivate_thread(CpuRunqueue* rq, ThreadDescriptor* td);
+    void detach_thread(CpuRunqueue* src, ThreadDescriptor* td);
+    void attach_thread(CpuRunqueue* dst, ThreadDescriptor* td);
+    void push_thread(ThreadDescriptor* td, int dst_cpu);
+    int select_cpu_for_thread(const ThreadDescriptor* td, int this_cpu) const;
+
+    // Bloqueio e despertar
+    bool try_wake_up(ThreadDescriptor* td, bool timer_fired);
+    void activate_woken_thread(CpuRunqueue* rq, ThreadDescriptor* td, uint64_t now_ns,
+                               int* push_cpu, uint64_t* dl_throttle_delay_ns);
+    void finish_wakeup(ThreadDescriptor* td, int push_cpu, uint64_t dl_throttle_delay_ns);
+    void queue_remote_wakeup(ThreadDescriptor* td);
+    void drain_wake_list(CpuRunqueue* rq);
+    static void sleep_timer_expired(void* context, uint32_t overruns);
+    static bool timer_softirq_pending(void* context);
+    
+    // Balanceamento de carga entre CPUs
+    CpuRunqueue* find_busiest_runqueue(const CpuRunqueue* this_rq);
+    void double_lock_balance(CpuRunqueue* this_rq, CpuRunqueue* busiest);
+    ThreadDescriptor* find_migratable_thread(CpuRunqueue* src, int dst_cpu);
+    int pull_threads(CpuRunqueue* this_rq, CpuRunqueue* busiest, int max_threads);
+    bool steal_work(CpuRunqueue* this_rq);
+    void load_balance(CpuRunqueue* this_rq, uint64_t now_ns);
+    void nohz_balance_kick(CpuRunqueue* this_rq);
+
+    // Tick dinamico (NO_HZ)
+    void update_tick(CpuRunqueue* rq, uint64_t now_ns);
+    void kick_cpu(CpuRunqueue* rq);
+    int find_timer_target(const CpuRunqueue* rq) const;
+
+    // Utilizacao PELT (o chamador segura rq->lock)
+    void update_load_avg(CpuRunqueue* rq, uint64_t now_ns);
+    void attach_load(CpuRunqueue* rq, ThreadDescriptor* td);
+    void detach_load(CpuRunqueue* rq, ThreadDescriptor* td);
+    void publish_util(CpuRunqueue* rq);
+
+    // Controle de banda (o chamador segura rq->lock)
+    void update_rt_bandwidth(CpuRunqueue* rq, uint64_t ran_ns, uint64_t now_ns);
+    void update_bg_bandwidth(CpuRunqueue* rq, uint64_t ran_ns, uint64_t now_ns);
     
 public:
     ComandroScheduler();
+    explicit ComandroScheduler(int nr_cpus);
+
+    static ComandroScheduler& instance();
     
     /**
-     * @brief Chamado pelo timer interrupt para agendar a proxima thread.
+     * @brief Chamado pelo timer interrupt para agendar a proxima thread na CPU atual.
      */
     void schedule();
 
     /**
-     * @brief Adiciona uma nova thread ao scheduler.
+     * @brief Adiciona uma nova thread ao scheduler, na CPU permitida menos carregada.
+     * * td->cpus_allowed ja preenchida e respeitada desde o primeiro posicionamento
+     *   (0, como sai de ThreadDescriptorCache::alloc(), = todas as CPUs).
+     * * Com td->dl.runtime_ns != 0 a thread entra na classe Deadline, se houver banda
+     *   livre em alguma CPU (controle de admissao); ela fica nessa CPU.
+     * * A thread entra na tabela de TIDs (set_thread_affinity por TID).
+     * @return false se os parametros DL sao invalidos, a banda nao cabe ou a mascara
+     *         nao contem nenhuma CPU valida.
+     */
+    bool add_thread(ThreadDescriptor* td);
+
+    /**
+     * @brief Tira a thread da tabela de TIDs. Chamado na saida da thread, antes de
+     * ThreadDescriptorCache::free(): um TID antigo nao pode achar o descritor reutilizado.
      */
-    void add_thread(ThreadDescriptor* td);
+    void unhash_thread(ThreadDescriptor* td);
 
     /**
      * @brief Define a prioridade de uma thread, movendo-a entre filas se necessario.
      */
     void set_thread_priority(ThreadDescriptor* td, Priority new_priority);
+
+    /**
+     * @brief Altera os parametros Deadline de uma thread ja adicionada (runtime 0 = sai da classe).
+     * * A nova banda precisa caber na CPU atual da thread.
+     * @return false se os parametros sao invalidos ou a banda nao cabe.
+     */
+    bool set_thread_deadline(ThreadDescriptor* td, const DeadlineParams& params);
+
+    /**
+     * @brief Restringe as CPUs de uma thread (mascara aplicada pelo CpuMaskManager do Binder).
+     * * Se a CPU atual nao estiver na mascara, a thread e migrada.
+     * @return false se a mascara nao contem nenhuma CPU valida, ou se exclui a CPU
+     *         onde uma thread Deadline tem banda reservada.
+     */
+    bool set_thread_affinity(ThreadDescriptor* td, CpuAffinityMask mask);
+
+    /**
+     * @brief set_thread_affinity pela TID (caminho do CpuMaskManager::setThreadAffinity do Binder).
+     * @return false se a TID nao esta no scheduler ou a mascara e recusada.
+     */
+    bool set_thread_affinity(uint32_t tid, CpuAffinityMask mask);
     
     /**
-     * @brief O kernel cede o restante do seu quantum.
+     * @brief A thread atual cede o restante do seu quantum.
      */
     void yield();
 
-    // Funcoes publicas para uso externo (simulacao)
-    static void sleep(std::chrono::milliseconds duration);
+    /**
+     * @brief Entrega o restante do quantum da thread atual direto a target, sem um pick completo.
+     * * target precisa estar pronta na fila desta CPU, sem thread de classe mais alta esperando
+     *   (a doacao nao fura RT/DL; isso inclui a propria thread atual, se continua pronta).
+     *   A thread atual volta a fila, ou sai do runqueue se ja bloqueou/dormiu.
+     * * Usado pelo IPC sincrono: o cliente que espera a resposta passa a CPU ao servidor.
+     * @return false se a troca direta nao e possivel (o chamador segue com schedule()).
+     */
+    bool yield_to(ThreadDescriptor* target);
+
+    /**
+     * @brief Thread em execucao na CPU (nullptr se ociosa). Usado por ferramentas de diagnostico.
+     */
+    ThreadDescriptor* get_current_thread(int cpu);
+
+    int get_cpu_count() const { return m_nr_cpus; }
+
+    /**
+     * @brief Instante (ns) em que o timer local da CPU deve chamar schedule() de novo.
+     * * Lido pelo codigo de arquitetura ao reprogramar o timer apos schedule(). Os timers
+     *   do KernelTimer sao programados a parte (KernelTimer, ClockEventDevice).
+     * * 0 = imediato (trabalho novo); UINT64_MAX = tick parado, a CPU so acorda por IPI.
+     */
+    uint64_t get_next_tick_ns(int cpu) const;
+
+    TickMode get_tick_mode(int cpu);
+
+    /**
+     * @brief Utilizacao PELT da CPU (escala SCHED_CAPACITY_SCALE, ate a capacidade do nucleo).
+     * * Leitura sem lock para o power governor: a demanda real das threads da CPU,
+     *   inclusive as que estao dormindo (decaindo), e nao uma amostra de carga.
+     * * Uma CPU ociosa com o tick parado tem o valor decaido ate agora na leitura.
+     */
+    uint32_t get_cpu_util(int cpu) const;
+
+    /**
+     * @brief Liga/desliga o NO_HZ (desligado, toda CPU volta ao tick periodico).
+     */
+    void set_nohz_enabled(bool enabled);
+
+    /**
+     * @brief Resumo da latencia wakeup -> execucao de um nivel (LATENCY_LEVEL_PRIORITY).
+     * * cpu = -1 agrega todas as CPUs. Leitura sem lock: os contadores sao atomicos.
+     * @return false se o nivel ou a CPU nao existem.
+     */
+    bool get_wakeup_latency(int level, int cpu, SchedLatencySummary* out) const;
+
+    /**
+     * @brief Orcamento RT de cada CPU: ate runtime_ns de RT a cada period_ns.
+     * * Esgotado o orcamento, as threads RT so rodam se nenhuma outra estiver esperando.
+     * * runtime_ns >= period_ns desliga o limite.
+     * @return false se period_ns e zero.
+     */
+    bool set_rt_bandwidth(uint64_t runtime_ns, uint64_t period_ns);
+
+    /**
+     * @brief Cota do grupo CRAN_BACKGROUND: ate quota_ns de CPU (somando todas as CPUs)
+     * a cada period_ns. quota_ns = 0 desliga o limite.
+     * @return false se period_ns e zero.
+     */
+    bool set_background_bandwidth(uint64_t quota_ns, uint64_t period_ns);
+
+    /**
+     * @brief Contadores de throttle RT e background. cpu = -1 agrega todas as CPUs.
+     * @return false se a CPU nao existe.
+     */
+    bool get_throttle_stats(int cpu, SchedThrottleStats* out) const;
+
+    /**
+     * @brief Bloqueia a thread atual na fila de espera ate um wake_up_one/wake_up_all.
+     */
+    void block_on(WaitQueue* wq);
+
+    /**
+     * @brief Bloqueia a thread atual ate um wake_up_thread(), a menos que condition(context) ja valha.
+     * * condition e testada depois de a thread se marcar BLOCKED: quem a torna verdadeira
+     *   e depois chama wake_up_thread() nunca perde o wakeup.
+     * * condition roda com o lock do runqueue (interrupcoes desligadas): so leituras
+     *   atomicas, sem bloquear nem travar locks do scheduler.
+     * * handoff: thread pronta nesta CPU que recebe a CPU direto (yield_to); nullptr ou
+     *   troca direta impossivel = schedule().
+     * @return false se a condicao ja valia (a thread nao bloqueou).
+     */
+    bool block_until(bool (*condition)(void* context), void* context, ThreadDescriptor* handoff);
+
+    /**
+     * @brief Acorda a thread mais antiga da fila. @return false se a fila estava vazia.
+     */
+    bool wake_up_one(WaitQueue* wq);
+
+    /**
+     * @brief Acorda todas as threads da fila. @return Numero de threads acordadas.
+     */
+    int wake_up_all(WaitQueue* wq);
+
+    /**
+     * @brief Torna uma thread BLOCKED pronta novamente.
+     * * Uma thread em sleep_current() nao e afetada: so o timer dela a acorda.
+     * @return false se a thread nao estava BLOCKED.
+     */
+    bool wake_up_thread(ThreadDescriptor* td);
+
+    /**
+     * @brief Tira a thread atual da CPU ate o timer one-shot expirar.
+     * * slack: atraso tolerado no despertar (ver KernelTimer::setTimer).
+     */
+    void sleep_current(std::chrono::nanoseconds duration, std::chrono::nanoseconds slack = std::chrono::nanoseconds(0));
+
+    /**
+     * @brief Sleep da thread atual no scheduler global (para servicos do kernel).
+     * * Substitui std::this_thread::sleep_for: a thread sai do runqueue e nao consome ticks.
+     * * Loops de polling nao criticos passam uma folga: o despertar e agrupado com outros timers.
+     */
+    static void sleep(std::chrono::milliseconds duration, std::chrono::milliseconds slack = std::chrono::milliseconds(0));
+
+    /**
+     * @brief Dorme ate o proximo instante da grade de um loop periodico (sleep absoluto).
+     * * Acordou atrasado (stall, thread preemptada): os periodos perdidos sao pulados e
+     *   contados, nao executados em rajada; o proximo despertar segue na mesma fase.
+     * @return Periodos perdidos alem do que acabou de vencer (0 = em dia).
+     */
+    uint32_t sleep_periodic(PeriodicClock* clock, std::chrono::nanoseconds slack = std::chrono::nanoseconds(0));
+
+    /**
+     * @brief Laco da thread softirq de timers da CPU atual.
+     * * Roda os callbacks que o IRQ enfileirou (KernelTimer::runSoftirq) e bloqueia ate o
+     *   proximo raise_timer_softirq(). Nunca retorna depois de entrar no laco.
+     * * O boot de cada CPU (fora deste modulo) cria uma thread por CPU com
+     *   cpus_allowed = cpu_bit(cpu), faz add_thread e a usa como entrada deste laco.
+     *   Sem essa thread os timers da CPU nunca disparam.
+     * * Chamado fora de uma thread do scheduler: loga erro critico e retorna.
+     */
+    void timer_softirq_loop();
+
+    /**
+     * @brief Acorda a thread softirq de timers de uma CPU (implementa Scheduler::raiseTimerSoftirq).
+     * * Chamado do IRQ do timer: nao aloca. Antes de a thread existir, os callbacks esperam na fila.
+     */
+    void raise_timer_softirq(int cpu);
 };
 
 } // namespace scheduler
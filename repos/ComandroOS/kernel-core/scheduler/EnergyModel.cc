@@ -0,0 +1,191 @@
+#include "EnergyModel.h"
+#include <comandro/kernel/log.h>
+#include <comandro/kernel/cpu_topology.h> // Para cpu::get_topology_info()
+#include <comandro/kernel/binder/server/atomic_info.h> // CpuAtomicCache (carga/frequencia lock-free)
+#include <string>
+
+namespace comandro {
+namespace kernel {
+namespace scheduler {
+
+static constexpr const char* TAG = "EnergyModel";
+
+// Margem de capacidade (1.25x): uma CPU "cabe" ate 80% de utilizacao, e o
+// governor sobe de OPP antes de saturar
+static constexpr uint32_t CAPACITY_MARGIN = 1280; // / 1024
+
+// Migrar para outra CPU so compensa se economizar mais de 1/16 (~6%) da energia na CPU anterior
+static constexpr int ENERGY_SAVING_SHIFT = 4;
+
+// =====================================================================
+// Tabelas de OPP (potencia medida com um nucleo 100% ocupado)
+// =====================================================================
+
+static constexpr EnergyOpp LITTLE_OPPS[] = {
+    { 300,   15}, { 576,   32}, { 768,   48}, {1017,   70},
+    {1248,   98}, {1497,  135}, {1708,  180}, {1804,  205},
+};
+
+static constexpr EnergyOpp BIG_OPPS[] = {
+    { 700,  180}, {1100,  320}, {1500,  500}, {1900,  740},
+    {2200,  980}, {2500, 1300}, {2800, 1750},
+};
+
+static constexpr EnergyCluster LITTLE_CLUSTER = {
+    "LITTLE", 400, LITTLE_OPPS, sizeof(LITTLE_OPPS) / sizeof(LITTLE_OPPS[0]),
+};
+
+static constexpr EnergyCluster BIG_CLUSTER = {
+    "big", SCHED_CAPACITY_SCALE, BIG_OPPS, sizeof(BIG_OPPS) / sizeof(BIG_OPPS[0]),
+};
+
+static inline uint32_t max_frequency_mhz(const EnergyCluster* cluster) {
+    return cluster->opps[cluster->nr_opps - 1].frequency_mhz;
+}
+
+// Capacidade do cluster numa frequencia (proporcional a frequencia maxima)
+static inline uint32_t capacity_at(const EnergyCluster* cluster, uint32_t frequency_mhz) {
+    uint32_t max_frequency = max_frequency_mhz(cluster);
+    if (frequency_mhz == 0 || frequency_mhz > max_frequency) {
+        frequency_mhz = max_frequency;
+    }
+    return static_cast<uint32_t>(static_cast<uint64_t>(cluster->max_capacity) * frequency_mhz / max_frequency);
+}
+
+static inline bool fits_capacity(uint32_t util, uint32_t capacity) {
+    return static_cast<uint64_t>(util) * CAPACITY_MARGIN < static_cast<uint64_t>(capacity) * 1024;
+}
+
+EnergyModel& EnergyModel::instance() {
+    static EnergyModel s_instance;
+    return s_instance;
+}
+
+EnergyModel::EnergyModel() {
+    const cpu::TopologyInfo& topology = cpu::get_topology_info();
+
+    m_nr_cpus = topology.total_core_count;
+    if (m_nr_cpus < 1) {
+        m_nr_cpus = 1;
+    } else if (m_nr_cpus > ENERGY_MAX_CPUS) {
+        m_nr_cpus = ENERGY_MAX_CPUS;
+    }
+
+    // Nucleos simetricos: todos valem a capacidade de referencia
+    m_enabled = topology.has_big_cores && topology.has_little_cores;
+    for (int cpu = 0; cpu < ENERGY_MAX_CPUS; ++cpu) {
+        bool little = m_enabled && topology.is_little_core(cpu);
+        m_cpu_cluster[cpu] = little ? &LITTLE_CLUSTER : &BIG_CLUSTER;
+    }
+
+    Log::info(TAG, std::string("Modelo de energia ") + (m_enabled ? "habilitado (big.LITTLE)." : "desabilitado (nucleos simetricos)."));
+}
+
+const EnergyCluster* EnergyModel::cluster_of(int cpu) const {
+    if (cpu < 0 || cpu >= m_nr_cpus) {
+        return nullptr;
+    }
+    return m_cpu_cluster[cpu];
+}
+
+uint32_t EnergyModel::cpu_capacity(int cpu) const {
+    const EnergyCluster* cluster = cluster_of(cpu);
+    return cluster ? cluster->max_capacity : 0;
+}
+
+uint32_t EnergyModel::cpu_current_capacity(int cpu) const {
+    const EnergyCluster* cluster = cluster_of(cpu);
+    if (cluster == nullptr) {
+        return 0;
+    }
+    // Cache ainda nao preenchida (frequencia 0): capacity_at assume a frequencia maxima
+    return capacity_at(cluster, binder::atomic_read_core_frequency(cpu));
+}
+
+uint32_t EnergyModel::cpu_utilization(int cpu) const {
+    uint32_t load = binder::atomic_read_core_load(cpu);
+    if (load > 100) {
+        load = 100;
+    }
+    return cpu_current_capacity(cpu) * load / 100;
+}
+
+const EnergyOpp* EnergyModel::find_opp(const EnergyCluster* cluster, uint32_t max_util) const {
+    for (int i = 0; i < cluster->nr_opps; ++i) {
+        if (fits_capacity(max_util, capacity_at(cluster, cluster->opps[i].frequency_mhz))) {
+            return &cluster->opps[i];
+        }
+    }
+    return &cluster->opps[cluster->nr_opps - 1]; // Saturado: frequencia maxima
+}
+
+/**
+ * @brief Energia estimada do cluster (potencia media, mW) com add_util a mais em add_cpu.
+ * * O governor escolhe o menor OPP que comporta a CPU mais ocupada do cluster (com
+ *   margem); cada CPU gasta a potencia desse OPP na fracao do tempo em que esta ocupada.
+ */
+uint64_t EnergyModel::estimate_cluster_energy(const EnergyCluster* cluster, const uint32_t* util,
+                                              int add_cpu, uint32_t add_util) const {
+    uint32_t max_util = 0;
+    uint64_t sum_util = 0;
+    for (int cpu = 0; cpu < m_nr_cpus; ++cpu) {
+        if (m_cpu_cluster[cpu] != cluster) {
+            continue;
+        }
+        uint32_t cpu_util = util[cpu] + (cpu == add_cpu ? add_util : 0);
+        sum_util += cpu_util;
+        if (cpu_util > max_util) {
+            max_util = cpu_util;
+        }
+    }
+
+    const EnergyOpp* opp = find_opp(cluster, max_util);
+    return opp->power_mw * sum_util / capacity_at(cluster, opp->frequency_mhz);
+}
+
+int EnergyModel::find_energy_efficient_cpu(uint32_t task_util, uint64_t allowed, int prev_cpu) const {
+    if (!m_enabled) {
+        return -1;
+    }
+
+    // Uma CPU acima de 80%: o sistema esta sobrecarregado e quem decide e o balanceamento por carga
+    uint32_t util[ENERGY_MAX_CPUS];
+    for (int cpu = 0; cpu < m_nr_cpus; ++cpu) {
+        util[cpu] = cpu_utilization(cpu);
+        if (!fits_capacity(util[cpu], cpu_capacity(cpu))) {
+            return -1;
+        }
+    }
+
+    int best_cpu = -1;
+    uint64_t best_delta = UINT64_MAX;
+    uint64_t prev_delta = UINT64_MAX;
+    for (int cpu = 0; cpu < m_nr_cpus; ++cpu) {
+        if (!(allowed & (1ULL << cpu)) || !fits_capacity(util[cpu] + task_util, cpu_capacity(cpu))) {
+            continue;
+        }
+
+        // So o cluster da CPU candidata muda de energia
+        const EnergyCluster* cluster = m_cpu_cluster[cpu];
+        uint64_t with_task = estimate_cluster_energy(cluster, util, cpu, task_util);
+        uint64_t without_task = estimate_cluster_energy(cluster, util, -1, 0);
+        uint64_t delta = (with_task > without_task) ? with_task - without_task : 0;
+        if (cpu == prev_cpu) {
+            prev_delta = delta;
+        }
+        if (delta < best_delta || (delta == best_delta && cpu == prev_cpu)) {
+            best_cpu = cpu;
+            best_delta = delta;
+        }
+    }
+
+    if (best_cpu >= 0 && prev_delta != UINT64_MAX && best_cpu != prev_cpu &&
+        prev_delta - best_delta <= (prev_delta >> ENERGY_SAVING_SHIFT)) {
+        return prev_cpu; // Economia pequena: fica com o cache quente
+    }
+    return best_cpu;
+}
+
+} // namespace scheduler
+} // namespace kernel
+} // namespace comandro
@@ -0,0 +1,97 @@
+#ifndef COMANDRO_KERNEL_SCHEDULER_ENERGY_MODEL_H
+#define COMANDRO_KERNEL_SCHEDULER_ENERGY_MODEL_H
+
+#include <stdint.h>
+
+namespace comandro {
+namespace kernel {
+namespace scheduler {
+
+// Capacidade de referencia: o nucleo mais rapido na frequencia maxima
+static constexpr uint32_t SCHED_CAPACITY_SCALE = 1024;
+
+// Numero maximo de CPUs consideradas pelo modelo (mesmo limite do scheduler)
+static constexpr int ENERGY_MAX_CPUS = 64;
+
+/**
+ * @brief Ponto de operacao (OPP) de um cluster: frequencia e potencia com um nucleo 100% ocupado.
+ */
+struct EnergyOpp {
+    uint32_t frequency_mhz;
+    uint32_t power_mw;
+};
+
+/**
+ * @brief Cluster de nucleos identicos que compartilham o mesmo clock (LITTLE ou big).
+ * * opps em ordem crescente de frequencia; max_capacity vale no ultimo OPP.
+ */
+struct EnergyCluster {
+    const char* name;
+    uint32_t max_capacity;
+    const EnergyOpp* opps;
+    int nr_opps;
+};
+
+/**
+ * @brief Modelo de energia por cluster (capacidade e potencia por frequencia).
+ * * A carga e a frequencia atuais de cada nucleo vem da CpuAtomicCache do Binder
+ *   (atomic_read_core_load/atomic_read_core_frequency): leitura lock-free, sem
+ *   consultar o hardware no caminho de wakeup.
+ * * So fica habilitado em topologias assimetricas (big.LITTLE): com nucleos
+ *   identicos todas as CPUs custam o mesmo.
+ */
+class EnergyModel {
+public:
+    static EnergyModel& instance();
+
+    bool is_enabled() const { return m_enabled; }
+
+    const EnergyCluster* cluster_of(int cpu) const;
+
+    /**
+     * @brief Capacidade do nucleo na frequencia maxima (escala SCHED_CAPACITY_SCALE).
+     */
+    uint32_t cpu_capacity(int cpu) const;
+
+    /**
+     * @brief Capacidade do nucleo na frequencia atual (CpuAtomicCache); base da utilizacao PELT.
+     */
+    uint32_t cpu_current_capacity(int cpu) const;
+
+    /**
+     * @brief Utilizacao atual do nucleo (carga x capacidade na frequencia atual), pela CpuAtomicCache.
+     */
+    uint32_t cpu_utilization(int cpu) const;
+
+    /**
+     * @brief OPP que o governor escolheria para o cluster: o menor que comporta max_util (com margem).
+     */
+    const EnergyOpp* find_opp(const EnergyCluster* cluster, uint32_t max_util) const;
+
+    /**
+     * @brief Colocacao energy-aware: a CPU permitida onde a thread custa menos energia
+     * e ainda cabe (utilizacao com margem abaixo da capacidade).
+     * @param task_util Utilizacao estimada da thread (escala SCHED_CAPACITY_SCALE).
+     * @param allowed Mascara de CPUs permitidas (codificacao CpuAffinityMask).
+     * @param prev_cpu CPU anterior (preferida se a economia for pequena); -1 = nenhuma.
+     * @return CPU escolhida, ou -1 se o modelo esta desabilitado, o sistema esta
+     *         sobrecarregado ou a thread nao cabe em nenhuma CPU.
+     */
+    int find_energy_efficient_cpu(uint32_t task_util, uint64_t allowed, int prev_cpu) const;
+
+private:
+    EnergyModel();
+
+    uint64_t estimate_cluster_energy(const EnergyCluster* cluster, const uint32_t* util,
+                                     int add_cpu, uint32_t add_util) const;
+
+    int m_nr_cpus;
+    bool m_enabled;
+    const EnergyCluster* m_cpu_cluster[ENERGY_MAX_CPUS];
+};
+
+} // namespace scheduler
+} // namespace kernel
+} // namespace comandro
+
+#endif // COMANDRO_KERNEL_SCHEDULER_ENERGY_MODEL_H
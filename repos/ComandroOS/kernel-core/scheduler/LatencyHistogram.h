@@ -0,0 +1,154 @@
+#ifndef COMANDRO_KERNEL_SCHEDULER_LATENCY_HISTOGRAM_H
+#define COMANDRO_KERNEL_SCHEDULER_LATENCY_HISTOGRAM_H
+
+#include <stdint.h>
+#include <atomic>
+
+namespace comandro {
+namespace kernel {
+namespace scheduler {
+
+// Sub-buckets lineares por oitava (2^3 = 8: erro relativo de no maximo 12.5%)
+static constexpr int LATENCY_SUB_BUCKET_BITS = 3;
+static constexpr int LATENCY_SUB_BUCKETS = 1 << LATENCY_SUB_BUCKET_BITS;
+// Maior oitava com resolucao propria: 2^30 ns (~1 s). Valores acima caem no ultimo bucket.
+static constexpr int LATENCY_MAX_EXPONENT = 30;
+static constexpr int LATENCY_BUCKETS = (LATENCY_MAX_EXPONENT - LATENCY_SUB_BUCKET_BITS + 2) * LATENCY_SUB_BUCKETS;
+
+// Niveis de prioridade medidos (os valores do enum Priority); prioridades
+// intermediarias contam no nivel imediatamente abaixo.
+static constexpr int LATENCY_PRIORITY_LEVELS = 7;
+static constexpr int LATENCY_LEVEL_PRIORITY[LATENCY_PRIORITY_LEVELS] = {99, 90, 85, 70, 50, 20, 1};
+static constexpr const char* LATENCY_LEVEL_NAMES[LATENCY_PRIORITY_LEVELS] = {
+    "RT_EMERGENCY", "RT_AUDIO_STREAM", "RT_DISPLAY_VSYNC", "UI_INTERACTIVE",
+    "CRAN_NORMAL", "CRAN_BACKGROUND", "VERY_LOW",
+};
+
+static inline int latency_level_of(int priority) {
+    for (int level = 0; level < LATENCY_PRIORITY_LEVELS - 1; ++level) {
+        if (priority >= LATENCY_LEVEL_PRIORITY[level]) {
+            return level;
+        }
+    }
+    return LATENCY_PRIORITY_LEVELS - 1;
+}
+
+/**
+ * @brief Bucket log-linear de um valor em ns: exato abaixo de 8 ns, depois 8 buckets por potencia de 2.
+ */
+static inline int latency_bucket_of(uint64_t value_ns) {
+    if (value_ns < static_cast<uint64_t>(LATENCY_SUB_BUCKETS)) {
+        return static_cast<int>(value_ns);
+    }
+    int exponent = 63 - __builtin_clzll(value_ns);
+    if (exponent > LATENCY_MAX_EXPONENT) {
+        return LATENCY_BUCKETS - 1;
+    }
+    int sub = static_cast<int>((value_ns >> (exponent - LATENCY_SUB_BUCKET_BITS)) & (LATENCY_SUB_BUCKETS - 1));
+    return (exponent - LATENCY_SUB_BUCKET_BITS + 1) * LATENCY_SUB_BUCKETS + sub;
+}
+
+/**
+ * @brief Maior valor (ns) contado no bucket: percentis sao reportados pelo limite superior.
+ */
+static inline uint64_t latency_bucket_upper_ns(int bucket) {
+    if (bucket < LATENCY_SUB_BUCKETS) {
+        return static_cast<uint64_t>(bucket);
+    }
+    int exponent = bucket / LATENCY_SUB_BUCKETS + LATENCY_SUB_BUCKET_BITS - 1;
+    uint64_t sub = static_cast<uint64_t>(bucket % LATENCY_SUB_BUCKETS);
+    int shift = exponent - LATENCY_SUB_BUCKET_BITS;
+    return ((LATENCY_SUB_BUCKETS + sub + 1) << shift) - 1;
+}
+
+/**
+ * @brief Histograma log-linear de latencias com contadores atomicos.
+ * * record() e lock-free (fetch_add relaxed): o escritor e a propria CPU e os
+ *   leitores (Nucleum, dexter) nunca bloqueiam o caminho de agendamento.
+ */
+struct LatencyHistogram {
+    std::atomic<uint64_t> buckets[LATENCY_BUCKETS] = {};
+    std::atomic<uint64_t> count{0};
+    std::atomic<uint64_t> sum_ns{0};
+    std::atomic<uint64_t> max_ns{0};
+
+    void record(uint64_t value_ns) {
+        buckets[latency_bucket_of(value_ns)].fetch_add(1, std::memory_order_relaxed);
+        count.fetch_add(1, std::memory_order_relaxed);
+        sum_ns.fetch_add(value_ns, std::memory_order_relaxed);
+
+        uint64_t max = max_ns.load(std::memory_order_relaxed);
+        while (value_ns > max && !max_ns.compare_exchange_weak(max, value_ns, std::memory_order_relaxed)) {
+        }
+    }
+};
+
+/**
+ * @brief Copia (nao atomica como um todo) de um ou mais histogramas, para calcular percentis.
+ */
+struct LatencySnapshot {
+    uint64_t buckets[LATENCY_BUCKETS] = {};
+    uint64_t count = 0;
+    uint64_t sum_ns = 0;
+    uint64_t max_ns = 0;
+
+    void add(const LatencyHistogram& histogram) {
+        for (int i = 0; i < LATENCY_BUCKETS; ++i) {
+            uint64_t samples = histogram.buckets[i].load(std::memory_order_relaxed);
+            buckets[i] += samples;
+            count += samples;
+        }
+        sum_ns += histogram.sum_ns.load(std::memory_order_relaxed);
+        uint64_t max = histogram.max_ns.load(std::memory_order_relaxed);
+        if (max > max_ns) {
+            max_ns = max;
+        }
+    }
+
+    /**
+     * @brief Percentil (0.0 - 1.0) em ns; limite superior do bucket, nunca acima do maximo visto.
+     */
+    uint64_t percentile(double fraction) const {
+        if (count == 0) {
+            return 0;
+        }
+        uint64_t target = static_cast<uint64_t>(fraction * count);
+        if (target < 1) {
+            target = 1;
+        } else if (target > count) {
+            target = count;
+        }
+
+        uint64_t seen = 0;
+        for (int i = 0; i < LATENCY_BUCKETS; ++i) {
+            seen += buckets[i];
+            if (seen >= target) {
+                uint64_t upper = latency_bucket_upper_ns(i);
+                return upper < max_ns ? upper : max_ns;
+            }
+        }
+        return max_ns;
+    }
+
+    uint64_t mean_ns() const { return count ? sum_ns / count : 0; }
+};
+
+/**
+ * @brief Resumo exportado (Nucleum, dexter via native_get_sched_latency).
+ */
+struct SchedLatencySummary {
+    int priority;
+    uint64_t samples;
+    uint64_t mean_ns;
+    uint64_t p50_ns;
+    uint64_t p90_ns;
+    uint64_t p99_ns;
+    uint64_t p999_ns;
+    uint64_t max_ns;
+};
+
+} // namespace scheduler
+} // namespace kernel
+} // namespace comandro
+
+#endif // COMANDRO_KERNEL_SCHEDULER_LATENCY_HISTOGRAM_H
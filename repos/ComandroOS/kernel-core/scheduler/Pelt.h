@@ -0,0 +1,129 @@
+#ifndef COMANDRO_KERNEL_SCHEDULER_PELT_H
+#define COMANDRO_KERNEL_SCHEDULER_PELT_H
+
+#include "EnergyModel.h" // SCHED_CAPACITY_SCALE
+#include <stdint.h>
+
+namespace comandro {
+namespace kernel {
+namespace scheduler {
+
+// =====================================================================
+// PELT - Utilizacao com decaimento geometrico (Per-Entity Load Tracking)
+// O tempo e contado em "us" de 1024 ns (ns >> 10) e agrupado em periodos
+// de 1024 us (~1ms). A contribuicao de cada periodo decai por y a cada
+// periodo seguinte, com y^32 = 1/2: o sinal esquece metade em ~32ms.
+// =====================================================================
+
+static constexpr uint32_t PELT_PERIOD_US = 1024;
+static constexpr uint32_t PELT_HALFLIFE_PERIODS = 32;
+// Soma maxima da serie 1024 * (1 + y + y^2 + ...) com a aritmetica inteira abaixo
+static constexpr uint32_t PELT_LOAD_AVG_MAX = 47742;
+
+// y^n em ponto fixo de 32 bits, n = 0..31
+static constexpr uint32_t PELT_YN_INV[PELT_HALFLIFE_PERIODS] = {
+    0xffffffff, 0xfa83b2da, 0xf5257d14, 0xefe4b99a, 0xeac0c6e6, 0xe5b906e6, 0xe0ccdeeb, 0xdbfbb796,
+    0xd744fcc9, 0xd2a81d91, 0xce248c14, 0xc9b9bd85, 0xc5672a10, 0xc12c4cc9, 0xbd08a39e, 0xb8fbaf46,
+    0xb504f333, 0xb123f581, 0xad583ee9, 0xa9a15ab4, 0xa5fed6a9, 0xa2704302, 0x9ef5325f, 0x9b8d39b9,
+    0x9837f050, 0x94f4efa8, 0x91c3d373, 0x8ea4398a, 0x8b95c1e3, 0x88980e80, 0x85aac367, 0x82cd8698,
+};
+
+/**
+ * @brief Media de utilizacao de uma thread ou de um runqueue.
+ * * util_avg: fracao recente do tempo em execucao, escalada pela capacidade da CPU
+ *   (0..SCHED_CAPACITY_SCALE). Protegida pelo lock do runqueue correspondente.
+ */
+struct SchedAvg {
+    uint64_t last_update_us;        // Ultima atualizacao (ns >> 10)
+    uint64_t util_sum;              // Soma decaida de (tempo em execucao x capacidade)
+    uint32_t period_contrib;        // Parte do periodo atual ja contada (us)
+    uint32_t util_avg;
+};
+
+/**
+ * @brief value * y^periods.
+ */
+static inline uint64_t pelt_decay(uint64_t value, uint64_t periods) {
+    if (periods > PELT_HALFLIFE_PERIODS * 63ULL) {
+        return 0;
+    }
+    value >>= periods / PELT_HALFLIFE_PERIODS;
+    return (value * PELT_YN_INV[periods % PELT_HALFLIFE_PERIODS]) >> 32;
+}
+
+// Divisor que transforma util_sum em util_avg (a serie ainda incompleta no periodo atual)
+static inline uint32_t pelt_divider(const SchedAvg* sa) {
+    return PELT_LOAD_AVG_MAX - PELT_PERIOD_US + sa->period_contrib;
+}
+
+/**
+ * @brief Comeca a media em util (thread nova: estimativa inicial antes de rodar).
+ */
+static inline void pelt_init(SchedAvg* sa, uint64_t now_ns, uint32_t util) {
+    sa->last_update_us = now_ns >> 10;
+    sa->period_contrib = 0;
+    sa->util_avg = util;
+    sa->util_sum = static_cast<uint64_t>(util) * pelt_divider(sa);
+}
+
+/**
+ * @brief Avanca a media ate now_ns; running = a entidade rodou desde a ultima atualizacao.
+ * * capacity: capacidade atual da CPU (frequencia e tipo de nucleo), para que 1ms num
+ *   LITTLE lento conte menos que 1ms num big na frequencia maxima.
+ * * util_avg so e recalculado ao virar um periodo (o valor muda no maximo a cada ~1ms).
+ */
+static inline void pelt_update(SchedAvg* sa, uint64_t now_ns, bool running, uint32_t capacity) {
+    uint64_t now_us = now_ns >> 10;
+    if (now_us <= sa->last_update_us) {
+        return;
+    }
+    uint64_t delta = now_us - sa->last_update_us;
+    sa->last_update_us = now_us;
+
+    uint64_t contrib = delta; // Sem virar periodo: tudo no periodo atual, sem decaimento
+    delta += sa->period_contrib;
+    uint64_t periods = delta / PELT_PERIOD_US;
+    if (periods != 0) {
+        sa->util_sum = pelt_decay(sa->util_sum, periods);
+        delta %= PELT_PERIOD_US;
+        if (running) {
+            // Resto do periodo antigo (decaido) + periodos inteiros + inicio do periodo atual
+            contrib = pelt_decay(PELT_PERIOD_US - sa->period_contrib, periods) +
+                      PELT_LOAD_AVG_MAX - pelt_decay(PELT_LOAD_AVG_MAX, periods) - PELT_PERIOD_US + delta;
+        }
+    }
+    sa->period_contrib = static_cast<uint32_t>(delta);
+    if (running) {
+        sa->util_sum += contrib * capacity;
+    }
+    if (periods != 0) {
+        sa->util_avg = static_cast<uint32_t>(sa->util_sum / pelt_divider(sa));
+    }
+}
+
+/**
+ * @brief Soma a utilizacao de uma thread a do runqueue (a carga chega com a thread migrada).
+ */
+static inline void pelt_attach(SchedAvg* rq_avg, const SchedAvg* sa) {
+    rq_avg->util_avg += sa->util_avg;
+    rq_avg->util_sum += sa->util_sum;
+}
+
+/**
+ * @brief Retira a utilizacao de uma thread do runqueue (migracao).
+ */
+static inline void pelt_detach(SchedAvg* rq_avg, const SchedAvg* sa) {
+    rq_avg->util_avg = (rq_avg->util_avg > sa->util_avg) ? rq_avg->util_avg - sa->util_avg : 0;
+    rq_avg->util_sum = (rq_avg->util_sum > sa->util_sum) ? rq_avg->util_sum - sa->util_sum : 0;
+    // Arredondamentos nao podem deixar a soma abaixo do que util_avg implica
+    uint64_t min_sum = static_cast<uint64_t>(rq_avg->util_avg) * (PELT_LOAD_AVG_MAX - PELT_PERIOD_US);
+    if (rq_avg->util_sum < min_sum) {
+        rq_avg->util_sum = min_sum;
+    }
+}
+
+} // namespace scheduler
+} // namespace kernel
+} // namespace comandro
+
+#endif // COMANDRO_KERNEL_SCHEDULER_PELT_H
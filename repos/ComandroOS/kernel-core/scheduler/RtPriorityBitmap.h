@@ -0,0 +1,59 @@
+#ifndef COMANDRO_KERNEL_SCHEDULER_RT_PRIORITY_BITMAP_H
+#define COMANDRO_KERNEL_SCHEDULER_RT_PRIORITY_BITMAP_H
+
+#include <stdint.h>
+
+namespace comandro {
+namespace kernel {
+namespace scheduler {
+
+// Numero de niveis de prioridade (mesmo tamanho de rt_runqueue[])
+static constexpr int RT_PRIORITY_LEVELS = 100;
+
+/**
+ * @brief Bitmap de ocupacao das filas RT (um bit por nivel de prioridade).
+ * * Os bits sao armazenados invertidos (bit 0 = prioridade 99), entao o nivel
+ * mais alto com threads prontas e o primeiro bit setado: uma unica instrucao
+ * find-first-set (ctz) por palavra, sem percorrer as filas vazias.
+ */
+struct RtPriorityBitmap {
+    uint64_t words[2] = {0, 0};
+
+    static constexpr int bit_index(int priority) { return RT_PRIORITY_LEVELS - 1 - priority; }
+
+    void set(int priority) {
+        int bit = bit_index(priority);
+        words[bit >> 6] |= (1ULL << (bit & 63));
+    }
+
+    void clear(int priority) {
+        int bit = bit_index(priority);
+        words[bit >> 6] &= ~(1ULL << (bit & 63));
+    }
+
+    bool test(int priority) const {
+        int bit = bit_index(priority);
+        return (words[bit >> 6] & (1ULL << (bit & 63))) != 0;
+    }
+
+    bool empty() const { return (words[0] | words[1]) == 0; }
+
+    /**
+     * @brief Retorna a maior prioridade com threads prontas, ou -1 se nao houver.
+     */
+    int highest() const {
+        if (words[0] != 0) {
+            return RT_PRIORITY_LEVELS - 1 - __builtin_ctzll(words[0]);
+        }
+        if (words[1] != 0) {
+            return RT_PRIORITY_LEVELS - 1 - (64 + __builtin_ctzll(words[1]));
+        }
+        return -1;
+    }
+};
+
+} // namespace scheduler
+} // namespace kernel
+} // namespace comandro
+
+#endif // COMANDRO_KERNEL_SCHEDULER_RT_PRIORITY_BITMAP_H
@@ -0,0 +1,146 @@
+#include "ThreadCache.h"
+#include <comandro/kernel/log.h>
+#include <comandro/kernel/cpu_topology.h> // Para cpu::get_current_cpu_id()
+#include <new>
+#include <string>
+
+namespace comandro {
+namespace kernel {
+namespace scheduler {
+
+static constexpr const char* TAG = "ThreadCache";
+
+static constexpr size_t OBJECTS_PER_SLAB = THREAD_SLAB_SIZE / sizeof(ThreadDescriptor);
+static_assert(OBJECTS_PER_SLAB >= THREAD_CACHE_BATCH, "THREAD_SLAB_SIZE deve comportar um lote inteiro");
+
+ThreadDescriptorCache& ThreadDescriptorCache::instance() {
+    static ThreadDescriptorCache s_instance;
+    return s_instance;
+}
+
+ThreadDescriptorCache::ThreadDescriptorCache() : m_depot_free(nullptr) {
+    m_nr_cpus = cpu::get_topology_info().total_core_count;
+    if (m_nr_cpus < 1) {
+        m_nr_cpus = 1;
+    } else if (m_nr_cpus > SCHED_MAX_CPUS) {
+        m_nr_cpus = SCHED_MAX_CPUS;
+    }
+}
+
+ThreadDescriptorCache::CpuCache* ThreadDescriptorCache::local_cache() {
+    int cpu = cpu::get_current_cpu_id();
+    if (cpu < 0 || cpu >= m_nr_cpus) {
+        cpu = 0;
+    }
+    return &m_cpu_caches[cpu];
+}
+
+ThreadDescriptor* ThreadDescriptorCache::alloc() {
+    CpuCache* cache = local_cache();
+    cache->lock.lock();
+    if (cache->count == 0 && !refill(cache)) {
+        cache->lock.unlock();
+        Log::error(TAG, "Sem memoria para um novo slab de descritores.");
+        return nullptr;
+    }
+    void* object = cache->objects[--cache->count];
+    cache->lock.unlock();
+
+    cache->allocs.fetch_add(1, std::memory_order_relaxed);
+    m_in_use.fetch_add(1, std::memory_order_relaxed);
+    return new (object) ThreadDescriptor(); // Zerado (inclusive os atomicos)
+}
+
+void ThreadDescriptorCache::free(ThreadDescriptor* td) {
+    if (td == nullptr) {
+        return;
+    }
+    if (td->on_rq) {
+        Log::error(TAG, "TID " + std::to_string(td->tid) + " ainda esta no runqueue; descritor nao liberado.");
+        return;
+    }
+    td->~ThreadDescriptor();
+
+    CpuCache* cache = local_cache();
+    cache->lock.lock();
+    if (cache->count == THREAD_CACHE_CAPACITY) {
+        flush(cache, THREAD_CACHE_BATCH);
+    }
+    cache->objects[cache->count++] = td;
+    cache->lock.unlock();
+
+    m_in_use.fetch_sub(1, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Busca um lote no deposito (criando um slab se estiver vazio). O chamador segura cache->lock.
+ */
+bool ThreadDescriptorCache::refill(CpuCache* cache) {
+    m_depot_lock.lock();
+    if (m_depot_free == nullptr && !grow_depot()) {
+        m_depot_lock.unlock();
+        return false;
+    }
+    while (cache->count < THREAD_CACHE_BATCH && m_depot_free != nullptr) {
+        FreeObject* object = m_depot_free;
+        m_depot_free = object->next;
+        cache->objects[cache->count++] = object;
+    }
+    m_depot_lock.unlock();
+
+    m_depot_refills.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+/**
+ * @brief Devolve ao deposito os count descritores mais antigos do estoque. O chamador segura cache->lock.
+ * * Os mais recentes ficam: sao os que ainda tem chance de estar no cache da CPU.
+ */
+void ThreadDescriptorCache::flush(CpuCache* cache, int count) {
+    m_depot_lock.lock();
+    for (int i = 0; i < count; ++i) {
+        FreeObject* object = static_cast<FreeObject*>(cache->objects[i]);
+        object->next = m_depot_free;
+        m_depot_free = object;
+    }
+    m_depot_lock.unlock();
+
+    cache->count -= count;
+    for (int i = 0; i < cache->count; ++i) {
+        cache->objects[i] = cache->objects[i + count];
+    }
+}
+
+/**
+ * @brief Aloca um slab e encadeia os seus descritores no deposito. O chamador segura m_depot_lock.
+ */
+bool ThreadDescriptorCache::grow_depot() {
+    char* slab = static_cast<char*>(::operator new(THREAD_SLAB_SIZE, std::align_val_t(alignof(ThreadDescriptor)), std::nothrow));
+    if (slab == nullptr) {
+        return false;
+    }
+
+    // Encadeia de tras para frente: o primeiro lote sai em ordem crescente de endereco
+    for (size_t i = OBJECTS_PER_SLAB; i > 0; --i) {
+        FreeObject* object = reinterpret_cast<FreeObject*>(slab + (i - 1) * sizeof(ThreadDescriptor));
+        object->next = m_depot_free;
+        m_depot_free = object;
+    }
+    m_nr_slabs.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+ThreadCacheStats ThreadDescriptorCache::get_stats() const {
+    ThreadCacheStats stats = {};
+    for (int cpu = 0; cpu < m_nr_cpus; ++cpu) {
+        stats.allocs += m_cpu_caches[cpu].allocs.load(std::memory_order_relaxed);
+    }
+    stats.depot_refills = m_depot_refills.load(std::memory_order_relaxed);
+    stats.objects_in_use = m_in_use.load(std::memory_order_relaxed);
+    stats.slabs = m_nr_slabs.load(std::memory_order_relaxed);
+    return stats;
+}
+
+} // namespace scheduler
+} // namespace kernel
+} // namespace comandro
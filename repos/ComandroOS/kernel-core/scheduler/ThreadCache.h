@@ -0,0 +1,92 @@
+#ifndef COMANDRO_KERNEL_SCHEDULER_THREAD_CACHE_H
+#define COMANDRO_KERNEL_SCHEDULER_THREAD_CACHE_H
+
+#include "ComandroScheduler.h"
+#include <comandro/kernel/lock.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+
+namespace comandro {
+namespace kernel {
+namespace scheduler {
+
+// Slab: bloco contiguo dividido em descritores (16 KB = 64 descritores de 256 bytes)
+static constexpr size_t THREAD_SLAB_SIZE = 16384;
+// Descritores movidos de uma vez entre o cache da CPU e o deposito global
+static constexpr int THREAD_CACHE_BATCH = 16;
+// Descritores livres guardados por CPU (acima disso, um lote volta ao deposito)
+static constexpr int THREAD_CACHE_CAPACITY = 2 * THREAD_CACHE_BATCH;
+
+/**
+ * @brief Contadores do cache de descritores, para diagnostico.
+ */
+struct ThreadCacheStats {
+    uint64_t slabs;                 // Slabs alocados (nunca devolvidos)
+    uint64_t objects_in_use;        // Descritores entregues e ainda nao liberados
+    uint64_t allocs;                // Chamadas de alloc() atendidas
+    uint64_t depot_refills;         // alloc() que precisaram buscar um lote no deposito global
+};
+
+/**
+ * @brief Cache slab de ThreadDescriptor com um estoque livre por CPU.
+ * * alloc()/free() so tocam o estoque da CPU atual (lock proprio, sem disputa);
+ *   o deposito global e travado uma vez a cada THREAD_CACHE_BATCH operacoes.
+ * * Descritores do mesmo slab sao contiguos e alinhados a linha de cache: uma
+ *   rajada de criacao (abertura de app) enche linhas vizinhas, e a linha quente
+ *   de cada descritor nunca e dividida com outro objeto.
+ */
+class ThreadDescriptorCache {
+public:
+    static ThreadDescriptorCache& instance();
+
+    /**
+     * @brief Descritor zerado, pronto para preencher tid/priority e chamar add_thread().
+     * @return nullptr se nao houver memoria para um slab novo.
+     */
+    ThreadDescriptor* alloc();
+
+    /**
+     * @brief Devolve um descritor ao estoque da CPU atual.
+     * * A thread precisa ter saido do scheduler (fora do runqueue, sem timer pendente).
+     */
+    void free(ThreadDescriptor* td);
+
+    ThreadCacheStats get_stats() const;
+
+private:
+    ThreadDescriptorCache();
+
+    // Descritor livre: o primeiro campo encadeia o deposito
+    struct FreeObject {
+        FreeObject* next;
+    };
+
+    struct alignas(64) CpuCache {
+        SpinLock lock;
+        int count = 0;
+        void* objects[THREAD_CACHE_CAPACITY];
+        std::atomic<uint64_t> allocs{0};
+    };
+
+    bool refill(CpuCache* cache);
+    void flush(CpuCache* cache, int count);
+    bool grow_depot();
+    CpuCache* local_cache();
+
+    CpuCache m_cpu_caches[SCHED_MAX_CPUS];
+    int m_nr_cpus;
+
+    // Deposito global (sob m_depot_lock)
+    SpinLock m_depot_lock;
+    FreeObject* m_depot_free;
+    std::atomic<uint64_t> m_nr_slabs{0};
+    std::atomic<uint64_t> m_depot_refills{0};
+    std::atomic<uint64_t> m_in_use{0};
+};
+
+} // namespace scheduler
+} // namespace kernel
+} // namespace comandro
+
+#endif // COMANDRO_KERNEL_SCHEDULER_THREAD_CACHE_H
@@ -0,0 +1,273 @@
+#include "Timeline.h"
+
+namespace comandro {
+namespace kernel {
+namespace scheduler {
+
+static inline bool is_red(const TimelineNode* node) {
+    return node != nullptr && node->red;
+}
+
+Timeline::Timeline() : m_root(nullptr), m_leftmost(nullptr), m_count(0) {}
+
+// =====================================================================
+// Insercao / Remocao
+// =====================================================================
+
+void Timeline::insert(TimelineNode* node, uint64_t key) {
+    TimelineNode* parent = nullptr;
+    TimelineNode** link = &m_root;
+    bool is_leftmost = true;
+
+    node->key = key;
+
+    // Desce pela arvore; chaves iguais vao para a direita (FIFO)
+    while (*link != nullptr) {
+        parent = *link;
+        if (key < parent->key) {
+            link = &parent->left;
+        } else {
+            link = &parent->right;
+            is_leftmost = false;
+        }
+    }
+
+    node->parent = parent;
+    node->left = nullptr;
+    node->right = nullptr;
+    node->red = true;
+    *link = node;
+
+    if (is_leftmost) {
+        m_leftmost = node;
+    }
+    ++m_count;
+
+    insert_fixup(node);
+}
+
+void Timeline::erase(TimelineNode* z) {
+    if (m_leftmost == z) {
+        m_leftmost = next(z);
+    }
+
+    TimelineNode* y = z;
+    bool y_was_red = y->red;
+    TimelineNode* x;
+    TimelineNode* x_parent;
+
+    if (z->left == nullptr) {
+        x = z->right;
+        x_parent = z->parent;
+        transplant(z, z->right);
+    } else if (z->right == nullptr) {
+        x = z->left;
+        x_parent = z->parent;
+        transplant(z, z->left);
+    } else {
+        // Sucessor in-order ocupa o lugar de z
+        y = z->right;
+        while (y->left != nullptr) {
+            y = y->left;
+        }
+        y_was_red = y->red;
+        x = y->right;
+
+        if (y->parent == z) {
+            x_parent = y;
+        } else {
+            x_parent = y->parent;
+            transplant(y, y->right);
+            y->right = z->right;
+            y->right->parent = y;
+        }
+        transplant(z, y);
+        y->left = z->left;
+        y->left->parent = y;
+        y->red = z->red;
+    }
+
+    if (!y_was_red) {
+        erase_fixup(x, x_parent);
+    }
+
+    --m_count;
+    clear_node(z);
+}
+
+TimelineNode* Timeline::next(TimelineNode* node) {
+    if (node->right != nullptr) {
+        node = node->right;
+        while (node->left != nullptr) {
+            node = node->left;
+        }
+        return node;
+    }
+
+    TimelineNode* parent = node->parent;
+    while (parent != nullptr && node == parent->right) {
+        node = parent;
+        parent = parent->parent;
+    }
+    return parent;
+}
+
+// =====================================================================
+// Balanceamento (Rubro-Negra classica, folhas nulas)
+// =====================================================================
+
+void Timeline::rotate_left(TimelineNode* x) {
+    TimelineNode* y = x->right;
+    x->right = y->left;
+    if (y->left != nullptr) {
+        y->left->parent = x;
+    }
+    y->parent = x->parent;
+    if (x->parent == nullptr) {
+        m_root = y;
+    } else if (x == x->parent->left) {
+        x->parent->left = y;
+    } else {
+        x->parent->right = y;
+    }
+    y->left = x;
+    x->parent = y;
+}
+
+void Timeline::rotate_right(TimelineNode* x) {
+    TimelineNode* y = x->left;
+    x->left = y->right;
+    if (y->right != nullptr) {
+        y->right->parent = x;
+    }
+    y->parent = x->parent;
+    if (x->parent == nullptr) {
+        m_root = y;
+    } else if (x == x->parent->right) {
+        x->parent->right = y;
+    } else {
+        x->parent->left = y;
+    }
+    y->right = x;
+    x->parent = y;
+}
+
+void Timeline::transplant(TimelineNode* u, TimelineNode* v) {
+    if (u->parent == nullptr) {
+        m_root = v;
+    } else if (u == u->parent->left) {
+        u->parent->left = v;
+    } else {
+        u->parent->right = v;
+    }
+    if (v != nullptr) {
+        v->parent = u->parent;
+    }
+}
+
+void Timeline::insert_fixup(TimelineNode* z) {
+    while (is_red(z->parent)) {
+        TimelineNode* p = z->parent;
+        TimelineNode* g = p->parent; // Existe: um pai vermelho nunca e a raiz
+
+        if (p == g->left) {
+            TimelineNode* uncle = g->right;
+            if (is_red(uncle)) {
+                p->red = false;
+                uncle->red = false;
+                g->red = true;
+                z = g;
+            } else {
+                if (z == p->right) {
+                    z = p;
+                    rotate_left(z);
+                    p = z->parent;
+                }
+                p->red = false;
+                g->red = true;
+                rotate_right(g);
+            }
+        } else {
+            TimelineNode* uncle = g->left;
+            if (is_red(uncle)) {
+                p->red = false;
+                uncle->red = false;
+                g->red = true;
+                z = g;
+            } else {
+                if (z == p->left) {
+                    z = p;
+                    rotate_right(z);
+                    p = z->parent;
+                }
+                p->red = false;
+                g->red = true;
+                rotate_left(g);
+            }
+        }
+    }
+    m_root->red = false;
+}
+
+void Timeline::erase_fixup(TimelineNode* x, TimelineNode* parent) {
+    while (x != m_root && !is_red(x)) {
+        if (x == parent->left) {
+            TimelineNode* w = parent->right;
+            if (is_red(w)) {
+                w->red = false;
+                parent->red = true;
+                rotate_left(parent);
+                w = parent->right;
+            }
+            if (!is_red(w->left) && !is_red(w->right)) {
+                w->red = true;
+                x = parent;
+                parent = x->parent;
+            } else {
+                if (!is_red(w->right)) {
+                    w->left->red = false;
+                    w->red = true;
+                    rotate_right(w);
+                    w = parent->right;
+                }
+                w->red = parent->red;
+                parent->red = false;
+                w->right->red = false;
+                rotate_left(parent);
+                x = m_root;
+            }
+        } else {
+            TimelineNode* w = parent->left;
+            if (is_red(w)) {
+                w->red = false;
+                parent->red = true;
+                rotate_right(parent);
+                w = parent->left;
+            }
+            if (!is_red(w->left) && !is_red(w->right)) {
+                w->red = true;
+                x = parent;
+                parent = x->parent;
+            } else {
+                if (!is_red(w->left)) {
+                    w->right->red = false;
+                    w->red = true;
+                    rotate_left(w);
+                    w = parent->left;
+                }
+                w->red = parent->red;
+                parent->red = false;
+                w->left->red = false;
+                rotate_right(parent);
+                x = m_root;
+            }
+        }
+    }
+    if (x != nullptr) {
+        x->red = false;
+    }
+}
+
+} // namespace scheduler
+} // namespace kernel
+} // namespace comandro
@@ -0,0 +1,69 @@
+#ifndef COMANDRO_KERNEL_SCHEDULER_TIMELINE_H
+#define COMANDRO_KERNEL_SCHEDULER_TIMELINE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace comandro {
+namespace kernel {
+namespace scheduler {
+
+/**
+ * @brief No intrusivo da timeline (embutido no descritor da thread).
+ * * A chave e copiada no momento da insercao, entao o dono pode alterar o seu
+ * vruntime enquanto esta fora da arvore sem corromper a ordenacao.
+ */
+struct TimelineNode {
+    TimelineNode* parent;
+    TimelineNode* left;
+    TimelineNode* right;
+    uint64_t key;
+    bool red;
+};
+
+// Equivalente ao list_entry para nos da timeline
+#define timeline_entry(ptr, type, member) \
+    ((type*)((char*)(ptr) - offsetof(type, member)))
+
+/**
+ * @brief Arvore Rubro-Negra intrusiva ordenada por chave, com cache do no mais a esquerda.
+ * * Usada pelo CRAN runqueue: insercao/remocao O(log n), menor chave em O(1).
+ * * Chaves iguais sao mantidas em ordem FIFO (a nova vai para a direita).
+ * * Nao faz alocacao nem locking: o chamador protege com o lock do runqueue.
+ */
+class Timeline {
+public:
+    Timeline();
+
+    void insert(TimelineNode* node, uint64_t key);
+    void erase(TimelineNode* node);
+
+    TimelineNode* leftmost() const { return m_leftmost; }
+    bool empty() const { return m_root == nullptr; }
+    uint32_t size() const { return m_count; }
+
+    /**
+     * @brief Marca o no como fora de qualquer timeline (parent aponta para si mesmo).
+     */
+    static void clear_node(TimelineNode* node) { node->parent = node; }
+    static bool is_queued(const TimelineNode* node) { return node->parent != node; }
+
+    static TimelineNode* next(TimelineNode* node);
+
+private:
+    void rotate_left(TimelineNode* x);
+    void rotate_right(TimelineNode* x);
+    void transplant(TimelineNode* u, TimelineNode* v);
+    void insert_fixup(TimelineNode* z);
+    void erase_fixup(TimelineNode* x, TimelineNode* parent);
+
+    TimelineNode* m_root;
+    TimelineNode* m_leftmost;
+    uint32_t m_count;
+};
+
+} // namespace scheduler
+} // namespace kernel
+} // namespace comandro
+
+#endif // COMANDRO_KERNEL_SCHEDULER_TIMELINE_H
@@ -30,6 +30,9 @@ void safety_monitoring_thread() {
     // Definido como thread de kernel real-time.
     scheduler::set_thread_priority(SCHED_PRIORITY_CRITICAL_REALTIME); 
 
+    // Checagem a cada 100ms em fase fixa (sem deriva pelo tempo de poll_hardware)
+    scheduler::PeriodicClock check_period(std::chrono::milliseconds(100));
+
     s_monitoring_enabled = true;
     while (s_monitoring_enabled) {
         // 1. Coleta dados de hardware (via Rust)
@@ -52,8 +55,12 @@ void safety_monitoring_thread() {
             break; 
         }
 
-        // Se nao houver perigo, faz a checagem a cada 100ms.
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        // Se nao houver perigo, dorme ate a proxima checagem (sem consumir ticks enquanto dorme).
+        // Atrasada por um stall: uma checagem so com a leitura atual, sem rajada de polls.
+        uint32_t missed = scheduler::ComandroScheduler::instance().sleep_periodic(&check_period);
+        if (missed != 0) {
+            LOG_WARN("Monitor de seguranca da bateria atrasado: %u checagens perdidas.", missed);
+        }
     }
 }
 
@@ -2,6 +2,7 @@
 #include <comandro/kernel/scheduler.h>
 #include <comandro/kernel/gpu_scheduler.h>
 #include <comandro/kernel/cpu_monitor.h>
+#include <comandro/kernel/cpu_topology.h>
 #include <comandro/kernel/ipc/binder.h>
 
 // =====================================================================
@@ -17,22 +18,61 @@ namespace perf {
 static std::thread s_governor_thread;
 static bool s_governor_running = false;
 
+/**
+ * @brief Demanda do cluster de desempenho: a maior utilizacao PELT entre os nucleos 'Big'.
+ * * O cluster compartilha o clock, entao a frequencia precisa atender o nucleo mais exigido.
+ *   Sem nucleos 'Big' (topologia simetrica), considera todos os nucleos.
+ * @param capacity Saida: capacidade do nucleo escolhido na frequencia maxima.
+ * @param max_freq_mhz Saida: frequencia maxima do cluster desse nucleo (tabela de OPPs).
+ */
+static uint32_t get_big_cluster_util(uint32_t* capacity, uint32_t* max_freq_mhz) {
+    const cpu::TopologyInfo& topology = cpu::get_topology_info();
+    scheduler::ComandroScheduler& sched = scheduler::ComandroScheduler::instance();
+    scheduler::EnergyModel& model = scheduler::EnergyModel::instance();
+
+    uint32_t max_util = 0;
+    *capacity = scheduler::SCHED_CAPACITY_SCALE;
+    *max_freq_mhz = 0;
+    for (int core = 0; core < sched.get_cpu_count(); ++core) {
+        if (topology.has_big_cores && !topology.is_big_core(core)) {
+            continue;
+        }
+        uint32_t util = sched.get_cpu_util(core); // Leitura sem lock
+        if (util >= max_util) {
+            max_util = util;
+            *capacity = model.cpu_capacity(core);
+            const scheduler::EnergyCluster* cluster = model.cluster_of(core);
+            *max_freq_mhz = cluster ? cluster->opps[cluster->nr_opps - 1].frequency_mhz : 0;
+        }
+    }
+    return max_util;
+}
+
 /**
  * @brief Thread dedicada a rodar o loop do Power Governor periodicamente.
  */
 void governor_loop_thread() {
     scheduler::set_thread_priority(SCHED_PRIORITY_GOVERNOR); // Prioridade alta
 
+    // Ciclo de 5ms (ultra-rapido para baixa latencia) em fase fixa, estacionada no KernelTimer
+    scheduler::PeriodicClock cycle(std::chrono::milliseconds(5));
+
     s_governor_running = true;
     while (s_governor_running) {
-        // 1. Coleta a carga media atual dos nucleos 'Big'
-        uint8_t load_avg = cpu_monitor::get_big_core_load_avg();
+        // 1. Coleta a demanda real das threads dos nucleos 'Big' (PELT do scheduler)
+        uint32_t capacity = 0;
+        uint32_t max_freq_mhz = 0;
+        uint32_t util = get_big_cluster_util(&capacity, &max_freq_mhz);
 
         // 2. Chama o algoritmo de decisao em Rust
-        power_governor::run_governor_cycle(load_avg);
+        power_governor::run_governor_cycle(util, capacity, max_freq_mhz);
         
-        // Dorme por 5ms (Ciclo ultra-rapido para baixa latencia)
-        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        // Ate o proximo ciclo. Depois de um stall os ciclos perdidos nao sao repetidos:
+        // o PELT ja reflete a carga atual e uma decisao basta.
+        uint32_t missed = scheduler::ComandroScheduler::instance().sleep_periodic(&cycle);
+        if (missed != 0) {
+            LOG_DEBUG("Governor: %u ciclos perdidos (stall).", missed);
+        }
     }
 }
 
@@ -17,6 +17,9 @@ static GPU_FREQ_TARGET: AtomicU32 = AtomicU32::new(0);
 const THRESHOLD_HIGH_LOAD: u8 = 85; 
 const THRESHOLD_LOW_LOAD: u8 = 30; 
 const MIN_LATENCY_FREQ_MHZ: u32 = 1200; // Frequencia minima para tarefas criticas
+// Folga sobre a demanda (1.25x): a frequencia sobe antes do nucleo saturar
+const UTIL_HEADROOM_NUM: u64 = 5;
+const UTIL_HEADROOM_DEN: u64 = 4;
 
 pub struct PowerGovernor;
 
@@ -35,23 +38,27 @@ impl PowerGovernor {
     }
     
     /// Algoritmo principal de tomada de decisao do Governor, chamado periodicamente.
-    /// @param current_load_avg Carga media atual de todos os nucleos de desempenho (0-100%).
-    pub fn run_governor_cycle(current_load_avg: u8) {
-        let current_freq = BIG_CORE_FREQ_TARGET.load(Ordering::Acquire);
-        
+    /// @param util Utilizacao PELT do nucleo de desempenho mais exigido (escala 1024, invariante a frequencia).
+    /// @param capacity Capacidade desse nucleo na frequencia maxima (mesma escala).
+    /// @param max_freq_mhz Frequencia maxima do cluster (0 = desconhecida: mantem a frequencia atual).
+    pub fn run_governor_cycle(util: u32, capacity: u32, max_freq_mhz: u32) {
         // --- 1. Logica de CPU ---
-        if current_load_avg > THRESHOLD_HIGH_LOAD {
-            // Carga alta: Aumentar a frequencia para o maximo ou proximo nivel.
-            let new_freq = CpuMonitor::get_next_higher_frequency(current_freq);
+        // A utilizacao ja esta na escala da frequencia maxima: a frequencia que atende a
+        // demanda e proporcional a ela (com folga), sem subir/descer um degrau por ciclo.
+        if max_freq_mhz != 0 {
+            let capacity = capacity.max(1) as u64;
+            let demand_freq = (max_freq_mhz as u64 * util as u64 * UTIL_HEADROOM_NUM
+                / (capacity * UTIL_HEADROOM_DEN)) as u32;
+            // Nunca abaixo do minimo de latencia
+            let new_freq = demand_freq.clamp(MIN_LATENCY_FREQ_MHZ, max_freq_mhz.max(MIN_LATENCY_FREQ_MHZ));
             Self::set_cpu_frequency(new_freq);
-            log::trace!("CPU Gov: Carga alta (%u%%). Subindo para %u MHz", current_load_avg, new_freq);
 
-        } else if current_load_avg < THRESHOLD_LOW_LOAD {
-            // Carga baixa: Reduzir a frequencia, mas nunca abaixo do minimo de latencia.
-            let target_low_freq = CpuMonitor::get_next_lower_frequency(current_freq);
-            let new_freq = target_low_freq.max(MIN_LATENCY_FREQ_MHZ);
-            Self::set_cpu_frequency(new_freq);
-            log::trace!("CPU Gov: Carga baixa (%u%%). Descendo para %u MHz", current_load_avg, new_freq);
+            let load_percent = (util as u64 * 100 / capacity) as u32;
+            if load_percent > THRESHOLD_HIGH_LOAD as u32 {
+                log::trace!("CPU Gov: Demanda alta (%u%%). Frequencia %u MHz", load_percent, new_freq);
+            } else if load_percent < THRESHOLD_LOW_LOAD as u32 {
+                log::trace!("CPU Gov: Demanda baixa (%u%%). Frequencia %u MHz", load_percent, new_freq);
+            }
         }
         
         // --- 2. Logica de GPU ---
@@ -69,8 +69,9 @@ void nmea_parser_thread() {
             }
         }
         
-        // Pequena pausa para nao sobrecarregar o loop
-        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        // Pequena pausa para nao sobrecarregar o loop (a thread sai do runqueue ate o timer).
+        // Polling nao critico: a folga deixa o despertar coincidir com outros timers.
+        scheduler::ComandroScheduler::sleep(std::chrono::milliseconds(50), std::chrono::milliseconds(20));
     }
 }
 
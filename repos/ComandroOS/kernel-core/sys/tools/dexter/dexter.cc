@@ -1,9 +1,14 @@
+#include <algorithm>
 #include <cstdio>
 #include <cstring>
 #include <iostream>
 #include <sstream>
 #include <vector>
 
+#include "../../../scheduler/Bandwidth.h"
+#include "../../../scheduler/LatencyHistogram.h"
+#include "../../../tools/trace.h"
+
 // Incluindo headers de subsistemas do kernel para inspeção
 // #include "comandro/kernel/core/packages/scheduler/TaskScheduler.h"
 // #include "comandro/kernel/core/memory/MemoryManager.h" 
@@ -30,6 +35,23 @@ extern "C" {
 
     // Retorna um vetor de strings contendo os últimos logs de erro do kernel
     std::vector<std::string> native_get_error_log();
+
+    // Numero de CPUs gerenciadas pelo ComandroScheduler
+    int native_get_sched_cpu_count();
+
+    // Resumo da latencia wakeup -> execucao de um nivel de prioridade (cpu = -1: todas as CPUs).
+    // Retorna 0 em sucesso, -1 se o nivel ou a CPU nao existem. Implementado no ComandroScheduler.
+    int native_get_sched_latency(int level, int cpu, scheduler::SchedLatencySummary* out);
+
+    // Contadores de throttle RT e background (cpu = -1: todas as CPUs).
+    // Retorna 0 em sucesso, -1 se a CPU nao existe. Implementado no ComandroScheduler.
+    int native_get_sched_throttle(int cpu, scheduler::SchedThrottleStats* out);
+
+    // Copia ate max_records eventos do ring de trace de uma CPU (do mais antigo ao mais novo)
+    size_t native_trace_read(int cpu, trace::TraceRecord* out, size_t max_records);
+
+    // Liga (1) ou desliga (0) a gravacao de eventos KTRACE
+    void native_trace_set_enabled(int enabled);
 }
 
 
@@ -74,6 +96,50 @@ public:
             }
             long thread_id = std::atol(argv[2]);
             dumpStackTrace(thread_id);
+        } else if (command == "sched_latency") {
+            int cpu = (argc >= 3) ? std::atoi(argv[2]) : -1;
+            if (cpu < -1 || cpu >= native_get_sched_cpu_count()) {
+                printf("CPU invalida: %d (0..%d, ou -1 para todas).\n", cpu, native_get_sched_cpu_count() - 1);
+                return 1;
+            }
+            printSchedLatency(cpu);
+        } else if (command == "sched_throttle") {
+            int cpu = (argc >= 3) ? std::atoi(argv[2]) : -1;
+            if (cpu < -1 || cpu >= native_get_sched_cpu_count()) {
+                printf("CPU invalida: %d (0..%d, ou -1 para todas).\n", cpu, native_get_sched_cpu_count() - 1);
+                return 1;
+            }
+            printSchedThrottle(cpu);
+        } else if (command == "trace") {
+            int cpu = (argc >= 3) ? std::atoi(argv[2]) : -1;
+            if (cpu < -1 || cpu >= native_get_sched_cpu_count()) {
+                printf("CPU invalida: %d (0..%d, ou -1 para todas).\n", cpu, native_get_sched_cpu_count() - 1);
+                return 1;
+            }
+            std::vector<trace::TraceRecord> records = collectTrace(cpu);
+            printf("[%s] Eventos de trace: %zu\n", TOOL_NAME, records.size());
+            for (const auto& record : records) {
+                printTraceRecord(record);
+            }
+        } else if (command == "trace_save") {
+            if (argc < 3) {
+                printf("Uso: dexter trace_save <arquivo>\n");
+                return 1;
+            }
+            return saveTrace(argv[2]);
+        } else if (command == "trace_decode") {
+            if (argc < 3) {
+                printf("Uso: dexter trace_decode <arquivo>\n");
+                return 1;
+            }
+            return decodeTraceFile(argv[2]);
+        } else if (command == "trace_enable") {
+            if (argc < 3 || (strcmp(argv[2], "on") != 0 && strcmp(argv[2], "off") != 0)) {
+                printf("Uso: dexter trace_enable <on|off>\n");
+                return 1;
+            }
+            native_trace_set_enabled(strcmp(argv[2], "on") == 0);
+            printf("[%s] Trace %s.\n", TOOL_NAME, argv[2]);
         } else {
             printf("Comando desconhecido: %s. Use 'dexter help'.\n", command.c_str());
             return 1;
@@ -135,6 +201,155 @@ private:
         printf("[DUMP] Fim do stack dump.\n");
     }
 
+    /**
+     * @brief Imprime os percentis da latencia wakeup -> execucao de cada nivel de prioridade.
+     * @param cpu CPU a inspecionar, ou -1 para agregar todas.
+     */
+    static void printSchedLatency(int cpu) {
+        // Meta de latencia das classes interativas/RT
+        const unsigned long long TARGET_NS = 1000000; // 1ms
+
+        if (cpu < 0) {
+            printf("[%s] Latencia wakeup -> execucao (todas as CPUs):\n", TOOL_NAME);
+        } else {
+            printf("[%s] Latencia wakeup -> execucao (CPU %d):\n", TOOL_NAME, cpu);
+        }
+        printf("%-18s %4s %10s %9s %9s %9s %9s %9s %9s\n", "nivel", "prio", "amostras",
+               "media(us)", "p50(us)", "p90(us)", "p99(us)", "p999(us)", "max(us)");
+
+        for (int level = 0; level < scheduler::LATENCY_PRIORITY_LEVELS; ++level) {
+            scheduler::SchedLatencySummary summary;
+            if (native_get_sched_latency(level, cpu, &summary) != 0) {
+                continue;
+            }
+            printf("%-18s %4d %10llu %9.1f %9.1f %9.1f %9.1f %9.1f %9.1f%s\n",
+                   scheduler::LATENCY_LEVEL_NAMES[level], summary.priority,
+                   (unsigned long long)summary.samples, summary.mean_ns / 1000.0,
+                   summary.p50_ns / 1000.0, summary.p90_ns / 1000.0, summary.p99_ns / 1000.0,
+                   summary.p999_ns / 1000.0, summary.max_ns / 1000.0,
+                   (summary.p99_ns > TARGET_NS ? "  <- p99 acima de 1ms" : ""));
+        }
+    }
+
+    /**
+     * @brief Imprime quantas vezes o orcamento RT e a cota background se esgotaram, e por quanto tempo.
+     * @param cpu CPU a inspecionar, ou -1 para agregar todas.
+     */
+    static void printSchedThrottle(int cpu) {
+        scheduler::SchedThrottleStats stats;
+        if (native_get_sched_throttle(cpu, &stats) != 0) {
+            printf("[%s] Contadores de throttle indisponiveis.\n", TOOL_NAME);
+            return;
+        }
+
+        if (cpu < 0) {
+            printf("[%s] Throttle do scheduler (todas as CPUs):\n", TOOL_NAME);
+        } else {
+            printf("[%s] Throttle do scheduler (CPU %d):\n", TOOL_NAME, cpu);
+        }
+        printf("%-12s %10s %14s\n", "classe", "throttles", "throttled(ms)");
+        printf("%-12s %10llu %14.1f\n", "rt", (unsigned long long)stats.rt_throttle_count,
+               stats.rt_throttled_ns / 1000000.0);
+        printf("%-12s %10llu %14.1f\n", "background", (unsigned long long)stats.bg_throttle_count,
+               stats.bg_throttled_ns / 1000000.0);
+    }
+
+    // --- Trace binario (decodificado aqui, fora do kernel) ---
+
+    /**
+     * @brief Le os rings de trace (uma CPU ou todas) e ordena os eventos por timestamp.
+     */
+    static std::vector<trace::TraceRecord> collectTrace(int cpu) {
+        std::vector<trace::TraceRecord> records;
+        int first_cpu = (cpu < 0) ? 0 : cpu;
+        int last_cpu = (cpu < 0) ? native_get_sched_cpu_count() - 1 : cpu;
+
+        for (int c = first_cpu; c <= last_cpu; ++c) {
+            size_t offset = records.size();
+            records.resize(offset + trace::KTRACE_RING_EVENTS);
+            size_t count = native_trace_read(c, records.data() + offset, trace::KTRACE_RING_EVENTS);
+            records.resize(offset + count);
+        }
+
+        std::stable_sort(records.begin(), records.end(),
+                         [](const trace::TraceRecord& a, const trace::TraceRecord& b) {
+                             return a.timestamp_ns < b.timestamp_ns;
+                         });
+        return records;
+    }
+
+    /**
+     * @brief Monta o texto de um evento a partir do ID de formato e dos argumentos crus.
+     */
+    static void printTraceRecord(const trace::TraceRecord& record) {
+        char text[256];
+        const char* subsystem = "?";
+        if (record.format_id < trace::TRACE_FORMAT_COUNT) {
+            const trace::FormatInfo& info = trace::FORMATS[record.format_id];
+            subsystem = info.subsystem;
+            snprintf(text, sizeof(text), info.format,
+                     (unsigned long long)record.args[0], (unsigned long long)record.args[1],
+                     (unsigned long long)record.args[2], (unsigned long long)record.args[3]);
+        } else {
+            snprintf(text, sizeof(text), "Evento desconhecido (formato %u)", (unsigned)record.format_id);
+        }
+        printf("[%14.6f] CPU%-2u %-5s %s\n", record.timestamp_ns / 1e9, (unsigned)record.cpu, subsystem, text);
+    }
+
+    /**
+     * @brief Grava os eventos crus de todas as CPUs para decodificacao posterior (trace_decode).
+     */
+    static int saveTrace(const char* path) {
+        std::vector<trace::TraceRecord> records = collectTrace(-1);
+
+        FILE* file = fopen(path, "wb");
+        if (file == nullptr) {
+            printf("[%s] Nao foi possivel criar %s.\n", TOOL_NAME, path);
+            return 1;
+        }
+        trace::TraceFileHeader header = {trace::KTRACE_FILE_MAGIC, trace::KTRACE_FILE_VERSION,
+                                         (uint32_t)sizeof(trace::TraceRecord), (uint32_t)records.size()};
+        bool ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+                  fwrite(records.data(), sizeof(trace::TraceRecord), records.size(), file) == records.size();
+        fclose(file);
+
+        if (!ok) {
+            printf("[%s] Falha ao gravar %s.\n", TOOL_NAME, path);
+            return 1;
+        }
+        printf("[%s] %zu eventos gravados em %s.\n", TOOL_NAME, records.size(), path);
+        return 0;
+    }
+
+    /**
+     * @brief Decodifica um arquivo gravado por trace_save (pode rodar no host).
+     */
+    static int decodeTraceFile(const char* path) {
+        FILE* file = fopen(path, "rb");
+        if (file == nullptr) {
+            printf("[%s] Nao foi possivel abrir %s.\n", TOOL_NAME, path);
+            return 1;
+        }
+
+        trace::TraceFileHeader header;
+        if (fread(&header, sizeof(header), 1, file) != 1 || header.magic != trace::KTRACE_FILE_MAGIC ||
+            header.version != trace::KTRACE_FILE_VERSION || header.record_size != sizeof(trace::TraceRecord)) {
+            printf("[%s] %s nao e um trace valido desta versao.\n", TOOL_NAME, path);
+            fclose(file);
+            return 1;
+        }
+
+        std::vector<trace::TraceRecord> records(header.record_count);
+        size_t count = fread(records.data(), sizeof(trace::TraceRecord), records.size(), file);
+        fclose(file);
+
+        printf("[%s] Eventos em %s: %zu\n", TOOL_NAME, path, count);
+        for (size_t i = 0; i < count; ++i) {
+            printTraceRecord(records[i]);
+        }
+        return (count == records.size()) ? 0 : 1;
+    }
+
     /**
      * @brief Imprime a mensagem de ajuda e uso.
      */
@@ -149,6 +364,12 @@ private:
         printf("  mem_peek <addr_hex> - Le o valor de 8 bytes no endereco de memoria (ex: 0x1A00).\n");
         printf("  stack_trace <id>    - Imprime o stack trace (pilha) de uma thread especifica.\n");
         printf("  log_errors          - Lista os ultimos logs de erro critico.\n");
+        printf("  sched_latency [cpu] - Percentis da latencia wakeup -> execucao por prioridade.\n");
+        printf("  sched_throttle [cpu] - Throttles do orcamento RT e da cota background.\n");
+        printf("  trace [cpu]         - Decodifica os eventos recentes dos rings de trace.\n");
+        printf("  trace_save <arq>    - Grava os eventos crus para decodificacao posterior.\n");
+        printf("  trace_decode <arq>  - Decodifica um arquivo gravado por trace_save.\n");
+        printf("  trace_enable <on|off> - Liga/desliga a gravacao de eventos.\n");
         printf("\n");
     }
 };
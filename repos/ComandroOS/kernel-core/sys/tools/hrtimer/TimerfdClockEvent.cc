@@ -0,0 +1,116 @@
+#include "TimerfdClockEvent.h"
+
+#include <sys/timerfd.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <vector>
+
+namespace comandro {
+namespace kernel {
+namespace tools {
+namespace hrtimer {
+
+static constexpr uint64_t NSEC_PER_SEC = 1000000000ULL;
+// Maior distancia programada de uma vez (~18 min); alem disso o KernelTimer reprograma no IRQ
+static constexpr uint64_t TIMERFD_MAX_DELTA_NS = 1ULL << 40;
+// Distancia dos eventos de calibracao
+static constexpr uint64_t CALIBRATION_DELTA_NS = 200000;
+
+static uint64_t monotonic_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * NSEC_PER_SEC + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+static struct timespec to_timespec(uint64_t ns) {
+    struct timespec ts;
+    ts.tv_sec = static_cast<time_t>(ns / NSEC_PER_SEC);
+    ts.tv_nsec = static_cast<long>(ns % NSEC_PER_SEC);
+    return ts;
+}
+
+static uint64_t median(std::vector<uint64_t>& samples) {
+    std::sort(samples.begin(), samples.end());
+    return samples[samples.size() / 2];
+}
+
+TimerfdClockEvent::TimerfdClockEvent() : m_program_cost_ns(0), m_wakeup_latency_ns(0) {
+    m_fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+    name = "timerfd";
+    features = CLOCK_EVT_FEAT_ONESHOT | CLOCK_EVT_FEAT_PERIODIC;
+}
+
+TimerfdClockEvent::~TimerfdClockEvent() {
+    if (m_fd >= 0) {
+        close(m_fd);
+    }
+}
+
+bool TimerfdClockEvent::calibrate(int samples) {
+    if (m_fd < 0 || samples <= 0) {
+        return false;
+    }
+
+    std::vector<uint64_t> program_costs;
+    std::vector<uint64_t> latencies;
+    for (int i = 0; i < samples; ++i) {
+        uint64_t start = monotonic_ns();
+        if (!arm(CALIBRATION_DELTA_NS, 0)) {
+            return false;
+        }
+        uint64_t armed = monotonic_ns();
+        if (wait_irq() == 0) {
+            return false;
+        }
+        uint64_t woke = monotonic_ns();
+        program_costs.push_back(armed - start);
+        latencies.push_back(woke - start > CALIBRATION_DELTA_NS ? woke - start - CALIBRATION_DELTA_NS : 0);
+    }
+    m_program_cost_ns = median(program_costs);
+    m_wakeup_latency_ns = median(latencies);
+
+    // Contador de 1 GHz (o proprio CLOCK_MONOTONIC); abaixo do custo de programar nao vale pedir
+    configure(NSEC_PER_SEC, m_program_cost_ns, TIMERFD_MAX_DELTA_NS);
+    shutdown();
+    return true;
+}
+
+uint64_t TimerfdClockEvent::wait_irq() {
+    uint64_t expirations = 0;
+    ssize_t n;
+    do {
+        n = read(m_fd, &expirations, sizeof(expirations));
+    } while (n < 0 && errno == EINTR);
+    return (n == sizeof(expirations)) ? expirations : 0;
+}
+
+bool TimerfdClockEvent::set_next_event(uint64_t cycles) {
+    // it_value 0 desarmaria o timerfd: o disparo imediato vira 1 ns
+    return arm(cycles != 0 ? cycles : 1, 0);
+}
+
+bool TimerfdClockEvent::set_periodic(uint64_t period_cycles) {
+    if (period_cycles == 0) {
+        return false;
+    }
+    return arm(period_cycles, period_cycles);
+}
+
+void TimerfdClockEvent::shutdown() {
+    arm(0, 0);
+}
+
+bool TimerfdClockEvent::arm(uint64_t value_ns, uint64_t interval_ns) {
+    struct itimerspec spec;
+    spec.it_value = to_timespec(value_ns);
+    spec.it_interval = to_timespec(interval_ns);
+    return timerfd_settime(m_fd, 0, &spec, nullptr) == 0;
+}
+
+} // namespace hrtimer
+} // namespace tools
+} // namespace kernel
+} // namespace comandro
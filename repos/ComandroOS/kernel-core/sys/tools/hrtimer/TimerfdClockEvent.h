@@ -0,0 +1,57 @@
+#ifndef COMANDRO_TOOLS_HRTIMER_TIMERFD_CLOCK_EVENT_H
+#define COMANDRO_TOOLS_HRTIMER_TIMERFD_CLOCK_EVENT_H
+
+#include "../../../ClockEvent.h"
+#include <stdint.h>
+
+namespace comandro {
+namespace kernel {
+namespace tools {
+namespace hrtimer {
+
+/**
+ * @brief ClockEventDevice de host sobre timerfd (CLOCK_MONOTONIC): o "comparador" de uma CPU simulada.
+ * * O contador e o proprio relogio monotonico (1 ciclo = 1 ns); uma thread faz o
+ *   papel da linha de IRQ com wait_irq() e chama KernelTimer::handleHwTimerIrq().
+ */
+class TimerfdClockEvent : public ClockEventDevice {
+public:
+    TimerfdClockEvent();
+    ~TimerfdClockEvent() override;
+
+    bool valid() const { return m_fd >= 0; }
+
+    /**
+     * @brief Mede o custo de programar o timerfd (vira min_delta_ns) e a latencia de
+     * despertar do host (informativa), e chama configure().
+     * * A latencia inclui o timer slack do host: a thread que espera os IRQs deve
+     *   reduzi-lo (prctl(PR_SET_TIMERSLACK)) antes de calibrar.
+     */
+    bool calibrate(int samples);
+
+    /**
+     * @brief Bloqueia ate o proximo disparo. @return Disparos desde a ultima espera (0 = erro).
+     */
+    uint64_t wait_irq();
+
+    bool set_next_event(uint64_t cycles) override;
+    bool set_periodic(uint64_t period_cycles) override;
+    void shutdown() override;
+
+    uint64_t program_cost_ns() const { return m_program_cost_ns; }
+    uint64_t wakeup_latency_ns() const { return m_wakeup_latency_ns; }
+
+private:
+    bool arm(uint64_t value_ns, uint64_t interval_ns);
+
+    int m_fd;
+    uint64_t m_program_cost_ns;     // Mediana de timerfd_settime()
+    uint64_t m_wakeup_latency_ns;   // Mediana de (despertar - vencimento)
+};
+
+} // namespace hrtimer
+} // namespace tools
+} // namespace kernel
+} // namespace comandro
+
+#endif // COMANDRO_TOOLS_HRTIMER_TIMERFD_CLOCK_EVENT_H
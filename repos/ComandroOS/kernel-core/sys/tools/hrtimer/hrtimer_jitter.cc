@@ -0,0 +1,252 @@
+#include "TimerfdClockEvent.h"
+#include "../../../pdk/include/TestingAllSensors/sensor_test_definitions.h"
+#include <comandro/kernel/KernelTimer.h>
+#include <comandro/kernel/scheduler.h>
+#include <comandro/kernel/system_time.h>
+#include <comandro/kernel/cpu_topology.h>
+
+#include <sys/prctl.h>
+#include <time.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+// =====================================================================
+// hrtimer_jitter.cc - Resolucao dos timers do KernelTimer (host)
+// Roda o KernelTimer real numa CPU cujo timer de hardware e um timerfd
+// (TimerfdClockEvent) e mede um timer periodico de SENSOR_TEST_RATE_HZ_DEFAULT
+// armado fora da grade do tick, como um pipeline de sensor/audio:
+// latencia (callback - vencimento) e jitter (intervalo - periodo), em modo
+// alta resolucao e no tick fixo de 1ms, com o p99 contra MAX_TRANSPORT_LATENCY_NS
+// e MAX_JITTER_NS do PDK. Sai com 2 se o modo alta resolucao passar do limite.
+//
+// Build (host, a partir de sys/tools/hrtimer):
+//   g++ -std=c++20 -O2 -pthread -I../schedsim/host -o hrtimer_jitter hrtimer_jitter.cc TimerfdClockEvent.cc
+//       ../../../KernelTimer.cc ../../../ClockEvent.cc ../../../tools/trace.cc ../../../scheduler/Timeline.cc
+//
+// Uso:
+//   hrtimer_jitter [--duration-ms N] [--rate-hz N] [--offset-us N]
+// =====================================================================
+
+namespace comandro {
+namespace kernel {
+namespace tools {
+namespace hrtimer {
+
+static constexpr uint64_t NSEC_PER_SEC = 1000000000ULL;
+
+static uint64_t monotonic_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * NSEC_PER_SEC + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+struct Config {
+    uint64_t duration_ns = 2000ULL * 1000000;
+    uint64_t rate_hz = SENSOR_TEST_RATE_HZ_DEFAULT;
+    uint64_t offset_ns = 370000; // Fase do timer em relacao ao tick fixo
+};
+
+/**
+ * @brief Amostras do timer periodico medido (escritas so pela thread de IRQ).
+ */
+struct SensorTimer {
+    uint64_t period_ns;
+    uint64_t first_expiry_ns;
+    uint64_t fires;
+    uint64_t periods;           // Periodos vencidos, incluindo os perdidos (overruns)
+    uint64_t last_fire_ns;
+    std::vector<uint64_t> latencies_ns;
+    std::vector<uint64_t> jitters_ns;
+};
+
+static void sensor_timer_expired(void* context, uint32_t overruns) {
+    SensorTimer* timer = static_cast<SensorTimer*>(context);
+    uint64_t now = monotonic_ns();
+    // Atrasado: o disparo e o do ultimo periodo vencido, nao o do primeiro perdido
+    timer->periods += overruns;
+    uint64_t expected = timer->first_expiry_ns + timer->periods * timer->period_ns;
+    timer->latencies_ns.push_back(now > expected ? now - expected : 0);
+    if (timer->fires > 0) {
+        uint64_t interval = now - timer->last_fire_ns;
+        uint64_t nominal = (overruns + 1ULL) * timer->period_ns;
+        timer->jitters_ns.push_back(interval > nominal ? interval - nominal : nominal - interval);
+    }
+    timer->last_fire_ns = now;
+    timer->fires++;
+    timer->periods++;
+}
+
+static uint64_t percentile(std::vector<uint64_t> samples, double p) {
+    if (samples.empty()) {
+        return 0;
+    }
+    std::sort(samples.begin(), samples.end());
+    size_t index = static_cast<size_t>(p * (samples.size() - 1));
+    return samples[index];
+}
+
+static uint64_t max_of(const std::vector<uint64_t>& samples) {
+    return samples.empty() ? 0 : *std::max_element(samples.begin(), samples.end());
+}
+
+static void sleep_until_ns(uint64_t deadline_ns) {
+    struct timespec ts;
+    ts.tv_sec = static_cast<time_t>(deadline_ns / NSEC_PER_SEC);
+    ts.tv_nsec = static_cast<long>(deadline_ns % NSEC_PER_SEC);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) != 0) {
+    }
+}
+
+/**
+ * @brief Mede o timer periodico num modo. @return true se ficou dentro dos limites do PDK.
+ */
+static bool run_mode(const Config& config, bool high_res) {
+    KernelTimer& kernel_timer = KernelTimer::instance();
+    kernel_timer.setHighResEnabled(high_res);
+
+    SensorTimer timer = {};
+    timer.period_ns = NSEC_PER_SEC / config.rate_hz;
+    timer.latencies_ns.reserve(config.duration_ns / timer.period_ns + 1);
+    timer.jitters_ns.reserve(config.duration_ns / timer.period_ns + 1);
+
+    // No tick fixo, o tick comeca em setHighResEnabled(false): arma com a fase pedida
+    sleep_until_ns(monotonic_ns() + config.offset_ns);
+    timer.first_expiry_ns = monotonic_ns() + timer.period_ns;
+    TimerHandle handle = kernel_timer.setTimer(Nanoseconds(timer.period_ns), sensor_timer_expired, &timer, true);
+    if (handle == 0) {
+        fprintf(stderr, "setTimer falhou\n");
+        return false;
+    }
+    sleep_until_ns(timer.first_expiry_ns + config.duration_ns);
+    kernel_timer.cancelTimer(handle);
+    // Um callback ja despachado ainda pode estar na fila da thread de IRQ
+    sleep_until_ns(monotonic_ns() + 5 * timer.period_ns);
+
+    // Veredito pelo p99: no host a thread de IRQ nao e RT e o maximo mede a preempcao dela
+    uint64_t latency_p99 = percentile(timer.latencies_ns, 0.99);
+    uint64_t jitter_p99 = percentile(timer.jitters_ns, 0.99);
+    bool ok = latency_p99 <= MAX_TRANSPORT_LATENCY_NS && jitter_p99 <= MAX_JITTER_NS;
+    printf("%-16s %8llu %9.1f %9.1f %9.1f %9.1f %9.1f  %s\n", high_res ? "alta resolucao" : "tick fixo 1ms",
+           (unsigned long long)timer.fires, percentile(timer.latencies_ns, 0.50) / 1e3, latency_p99 / 1e3,
+           max_of(timer.latencies_ns) / 1e3, jitter_p99 / 1e3, max_of(timer.jitters_ns) / 1e3,
+           ok ? "ok" : "fora do limite");
+    return ok;
+}
+
+static void print_usage() {
+    printf("Uso: hrtimer_jitter [--duration-ms N] [--rate-hz N] [--offset-us N]\n");
+}
+
+static int run(int argc, char** argv) {
+    Config config;
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        if (i + 1 >= argc) {
+            print_usage();
+            return 1;
+        }
+        uint64_t value = strtoull(argv[++i], nullptr, 10);
+        if (strcmp(arg, "--duration-ms") == 0) {
+            config.duration_ns = value * 1000000;
+        } else if (strcmp(arg, "--rate-hz") == 0) {
+            config.rate_hz = value;
+        } else if (strcmp(arg, "--offset-us") == 0) {
+            config.offset_ns = value * 1000;
+        } else {
+            print_usage();
+            return 1;
+        }
+    }
+    if (config.rate_hz == 0 || config.duration_ns == 0) {
+        print_usage();
+        return 1;
+    }
+
+    // Slack de 1 ns nas esperas do host: senao os 50 us padrao entram na latencia medida
+    prctl(PR_SET_TIMERSLACK, 1UL);
+    TimerfdClockEvent device;
+    if (!device.valid() || !device.calibrate(64)) {
+        fprintf(stderr, "timerfd indisponivel\n");
+        return 1;
+    }
+    printf("Timer de hardware: %s, custo de programacao %.1f us, latencia de despertar %.1f us\n", device.name,
+           device.program_cost_ns() / 1e3, device.wakeup_latency_ns() / 1e3);
+    printf("Timer periodico de %llu Hz por %.0f ms, fase +%.0f us em relacao ao tick fixo\n",
+           (unsigned long long)config.rate_hz, config.duration_ns / 1e6, config.offset_ns / 1e3);
+    printf("Limites do PDK: latencia %.0f us, jitter %.0f us\n\n", MAX_TRANSPORT_LATENCY_NS / 1e3,
+           MAX_JITTER_NS / 1e3);
+
+    KernelTimer::instance().registerClockEventDevice(0, &device);
+
+    // A thread de IRQ: espera o timerfd, trata o IRQ da CPU 0 e em seguida faz o papel da
+    // thread softirq de timers (os callbacks rodam logo depois do IRQ)
+    std::atomic<bool> running{true};
+    std::thread irq_thread([&]() {
+        prctl(PR_SET_TIMERSLACK, 1UL);
+        while (running.load()) {
+            if (device.wait_irq() == 0) {
+                break;
+            }
+            KernelTimer::instance().handleHwTimerIrq();
+            KernelTimer::instance().runSoftirq();
+        }
+    });
+
+    printf("%-16s %8s %9s %9s %9s %9s %9s\n", "modo", "disparos", "lat p50", "lat p99", "lat max", "jit p99",
+           "jit max");
+    printf("%-16s %8s %9s %9s %9s %9s %9s\n", "", "", "(us)", "(us)", "(us)", "(us)", "(us)");
+    bool high_res_ok = run_mode(config, true);
+    run_mode(config, false);
+
+    TimerSoftirqStats stats;
+    KernelTimer::instance().getSoftirqStats(0, &stats);
+    printf("\nFila softirq: %llu callbacks em %llu lotes, profundidade max %u, %llu overflows, "
+           "IRQ -> callback p99 %.1f us\n",
+           (unsigned long long)stats.callbacks, (unsigned long long)stats.batches, stats.max_depth,
+           (unsigned long long)stats.overflows, stats.drain_p99_ns / 1e3);
+
+    running.store(false);
+    device.set_next_event(1); // Acorda a thread de IRQ para sair
+    irq_thread.join();
+    return high_res_ok ? 0 : 2;
+}
+
+} // namespace hrtimer
+} // namespace tools
+
+// ---------------------------------------------------------------------
+// Implementacoes de host das interfaces stubadas em host/comandro/kernel
+// ---------------------------------------------------------------------
+
+uint64_t SystemTime::get_current_ns() {
+    return tools::hrtimer::monotonic_ns();
+}
+
+std::chrono::nanoseconds Scheduler::getKernelTime() {
+    return std::chrono::nanoseconds(tools::hrtimer::monotonic_ns());
+}
+
+void Scheduler::raiseTimerSoftirq(int) {
+    // A thread de IRQ drena a fila softirq logo depois de cada IRQ
+}
+
+namespace cpu {
+
+int get_current_cpu_id() {
+    return 0; // Uma CPU: a thread principal arma, a de IRQ vence
+}
+
+} // namespace cpu
+} // namespace kernel
+} // namespace comandro
+
+int main(int argc, char** argv) {
+    return comandro::kernel::tools::hrtimer::run(argc, argv);
+}
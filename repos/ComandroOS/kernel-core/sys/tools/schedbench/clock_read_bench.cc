@@ -0,0 +1,162 @@
+#include "../../../tools/time.h"
+
+#include <time.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+// =====================================================================
+// clock_read_bench.cc - Custo e precisao da pagina do relogio (host)
+// Calibra o contador de ciclos contra CLOCK_MONOTONIC, publica a pagina
+// (TimeUtils::setClockFrequency/setSystemTime) e mede:
+//   - custo de getHighResTime()/getSystemTime() contra clock_gettime();
+//   - desvio da pagina em relacao a CLOCK_MONOTONIC e CLOCK_REALTIME;
+//   - leitores concorrentes com o relogio sendo rebaseado (nunca volta);
+//   - precisao de busyWaitMicroseconds().
+//
+// Build (host, a partir de sys/tools/schedbench):
+//   g++ -std=c++20 -O2 -pthread -I../schedsim/host clock_read_bench.cc ../../../tools/time.cc -o clock_read_bench
+// =====================================================================
+
+namespace comandro {
+namespace kernel {
+namespace tools {
+namespace schedbench {
+
+using time::TimeUtils;
+
+static constexpr long ITERATIONS = 20000000;
+static constexpr uint64_t NSEC_PER_SEC = 1000000000ULL;
+
+// Impede o compilador de eliminar ou tirar do loop o trabalho medido
+template <typename T>
+static inline void escape(T value) {
+    asm volatile("" : : "r"(value) : "memory");
+}
+
+static uint64_t clock_ns(clockid_t clock) {
+    struct timespec ts;
+    clock_gettime(clock, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * NSEC_PER_SEC + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+static void sleep_ns(uint64_t ns) {
+    struct timespec ts;
+    ts.tv_sec = static_cast<time_t>(ns / NSEC_PER_SEC);
+    ts.tv_nsec = static_cast<long>(ns % NSEC_PER_SEC);
+    nanosleep(&ts, nullptr);
+}
+
+/**
+ * @brief Frequencia do contador medida contra CLOCK_MONOTONIC (o papel da calibracao do TSC no boot).
+ */
+static uint64_t calibrate_counter_hz(uint64_t window_ns) {
+    uint64_t start_ns = clock_ns(CLOCK_MONOTONIC);
+    uint64_t start_cycles = time::readCycleCounter();
+    sleep_ns(window_ns);
+    uint64_t end_cycles = time::readCycleCounter();
+    uint64_t end_ns = clock_ns(CLOCK_MONOTONIC);
+    return static_cast<uint64_t>(static_cast<unsigned __int128>(end_cycles - start_cycles) * NSEC_PER_SEC /
+                                 (end_ns - start_ns));
+}
+
+template <typename Fn>
+static double ns_per_call(Fn fn) {
+    uint64_t start = clock_ns(CLOCK_MONOTONIC);
+    for (long i = 0; i < ITERATIONS; ++i) {
+        escape(fn());
+    }
+    return static_cast<double>(clock_ns(CLOCK_MONOTONIC) - start) / ITERATIONS;
+}
+
+static int64_t signed_delta(uint64_t a, uint64_t b) {
+    return static_cast<int64_t>(a - b);
+}
+
+static int run() {
+    uint64_t counter_hz = calibrate_counter_hz(200000000);
+    TimeUtils::setClockFrequency(counter_hz);
+    uint64_t realtime = clock_ns(CLOCK_REALTIME);
+    TimeUtils::setSystemTime({realtime / NSEC_PER_SEC, static_cast<uint32_t>(realtime % NSEC_PER_SEC)});
+    // Mesmo ponto zero de CLOCK_MONOTONIC para comparar as duas escalas
+    int64_t monotonic_offset = static_cast<int64_t>(clock_ns(CLOCK_MONOTONIC)) -
+                               TimeUtils::getHighResTime().count();
+    printf("Contador: %.3f MHz (calibrado em 200 ms contra CLOCK_MONOTONIC)\n\n", counter_hz / 1e6);
+
+    printf("%-34s %10s\n", "leitura", "ns/chamada");
+    printf("%-34s %10.1f\n", "TimeUtils::getHighResTime()", ns_per_call([] { return TimeUtils::getHighResTime().count(); }));
+    printf("%-34s %10.1f\n", "TimeUtils::getSystemTime()", ns_per_call([] { return TimeUtils::getSystemTime().seconds; }));
+    printf("%-34s %10.1f\n", "clock_gettime(CLOCK_MONOTONIC)", ns_per_call([] { return clock_ns(CLOCK_MONOTONIC); }));
+    printf("%-34s %10.1f\n", "readCycleCounter()", ns_per_call([] { return time::readCycleCounter(); }));
+
+    // Desvio depois de 1 s: erro da calibracao (e do mult/shift) acumulado
+    sleep_ns(NSEC_PER_SEC);
+    int64_t mono_drift = signed_delta(TimeUtils::getHighResTime().count() + monotonic_offset, clock_ns(CLOCK_MONOTONIC));
+    time::SystemTime wall = TimeUtils::getSystemTime();
+    int64_t wall_drift = signed_delta(wall.seconds * NSEC_PER_SEC + wall.nanoseconds, clock_ns(CLOCK_REALTIME));
+    printf("\nDesvio apos 1 s: monotonico %+lld ns, wall clock %+lld ns\n", (long long)mono_drift,
+           (long long)wall_drift);
+
+    // Leitores concorrentes com rebase continuo (ajuste de frequencia de +-50 ppm, como o NTP)
+    std::atomic<bool> running{true};
+    std::atomic<uint64_t> reads{0};
+    std::atomic<uint64_t> backwards{0};
+    unsigned nr_readers = std::max(2u, std::thread::hardware_concurrency()) - 1;
+    std::vector<std::thread> readers;
+    for (unsigned i = 0; i < nr_readers; ++i) {
+        readers.emplace_back([&]() {
+            uint64_t last = 0;
+            uint64_t count = 0;
+            while (running.load(std::memory_order_relaxed)) {
+                uint64_t now = static_cast<uint64_t>(TimeUtils::getHighResTime().count());
+                if (now < last) {
+                    backwards.fetch_add(1, std::memory_order_relaxed);
+                }
+                last = now;
+                ++count;
+            }
+            reads.fetch_add(count, std::memory_order_relaxed);
+        });
+    }
+    uint64_t rebases = 0;
+    uint64_t stop_at = clock_ns(CLOCK_MONOTONIC) + 500000000;
+    while (clock_ns(CLOCK_MONOTONIC) < stop_at) {
+        TimeUtils::setClockFrequency(counter_hz + ((rebases & 1) ? counter_hz / 20000 : 0));
+        ++rebases;
+        sleep_ns(10000);
+    }
+    running.store(false);
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    TimeUtils::setClockFrequency(counter_hz);
+    printf("Seqlock: %u leitores, %llu leituras, %llu rebases, %llu voltas no tempo\n", nr_readers,
+           (unsigned long long)reads.load(), (unsigned long long)rebases, (unsigned long long)backwards.load());
+
+    printf("\n%-10s %12s %12s\n", "busy-wait", "medido (us)", "erro (us)");
+    const uint32_t waits_us[] = {10, 100, 1000};
+    for (uint32_t us : waits_us) {
+        std::vector<uint64_t> samples;
+        for (int i = 0; i < 50; ++i) {
+            uint64_t start = clock_ns(CLOCK_MONOTONIC);
+            time::busyWaitMicroseconds(us);
+            samples.push_back(clock_ns(CLOCK_MONOTONIC) - start);
+        }
+        std::sort(samples.begin(), samples.end());
+        double median_us = samples[samples.size() / 2] / 1e3;
+        printf("%7u us %12.2f %+12.2f\n", us, median_us, median_us - us);
+    }
+    return backwards.load() == 0 ? 0 : 1;
+}
+
+} // namespace schedbench
+} // namespace tools
+} // namespace kernel
+} // namespace comandro
+
+int main() {
+    return comandro::kernel::tools::schedbench::run();
+}
@@ -0,0 +1,133 @@
+#include "../../../scheduler/RtPriorityBitmap.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+// =====================================================================
+// rt_pick_bench.cc - Microbenchmark da selecao RT (host)
+// Compara o loop antigo de pick_next_rt() (99 -> 70, uma fila por vez)
+// com a selecao por bitmap + find-first-set.
+//
+// Build (host):
+//   g++ -std=c++20 -O2 rt_pick_bench.cc -o rt_pick_bench
+// =====================================================================
+
+namespace comandro {
+namespace kernel {
+namespace tools {
+namespace schedbench {
+
+using scheduler::RtPriorityBitmap;
+using scheduler::RT_PRIORITY_LEVELS;
+
+static constexpr int LEVEL_EMERGENCY = 99;
+static constexpr int LEVEL_AUDIO = 90;
+static constexpr int LEVEL_VSYNC = 85;
+static constexpr int LEVEL_UI = 70;
+static constexpr long ITERATIONS = 50000000;
+
+// Cabeca de fila minima: vazia quando aponta para si mesma (como list_head)
+struct QueueHead {
+    QueueHead* next;
+};
+
+struct Scenario {
+    const char* name;
+    int levels[3];
+    int level_count;
+};
+
+// Impede o compilador de eliminar ou tirar do loop o trabalho medido
+template <typename T>
+static inline void escape(T value) {
+    asm volatile("" : : "r"(value) : "memory");
+}
+
+static QueueHead s_queues[RT_PRIORITY_LEVELS];
+static QueueHead s_dummy_entry;
+
+static void setup(const Scenario& scenario, RtPriorityBitmap& bitmap) {
+    for (int i = 0; i < RT_PRIORITY_LEVELS; ++i) {
+        s_queues[i].next = &s_queues[i];
+    }
+    bitmap = RtPriorityBitmap();
+    for (int i = 0; i < scenario.level_count; ++i) {
+        s_queues[scenario.levels[i]].next = &s_dummy_entry;
+        bitmap.set(scenario.levels[i]);
+    }
+}
+
+// Implementacao anterior de pick_next_rt()
+static QueueHead* pick_loop() {
+    for (int i = LEVEL_EMERGENCY; i >= LEVEL_UI; --i) {
+        if (s_queues[i].next != &s_queues[i]) {
+            return s_queues[i].next;
+        }
+    }
+    return nullptr;
+}
+
+// Implementacao atual de pick_next_rt()
+static QueueHead* pick_bitmap(const RtPriorityBitmap& bitmap) {
+    int level = bitmap.highest();
+    if (level < 0) {
+        return nullptr;
+    }
+    return s_queues[level].next;
+}
+
+static double run_loop() {
+    auto start = std::chrono::steady_clock::now();
+    for (long i = 0; i < ITERATIONS; ++i) {
+        escape(pick_loop());
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::nano>(elapsed).count() / ITERATIONS;
+}
+
+static double run_bitmap(const RtPriorityBitmap& bitmap) {
+    auto start = std::chrono::steady_clock::now();
+    for (long i = 0; i < ITERATIONS; ++i) {
+        escape(&bitmap);
+        escape(pick_bitmap(bitmap));
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::nano>(elapsed).count() / ITERATIONS;
+}
+
+static int run() {
+    const Scenario scenarios[] = {
+        { "nenhuma RT pronta", {0, 0, 0}, 0 },
+        { "emergencia (99)", {LEVEL_EMERGENCY, 0, 0}, 1 },
+        { "audio (90)", {LEVEL_AUDIO, 0, 0}, 1 },
+        { "vsync (85)", {LEVEL_VSYNC, 0, 0}, 1 },
+        { "audio + vsync", {LEVEL_AUDIO, LEVEL_VSYNC, 0}, 2 },
+    };
+
+    printf("%-22s %14s %14s %10s\n", "cenario", "loop (ns)", "bitmap (ns)", "ganho");
+    for (const Scenario& scenario : scenarios) {
+        RtPriorityBitmap bitmap;
+        setup(scenario, bitmap);
+
+        // Ambas as implementacoes devem escolher a mesma fila
+        if (pick_loop() != pick_bitmap(bitmap)) {
+            printf("ERRO: selecao divergente no cenario '%s'\n", scenario.name);
+            return 1;
+        }
+
+        double loop_ns = run_loop();
+        double bitmap_ns = run_bitmap(bitmap);
+        printf("%-22s %14.2f %14.2f %9.1fx\n", scenario.name, loop_ns, bitmap_ns, loop_ns / bitmap_ns);
+    }
+    return 0;
+}
+
+} // namespace schedbench
+} // namespace tools
+} // namespace kernel
+} // namespace comandro
+
+int main() {
+    return comandro::kernel::tools::schedbench::run();
+}
@@ -0,0 +1,397 @@
+#include "../../../scheduler/ComandroScheduler.h"
+#include "../../../scheduler/ThreadCache.h"
+#include "../../../scheduler/Timeline.h"
+#include <comandro/kernel/cpu_topology.h>
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <type_traits>
+#include <vector>
+
+// =====================================================================
+// thread_cache_bench.cc - Custo de memoria dos descritores de thread (host)
+// 1. Rajada de criacao (abertura de app): new/delete avulso contra o
+//    ThreadDescriptorCache (slab por CPU).
+// 2. Pick com cache frio: muitos runqueues CRAN (cada um com timeline normal
+//    e background), escolhidos em ordem aleatoria, de modo que os descritores
+//    quase nunca estao no cache. Compara o layout anterior do ThreadDescriptor
+//    (vruntime longe do run_node) com o atual (pick so na linha 0), com os
+//    descritores espalhados pelo heap ou contiguos num slab.
+// Com perf_event_open disponivel, relata cache misses por operacao; sem ele
+// (container, perf_event_paranoid), so o tempo.
+//
+// Build (host, a partir de sys/tools/schedbench):
+//   g++ -std=c++20 -O2 -I../schedsim/host thread_cache_bench.cc
+//       ../../../scheduler/ThreadCache.cc ../../../scheduler/Timeline.cc -o thread_cache_bench
+// =====================================================================
+
+namespace comandro {
+namespace kernel {
+namespace cpu {
+
+// Topologia minima: o cache por CPU so usa a CPU 0
+static const TopologyInfo s_topology = {1, false, true, 0, 0, 0};
+
+const TopologyInfo& get_topology_info() {
+    return s_topology;
+}
+
+int get_current_cpu_id() {
+    return 0;
+}
+
+} // namespace cpu
+
+namespace tools {
+namespace schedbench {
+
+using scheduler::DeadlineParams;
+using scheduler::Priority;
+using scheduler::SchedAvg;
+using scheduler::ThreadDescriptor;
+using scheduler::ThreadDescriptorCache;
+using scheduler::ThreadState;
+using scheduler::Timeline;
+using scheduler::TimelineNode;
+
+static constexpr int BURST_THREADS = 4096;
+static constexpr int BURST_ROUNDS = 50;
+static constexpr int PICK_RUNQUEUES = 32768;
+static constexpr int PICK_NORMAL_PER_RQ = 6;
+static constexpr int PICK_BACKGROUND_PER_RQ = 2;
+static constexpr long PICK_ITERATIONS = 2000000;
+
+/**
+ * @brief ThreadDescriptor na ordem anterior dos campos (referencia de comparacao).
+ */
+struct LegacyThreadDescriptor {
+    uint32_t tid;
+    Priority priority;
+    uint64_t vruntime_ns;
+    uint64_t exec_start_time_ns;
+    uint64_t total_runtime_ns;
+    int cpu;
+    uint64_t cpus_allowed;
+    std::atomic<ThreadState> state;
+    bool on_rq;
+    std::atomic<uint32_t> sleep_timer_id;
+    uint64_t wakeup_time_ns;
+    LegacyThreadDescriptor* wake_next;
+    SchedAvg avg;
+    DeadlineParams dl;
+    uint64_t dl_deadline_ns;
+    int64_t dl_runtime_left_ns;
+    bool dl_throttled;
+    uint32_t dl_timer_id;
+    list_head list_node;
+    TimelineNode run_node;
+    list_head wait_node;
+};
+
+// Layout anterior: pick_next_cran comparava o vruntime do descritor
+struct LegacyLayout {
+    using Descriptor = LegacyThreadDescriptor;
+    static uint64_t vruntime_of(TimelineNode* node) {
+        return timeline_entry(node, Descriptor, run_node)->vruntime_ns;
+    }
+};
+
+// Layout atual: a chave do no (copia do vruntime) esta na mesma linha
+struct CurrentLayout {
+    using Descriptor = ThreadDescriptor;
+    static uint64_t vruntime_of(TimelineNode* node) {
+        return node->key;
+    }
+};
+
+struct Runqueue {
+    Timeline cran_timeline;
+    Timeline bg_timeline;
+};
+
+// Impede o compilador de eliminar ou tirar do loop o trabalho medido
+template <typename T>
+static inline void escape(T value) {
+    asm volatile("" : : "r"(value) : "memory");
+}
+
+/**
+ * @brief Contador de cache misses (usuario) via perf_event_open; invalido se indisponivel.
+ */
+class MissCounter {
+public:
+    MissCounter() {
+        perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = PERF_COUNT_HW_CACHE_MISSES;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        m_fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+    }
+
+    ~MissCounter() {
+        if (m_fd >= 0) {
+            close(m_fd);
+        }
+    }
+
+    bool valid() const { return m_fd >= 0; }
+
+    void start() {
+        if (m_fd >= 0) {
+            ioctl(m_fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(m_fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+
+    uint64_t stop() {
+        uint64_t count = 0;
+        if (m_fd >= 0) {
+            ioctl(m_fd, PERF_EVENT_IOC_DISABLE, 0);
+            if (read(m_fd, &count, sizeof(count)) != sizeof(count)) {
+                count = 0;
+            }
+        }
+        return count;
+    }
+
+private:
+    int m_fd;
+};
+
+static void print_misses(const MissCounter& counter, uint64_t misses, long operations) {
+    if (counter.valid()) {
+        printf(" %12.2f\n", static_cast<double>(misses) / operations);
+    } else {
+        printf(" %12s\n", "n/d");
+    }
+}
+
+template <typename Descriptor>
+static void print_layout_line(const char* name) {
+    printf("  %-10s sizeof %3zu | run_node %d  list_node %d  priority %d  cpu %d  vruntime_ns %d\n",
+           name, sizeof(Descriptor),
+           static_cast<int>(offsetof(Descriptor, run_node) / 64), static_cast<int>(offsetof(Descriptor, list_node) / 64),
+           static_cast<int>(offsetof(Descriptor, priority) / 64), static_cast<int>(offsetof(Descriptor, cpu) / 64),
+           static_cast<int>(offsetof(Descriptor, vruntime_ns) / 64));
+}
+
+// =====================================================================
+// 1. Rajada de criacao
+// =====================================================================
+
+static void run_burst() {
+    std::vector<ThreadDescriptor*> descriptors(BURST_THREADS);
+    MissCounter counter;
+
+    printf("\nRajada de criacao (%d descritores, %d rodadas)\n", BURST_THREADS, BURST_ROUNDS);
+    printf("  %-22s %14s %14s %12s\n", "alocador", "1a rodada(ns)", "demais (ns)", "misses/op");
+
+    for (int variant = 0; variant < 2; ++variant) {
+        ThreadDescriptorCache& cache = ThreadDescriptorCache::instance();
+        double first_ns = 0;
+        double rest_ns = 0;
+        uint64_t misses = 0;
+        for (int round = 0; round < BURST_ROUNDS; ++round) {
+            counter.start();
+            auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < BURST_THREADS; ++i) {
+                ThreadDescriptor* td = (variant == 0) ? new ThreadDescriptor() : cache.alloc();
+                td->tid = static_cast<uint32_t>(i + 1);
+                td->priority = scheduler::PRIORITY_CRAN_NORMAL;
+                descriptors[i] = td;
+            }
+            for (int i = 0; i < BURST_THREADS; ++i) {
+                if (variant == 0) {
+                    delete descriptors[i];
+                } else {
+                    cache.free(descriptors[i]);
+                }
+            }
+            auto elapsed = std::chrono::steady_clock::now() - start;
+            uint64_t round_misses = counter.stop();
+            double ns = std::chrono::duration<double, std::nano>(elapsed).count() / BURST_THREADS;
+            if (round == 0) {
+                first_ns = ns;
+            } else {
+                rest_ns += ns / (BURST_ROUNDS - 1);
+                misses += round_misses;
+            }
+        }
+        printf("  %-22s %14.1f %14.1f", variant == 0 ? "new/delete" : "ThreadDescriptorCache", first_ns, rest_ns);
+        print_misses(counter, misses, static_cast<long>(BURST_THREADS) * (BURST_ROUNDS - 1));
+    }
+
+    scheduler::ThreadCacheStats stats = ThreadDescriptorCache::instance().get_stats();
+    printf("  cache: %llu slabs, %llu allocs, %llu lotes do deposito, %llu em uso\n",
+           static_cast<unsigned long long>(stats.slabs), static_cast<unsigned long long>(stats.allocs),
+           static_cast<unsigned long long>(stats.depot_refills), static_cast<unsigned long long>(stats.objects_in_use));
+}
+
+// =====================================================================
+// 2. Pick com cache frio
+// =====================================================================
+
+/**
+ * @brief Descritores espalhados: cada um alocado entre blocos de tamanho aleatorio
+ * (como threads criadas por chamadores diferentes ao longo do tempo).
+ */
+template <typename Descriptor>
+static std::vector<Descriptor*> allocate_scattered(int count, std::vector<char*>& fillers, std::mt19937& rng) {
+    std::vector<Descriptor*> descriptors(count);
+    for (int i = 0; i < count; ++i) {
+        fillers.push_back(new char[64 + rng() % 960]);
+        descriptors[i] = new Descriptor();
+    }
+    return descriptors;
+}
+
+/**
+ * @brief Descritores contiguos: do ThreadDescriptorCache no layout atual, de um vetor no anterior.
+ */
+template <typename Descriptor>
+static std::vector<Descriptor*> allocate_contiguous(int count, Descriptor** storage) {
+    std::vector<Descriptor*> descriptors(count);
+    if constexpr (std::is_same_v<Descriptor, ThreadDescriptor>) {
+        *storage = nullptr;
+        for (int i = 0; i < count; ++i) {
+            descriptors[i] = ThreadDescriptorCache::instance().alloc();
+        }
+    } else {
+        *storage = new Descriptor[count]();
+        for (int i = 0; i < count; ++i) {
+            descriptors[i] = &(*storage)[i];
+        }
+    }
+    return descriptors;
+}
+
+template <typename Descriptor>
+static void build_runqueues(std::vector<Runqueue>& runqueues, const std::vector<Descriptor*>& descriptors, std::mt19937& rng) {
+    // Threads de um runqueue vem de posicoes aleatorias da alocacao (criadas em momentos diferentes)
+    std::vector<int> order(descriptors.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        order[i] = static_cast<int>(i);
+    }
+    std::shuffle(order.begin(), order.end(), rng);
+
+    size_t next = 0;
+    for (Runqueue& rq : runqueues) {
+        for (int i = 0; i < PICK_NORMAL_PER_RQ + PICK_BACKGROUND_PER_RQ; ++i) {
+            Descriptor* td = descriptors[order[next++]];
+            bool background = i >= PICK_NORMAL_PER_RQ;
+            td->priority = background ? scheduler::PRIORITY_CRAN_BACKGROUND : scheduler::PRIORITY_CRAN_NORMAL;
+            td->vruntime_ns = rng() % 1000000;
+            td->cpu = 0;
+            (background ? rq.bg_timeline : rq.cran_timeline).insert(&td->run_node, td->vruntime_ns);
+        }
+    }
+}
+
+/**
+ * @brief Mesma decisao de pick_next_cran() + sched_class_of() sobre a thread escolhida.
+ */
+template <typename Layout>
+static uint64_t pick(Runqueue& rq) {
+    TimelineNode* leftmost = rq.cran_timeline.leftmost();
+    TimelineNode* bg_leftmost = rq.bg_timeline.leftmost();
+    if (bg_leftmost != nullptr && (leftmost == nullptr || Layout::vruntime_of(bg_leftmost) < Layout::vruntime_of(leftmost))) {
+        leftmost = bg_leftmost;
+    }
+    typename Layout::Descriptor* td = timeline_entry(leftmost, typename Layout::Descriptor, run_node);
+    return static_cast<uint64_t>(td->priority) + static_cast<uint64_t>(td->cpu);
+}
+
+template <typename Layout>
+static void run_pick_variant(const char* name, bool contiguous, const std::vector<int>& sequence) {
+    using Descriptor = typename Layout::Descriptor;
+    std::mt19937 rng(42);
+    const int count = PICK_RUNQUEUES * (PICK_NORMAL_PER_RQ + PICK_BACKGROUND_PER_RQ);
+
+    std::vector<char*> fillers;
+    Descriptor* storage = nullptr;
+    std::vector<Descriptor*> descriptors = contiguous ? allocate_contiguous<Descriptor>(count, &storage)
+                                                      : allocate_scattered<Descriptor>(count, fillers, rng);
+    std::vector<Runqueue> runqueues(PICK_RUNQUEUES);
+    build_runqueues(runqueues, descriptors, rng);
+
+    MissCounter counter;
+    uint64_t checksum = 0;
+    counter.start();
+    auto start = std::chrono::steady_clock::now();
+    uint64_t previous = 0;
+    for (long i = 0; i < PICK_ITERATIONS; ++i) {
+        // O indice depende do pick anterior (sempre + 0): os misses nao se sobrepoem,
+        // como na sequencia real leftmost -> descritor -> classe
+        previous = pick<Layout>(runqueues[sequence[i] + (previous >> 40)]);
+        checksum += previous;
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    uint64_t misses = counter.stop();
+    escape(checksum);
+
+    printf("  %-26s %12.1f", name, std::chrono::duration<double, std::nano>(elapsed).count() / PICK_ITERATIONS);
+    print_misses(counter, misses, PICK_ITERATIONS);
+
+    for (Descriptor* td : descriptors) {
+        if (!contiguous) {
+            delete td;
+        } else if constexpr (std::is_same_v<Descriptor, ThreadDescriptor>) {
+            ThreadDescriptorCache::instance().free(td);
+        }
+    }
+    delete[] storage;
+    for (char* filler : fillers) {
+        delete[] filler;
+    }
+}
+
+static void run_pick() {
+    // A mesma sequencia aleatoria de runqueues para todas as variantes
+    std::mt19937 rng(7);
+    std::vector<int> sequence(PICK_ITERATIONS);
+    for (long i = 0; i < PICK_ITERATIONS; ++i) {
+        sequence[i] = static_cast<int>(rng() % PICK_RUNQUEUES);
+    }
+
+    printf("\nPick com cache frio (%d runqueues x %d threads, %ld picks)\n", PICK_RUNQUEUES,
+           PICK_NORMAL_PER_RQ + PICK_BACKGROUND_PER_RQ, PICK_ITERATIONS);
+    printf("  %-26s %12s %12s\n", "layout / alocacao", "ns/pick", "misses/pick");
+    run_pick_variant<LegacyLayout>("anterior / heap disperso", false, sequence);
+    run_pick_variant<LegacyLayout>("anterior / contiguo", true, sequence);
+    run_pick_variant<CurrentLayout>("atual / heap disperso", false, sequence);
+    run_pick_variant<CurrentLayout>("atual / contiguo (slab)", true, sequence);
+}
+
+static int run() {
+    printf("Linha de cache (offset / 64) dos campos lidos no pick:\n");
+    print_layout_line<LegacyThreadDescriptor>("anterior");
+    print_layout_line<ThreadDescriptor>("atual");
+    if (!MissCounter().valid()) {
+        printf("perf_event_open indisponivel: cache misses nao medidos\n");
+    }
+
+    run_burst();
+    run_pick();
+    return 0;
+}
+
+} // namespace schedbench
+} // namespace tools
+} // namespace kernel
+} // namespace comandro
+
+int main() {
+    return comandro::kernel::tools::schedbench::run();
+}
@@ -0,0 +1,723 @@
+#include "../../../KernelTimer.h"
+#include "../../../ClockEvent.h"
+#include "../../../scheduler/LatencyHistogram.h"
+#include <comandro/kernel/scheduler.h>
+#include <comandro/kernel/system_time.h>
+#include <comandro/kernel/cpu_topology.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <vector>
+
+// =====================================================================
+// timer_bench.cc - Benchmark e stress do KernelTimer (host)
+// Roda o KernelTimer real com uma thread por CPU (cada uma arma, cancela e
+// trata o IRQ e a fila softirq da sua base).
+//
+// Benchmark (padrao): com 10, 1k e 100k timers armados, em regime (cada
+// operacao rearma o timer de um slot), mede vazao e latencia p50/p99/max
+// de setTimer, cancelTimer e handleHwTimerIrq, com 1 e N CPUs, em tres misturas:
+//   one-shot  - 75% curtos (10us-2ms), 25% longos (0.1-10s);
+//   periodico - o mesmo com 25% periodicos (10-100ms);
+//   timeout   - so longos: os sleeps/timeouts do scheduler, quase todos cancelados.
+//
+// Stress (--stress): correcao com relogio virtual.
+//   1. Uma thread simulando as CPUs, com o comparador de cada uma: todo timer
+//      sem folga vence exatamente no vencimento (logo, em ordem), com folga
+//      dentro de [vencimento, vencimento + folga]; one-shot uma vez, periodico
+//      uma vez por periodo, nenhum depois de cancelado; migracoes e rearmes no meio.
+//   2. Uma thread por CPU ao mesmo tempo: nenhum disparo antes do vencimento nem
+//      depois de um cancelamento aceito, e no fim todo one-shot ativo venceu uma vez.
+//
+// Build (host, a partir de sys/tools/schedbench):
+//   g++ -std=c++20 -O2 -pthread -I../schedsim/host -o timer_bench timer_bench.cc ../../../KernelTimer.cc
+//       ../../../ClockEvent.cc ../../../tools/trace.cc ../../../scheduler/Timeline.cc
+//
+// Uso:
+//   timer_bench [--threads N] [--ops N]                     padrao: 4 CPUs, 500000 operacoes por CPU
+//   timer_bench --stress [--threads N] [--ops N] [--seed N] ate 4 threads na fase concorrente
+// =====================================================================
+
+namespace comandro {
+namespace kernel {
+namespace tools {
+namespace schedbench {
+
+using scheduler::LatencyHistogram;
+using scheduler::LatencySnapshot;
+
+static constexpr uint64_t NSEC_PER_MS = 1000000ULL;
+// IRQ de cada CPU a cada tantas operacoes (o tick da thread)
+static constexpr int OPS_PER_IRQ = 32;
+// Latencia medida em uma de cada tantas operacoes (o resto so conta na vazao)
+static constexpr int SAMPLE_EVERY = 8;
+static constexpr int STRESS_CPUS = 4;
+
+// ---------------------------------------------------------------------
+// Ambiente: relogio (real no benchmark, virtual no stress) e CPU atual
+// ---------------------------------------------------------------------
+
+static std::atomic<bool> s_virtual_clock{false};
+static std::atomic<uint64_t> s_virtual_now_ns{1000000000ULL};
+static thread_local int t_cpu = 0;
+
+static uint64_t now_ns() {
+    if (s_virtual_clock.load(std::memory_order_relaxed)) {
+        return s_virtual_now_ns.load(std::memory_order_relaxed);
+    }
+    return static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+}
+
+/**
+ * @brief xorshift64: gerador barato o bastante para nao pesar na medida.
+ */
+struct Random {
+    uint64_t state;
+
+    explicit Random(uint64_t seed) : state(seed * 0x9E3779B97F4A7C15ULL + 1) {}
+
+    uint64_t next() {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return state;
+    }
+
+    uint64_t below(uint64_t limit) { return next() % limit; }
+};
+
+// Impede o compilador de eliminar ou tirar do loop o trabalho medido
+template <typename T>
+static inline void escape(T value) {
+    asm volatile("" : : "r"(value) : "memory");
+}
+
+// =====================================================================
+// Benchmark
+// =====================================================================
+
+struct Mix {
+    const char* name;
+    int periodic_percent;
+    int long_percent;           // Timers de 0.1-10s (niveis altos da wheel; quase sempre cancelados)
+};
+
+static const Mix MIXES[] = {
+    {"one-shot", 0, 25},
+    {"periodico", 25, 25},
+    {"timeout", 0, 100},        // Sleeps/timeouts: cancelados antes de vencer
+};
+
+struct alignas(64) BenchThread {
+    LatencyHistogram set_latency;
+    LatencyHistogram cancel_latency;
+    LatencyHistogram irq_latency;
+    uint64_t ops = 0;
+    uint64_t cancels = 0;
+    uint64_t irqs = 0;
+    uint64_t callbacks = 0;
+};
+
+// One-shot marca o slot como vencido; periodico (context nulo) segue armado
+static void bench_timer_expired(void* context, uint32_t) {
+    if (context != nullptr) {
+        *static_cast<uint8_t*>(context) = 1;
+    }
+}
+
+static uint64_t bench_duration_ns(Random& random, const Mix& mix) {
+    if (random.below(100) < static_cast<uint64_t>(mix.long_percent)) {
+        return 100 * NSEC_PER_MS + random.below(9900 * NSEC_PER_MS);
+    }
+    return 10000 + random.below(2 * NSEC_PER_MS);
+}
+
+// IRQ medido sempre: ja e 1 em OPS_PER_IRQ operacoes
+static void run_irq(BenchThread* stats) {
+    KernelTimer& kernel_timer = KernelTimer::instance();
+    uint64_t start = now_ns();
+    kernel_timer.handleHwTimerIrq();
+    stats->irq_latency.record(now_ns() - start);
+    stats->callbacks += static_cast<uint64_t>(kernel_timer.runSoftirq());
+    stats->irqs++;
+}
+
+/**
+ * @brief Uma CPU do benchmark: enche os seus slots e, em regime, rearma o timer de um slot por
+ * operacao (cancelando antes se ele ainda esta armado).
+ */
+static void bench_thread(int cpu, const Mix& mix, size_t slots, uint64_t ops, BenchThread* stats) {
+    t_cpu = cpu;
+    KernelTimer& kernel_timer = KernelTimer::instance();
+    Random random(static_cast<uint64_t>(cpu) + 1);
+    std::vector<TimerHandle> handles(slots, 0);
+    std::vector<uint8_t> fired(slots, 0);
+
+    auto arm = [&](size_t slot, bool sample) {
+        bool periodic = random.below(100) < static_cast<uint64_t>(mix.periodic_percent);
+        // Periodicos de 10-100ms (loops de governor/bateria): com 25k deles, ~500k disparos/s
+        Nanoseconds duration(periodic ? 10 * NSEC_PER_MS + random.below(90 * NSEC_PER_MS)
+                                      : bench_duration_ns(random, mix));
+        void* context = periodic ? nullptr : &fired[slot];
+        fired[slot] = 0;
+        if (sample) {
+            uint64_t start = now_ns();
+            handles[slot] = kernel_timer.setTimer(duration, bench_timer_expired, context, periodic);
+            stats->set_latency.record(now_ns() - start);
+        } else {
+            handles[slot] = kernel_timer.setTimer(duration, bench_timer_expired, context, periodic);
+        }
+    };
+
+    for (size_t slot = 0; slot < slots; ++slot) {
+        arm(slot, false);
+    }
+
+    for (uint64_t op = 0; op < ops; ++op) {
+        bool sample = (op % SAMPLE_EVERY) == 0;
+        size_t slot = static_cast<size_t>(random.below(slots));
+
+        if (!fired[slot]) {
+            if (sample) {
+                uint64_t start = now_ns();
+                escape(kernel_timer.cancelTimer(handles[slot]));
+                stats->cancel_latency.record(now_ns() - start);
+            } else {
+                escape(kernel_timer.cancelTimer(handles[slot]));
+            }
+            stats->cancels++;
+        }
+        arm(slot, sample);
+        stats->ops++;
+
+        if ((op + 1) % OPS_PER_IRQ == 0) {
+            run_irq(stats);
+        }
+    }
+
+    // A base volta vazia para o proximo caso
+    for (size_t slot = 0; slot < slots; ++slot) {
+        if (!fired[slot]) {
+            kernel_timer.cancelTimer(handles[slot]);
+        }
+    }
+    kernel_timer.runSoftirq();
+}
+
+static void print_latency(const LatencySnapshot& snapshot) {
+    printf(" %6llu %7llu %8llu", (unsigned long long)snapshot.percentile(0.50),
+           (unsigned long long)snapshot.percentile(0.99), (unsigned long long)snapshot.max_ns);
+}
+
+static void run_bench_case(size_t armed, int threads, const Mix& mix, uint64_t ops_per_thread) {
+    std::vector<std::unique_ptr<BenchThread>> stats;
+    for (int i = 0; i < threads; ++i) {
+        stats.emplace_back(new BenchThread());
+    }
+    size_t slots = std::max<size_t>(1, armed / threads);
+
+    uint64_t start = now_ns();
+    std::vector<std::thread> workers;
+    for (int cpu = 0; cpu < threads; ++cpu) {
+        workers.emplace_back(bench_thread, cpu, std::cref(mix), slots, ops_per_thread, stats[cpu].get());
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    uint64_t elapsed = now_ns() - start;
+
+    LatencySnapshot set_snapshot;
+    LatencySnapshot cancel_snapshot;
+    LatencySnapshot irq_snapshot;
+    uint64_t ops = 0;
+    uint64_t cancels = 0;
+    uint64_t irqs = 0;
+    uint64_t callbacks = 0;
+    for (auto& thread : stats) {
+        set_snapshot.add(thread->set_latency);
+        cancel_snapshot.add(thread->cancel_latency);
+        irq_snapshot.add(thread->irq_latency);
+        ops += thread->ops;
+        cancels += thread->cancels;
+        irqs += thread->irqs;
+        callbacks += thread->callbacks;
+    }
+
+    // O tempo inclui o enchimento inicial dos slots
+    printf("%7zu %4d  %-10s %7.2f %6.1f%%", armed, threads, mix.name, ops * 1e3 / elapsed,
+           ops ? 100.0 * cancels / ops : 0.0);
+    print_latency(set_snapshot);
+    print_latency(cancel_snapshot);
+    print_latency(irq_snapshot);
+    printf(" %7.1f\n", irqs ? static_cast<double>(callbacks) / irqs : 0.0);
+}
+
+static int run_bench(int threads, uint64_t ops_per_thread) {
+    const size_t sizes[] = {10, 1000, 100000};
+    printf("KernelTimer em regime: cada operacao rearma o timer de um slot (cancela antes se ainda armado);\n"
+           "IRQ + softirq a cada %d operacoes. Latencias em ns (set/cancel: 1 em %d operacoes);\n"
+           "vazao em milhoes de operacoes/s somando as CPUs; cancel = operacoes que acharam o timer armado.\n\n",
+           OPS_PER_IRQ, SAMPLE_EVERY);
+    printf("%7s %4s  %-10s %7s %7s %23s %23s %23s %7s\n", "timers", "cpus", "mistura", "Mop/s", "cancel",
+           "setTimer", "cancelTimer", "handleHwTimerIrq", "cb/IRQ");
+    printf("%7s %4s  %-10s %7s %7s %6s %7s %8s %6s %7s %8s %6s %7s %8s %7s\n", "", "", "", "", "", "p50", "p99",
+           "max", "p50", "p99", "max", "p50", "p99", "max", "");
+
+    for (size_t armed : sizes) {
+        for (int nr_threads : {1, threads}) {
+            for (const Mix& mix : MIXES) {
+                run_bench_case(armed, nr_threads, mix, ops_per_thread);
+            }
+            if (threads == 1) {
+                break;
+            }
+        }
+    }
+    return 0;
+}
+
+// =====================================================================
+// Stress: modelo de cada timer e verificacao de cada disparo
+// =====================================================================
+
+enum ModelState : uint8_t {
+    MODEL_ARMED,
+    MODEL_CANCELED,
+    MODEL_FIRED,                // One-shot que ja venceu
+};
+
+struct TimerModel {
+    std::atomic<uint8_t> state;
+    std::atomic<uint32_t> fires;
+    uint64_t soft_ns;           // Proximo vencimento esperado
+    uint64_t period_ns;         // 0 = one-shot
+    uint64_t slack_ns;
+    TimerHandle handle;
+};
+
+static std::unique_ptr<TimerModel[]> s_models;
+static std::atomic<size_t> s_nr_models{0};
+static size_t s_max_models = 0;
+static std::atomic<uint64_t> s_failures{0};
+static std::atomic<uint64_t> s_fires{0};
+static bool s_exact = false;     // Fase 1: comparador exato, verifica o instante do disparo
+
+// Ultimo vencimento sem folga entregue na fase 1 (ordem)
+static uint64_t s_last_exact_fire_ns = 0;
+
+static void fail(const char* what, size_t index) {
+    if (s_failures.fetch_add(1) < 10) {
+        fprintf(stderr, "FALHA: %s (timer %zu)\n", what, index);
+    }
+}
+
+static void stress_timer_expired(void* context, uint32_t overruns) {
+    size_t index = reinterpret_cast<size_t>(context);
+    TimerModel& model = s_models[index];
+    uint64_t now = now_ns();
+    s_fires.fetch_add(1, std::memory_order_relaxed);
+
+    uint8_t state = model.state.load(std::memory_order_acquire);
+    if (state != MODEL_ARMED) {
+        fail(state == MODEL_CANCELED ? "disparo depois de cancelamento aceito" : "one-shot disparou duas vezes", index);
+        return;
+    }
+    if (now < model.soft_ns) {
+        fail("disparo antes do vencimento", index);
+    }
+    if (s_exact) {
+        if (overruns != 0) {
+            fail("overrun com o comparador exato", index);
+        }
+        if (now > model.soft_ns + model.slack_ns) {
+            fail("disparo depois da folga", index);
+        }
+        if (model.slack_ns == 0) {
+            if (now != model.soft_ns) {
+                fail("timer sem folga fora do vencimento exato", index);
+            }
+            if (model.soft_ns < s_last_exact_fire_ns) {
+                fail("disparo fora de ordem", index);
+            }
+            s_last_exact_fire_ns = model.soft_ns;
+        }
+    }
+
+    model.fires.fetch_add(1, std::memory_order_relaxed);
+    if (model.period_ns != 0) {
+        model.soft_ns += (overruns + 1ULL) * model.period_ns;
+    } else {
+        model.state.store(MODEL_FIRED, std::memory_order_release);
+    }
+}
+
+static size_t new_model(uint64_t soft_ns, uint64_t period_ns, uint64_t slack_ns) {
+    size_t index = s_nr_models.fetch_add(1);
+    if (index >= s_max_models) {
+        fprintf(stderr, "Modelos esgotados\n");
+        exit(1);
+    }
+    TimerModel& model = s_models[index];
+    model.state.store(MODEL_ARMED, std::memory_order_relaxed);
+    model.fires.store(0, std::memory_order_relaxed);
+    model.soft_ns = soft_ns;
+    model.period_ns = period_ns;
+    model.slack_ns = slack_ns;
+    model.handle = 0;
+    return index;
+}
+
+/**
+ * @brief Arma um timer aleatorio na CPU atual. @return Indice do modelo.
+ * * Sem periodicos na fase concorrente: cancelar um periodico nao espera o callback
+ *   que outra CPU ja tirou da base, e o modelo acusaria um disparo depois do cancelamento.
+ */
+static size_t stress_arm(Random& random, bool allow_periodic) {
+    int kind = static_cast<int>(random.below(10));
+    uint64_t duration = (kind < 3) ? random.below(2 * NSEC_PER_MS) + 1
+                      : (kind < 7) ? random.below(200 * NSEC_PER_MS) + 1
+                      : (kind < 9) ? random.below(20000 * NSEC_PER_MS) + 1
+                                   : random.below(400000 * NSEC_PER_MS) + 1;
+    bool periodic = allow_periodic && random.below(5) == 0 && duration >= NSEC_PER_MS;
+    uint64_t slack = (random.below(3) == 0) ? random.below(duration / 4 + 1) : 0;
+
+    // O modelo existe antes do timer: um disparo (em outra CPU, apos migracao) ja o encontra
+    size_t index = new_model(now_ns() + duration, periodic ? duration : 0, slack);
+    TimerHandle handle = KernelTimer::instance().setTimer(Nanoseconds(duration), stress_timer_expired,
+                                                          reinterpret_cast<void*>(index), periodic,
+                                                          Nanoseconds(slack));
+    if (handle == 0) {
+        fail("setTimer falhou", index);
+    }
+    s_models[index].handle = handle;
+    return index;
+}
+
+static void stress_cancel(size_t index) {
+    TimerModel& model = s_models[index];
+    bool expected = model.state.load(std::memory_order_acquire) == MODEL_ARMED;
+    bool canceled = KernelTimer::instance().cancelTimer(model.handle);
+    if (canceled) {
+        if (!expected) {
+            fail("cancelTimer aceitou um timer que ja venceu", index);
+        }
+        model.state.store(MODEL_CANCELED, std::memory_order_release);
+    } else if (expected && s_exact) {
+        fail("cancelTimer recusou um timer armado", index);
+    }
+}
+
+// Maior distancia programada (~68s): timers mais longos fazem o comparador disparar antes e reprogramar
+static constexpr uint64_t STRESS_MAX_DELTA_NS = 1ULL << 36;
+
+// Comparador de cada CPU: o instante pedido (escrito com o lock da base da CPU)
+static uint64_t s_programmed_ns[STRESS_CPUS];
+
+class StressClockEvent : public ClockEventDevice {
+public:
+    void init(int cpu) {
+        m_cpu = cpu;
+        name = "stress-comparator";
+        features = CLOCK_EVT_FEAT_ONESHOT;
+        configure(1000000000ULL, 0, STRESS_MAX_DELTA_NS);
+    }
+
+    bool set_next_event(uint64_t cycles) override {
+        s_programmed_ns[m_cpu] = now_ns() + cycles;
+        return true;
+    }
+
+    bool set_periodic(uint64_t) override { return false; }
+
+    void shutdown() override { s_programmed_ns[m_cpu] = UINT64_MAX; }
+
+private:
+    int m_cpu = 0;
+};
+
+static StressClockEvent s_stress_clockevents[STRESS_CPUS];
+
+static void irq_on(int cpu) {
+    t_cpu = cpu;
+    KernelTimer::instance().handleHwTimerIrq();
+    KernelTimer::instance().runSoftirq();
+}
+
+/**
+ * @brief Avanca o relogio virtual ate o proximo evento programado e entrega os IRQs vencidos.
+ * @return false se nenhuma CPU tem evento programado.
+ */
+static bool advance_to_next_event(Random* random) {
+    uint64_t next = *std::min_element(std::begin(s_programmed_ns), std::end(s_programmed_ns));
+    if (next == UINT64_MAX) {
+        return false;
+    }
+    uint64_t now = now_ns();
+    // As vezes um IRQ espurio antes do evento, numa CPU qualquer: nada pode vencer cedo
+    if (random != nullptr && next > now + 1 && random->below(8) == 0) {
+        s_virtual_now_ns.store(now + random->below(next - now));
+        irq_on(static_cast<int>(random->below(STRESS_CPUS)));
+        return true;
+    }
+    if (next > now) {
+        s_virtual_now_ns.store(next);
+    }
+    for (int cpu = 0; cpu < STRESS_CPUS; ++cpu) {
+        if (s_programmed_ns[cpu] <= next) {
+            irq_on(cpu);
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Cancela os periodicos, vence todos os one-shots restantes e confere o estado final.
+ */
+static void finish_and_check(size_t first_model) {
+    size_t count = s_nr_models.load();
+    if (s_exact) {
+        // Com o comparador exato, nenhum timer armado pode ter passado do limite da folga
+        uint64_t now = now_ns();
+        for (size_t index = first_model; index < count; ++index) {
+            const TimerModel& model = s_models[index];
+            if (model.state.load() == MODEL_ARMED && model.soft_ns + model.slack_ns < now) {
+                fail("vencimento perdido", index);
+            }
+        }
+    }
+    for (size_t index = first_model; index < count; ++index) {
+        if (s_models[index].period_ns != 0 && s_models[index].state.load() == MODEL_ARMED) {
+            t_cpu = 0;
+            stress_cancel(index);
+        }
+    }
+    for (int round = 0; round < 1000000; ++round) {
+        if (s_exact) {
+            if (!advance_to_next_event(nullptr)) {
+                break;
+            }
+        } else {
+            // Sem comparador: salto grande e um IRQ em cada CPU (os cascades descem um nivel por vez)
+            s_virtual_now_ns.fetch_add(1000 * NSEC_PER_MS);
+            bool armed = false;
+            for (int cpu = 0; cpu < STRESS_CPUS; ++cpu) {
+                irq_on(cpu);
+            }
+            for (size_t index = first_model; index < count && !armed; ++index) {
+                armed = s_models[index].state.load() == MODEL_ARMED;
+            }
+            if (!armed) {
+                break;
+            }
+        }
+    }
+    for (size_t index = first_model; index < count; ++index) {
+        const TimerModel& model = s_models[index];
+        uint8_t state = model.state.load();
+        if (state == MODEL_ARMED) {
+            fail("timer nunca venceu", index);
+        } else if (state == MODEL_FIRED && model.fires.load() != 1) {
+            fail("one-shot nao venceu exatamente uma vez", index);
+        }
+    }
+}
+
+/**
+ * @brief Fase 1: CPUs simuladas por uma thread, comparador exato, todas as verificacoes.
+ */
+static void stress_exact(uint64_t ops, uint64_t seed) {
+    s_exact = true;
+    std::fill(std::begin(s_programmed_ns), std::end(s_programmed_ns), UINT64_MAX);
+    for (int cpu = 0; cpu < STRESS_CPUS; ++cpu) {
+        s_stress_clockevents[cpu].init(cpu);
+        KernelTimer::instance().registerClockEventDevice(cpu, &s_stress_clockevents[cpu]);
+    }
+
+    Random random(seed);
+    size_t first_model = s_nr_models.load();
+    std::vector<size_t> live;
+    for (uint64_t op = 0; op < ops; ++op) {
+        uint64_t action = random.below(100);
+        t_cpu = static_cast<int>(random.below(STRESS_CPUS));
+        if (action < 35 || live.empty()) {
+            live.push_back(stress_arm(random, true));
+        } else if (action < 60) {
+            // Taxa alta de cancelamento, inclusive de timers que ja venceram
+            size_t pick = static_cast<size_t>(random.below(live.size()));
+            stress_cancel(live[pick]);
+            live[pick] = live.back();
+            live.pop_back();
+        } else if (action < 70) {
+            size_t index = live[static_cast<size_t>(random.below(live.size()))];
+            TimerModel& model = s_models[index];
+            uint64_t duration = random.below(500 * NSEC_PER_MS) + 1;
+            if (model.period_ns != 0) {
+                // Periodo sempre bem maior que a folga: sem overruns com o comparador exato
+                duration = std::max(duration, 4 * model.slack_ns + NSEC_PER_MS);
+            }
+            bool expected = model.state.load() == MODEL_ARMED;
+            uint64_t previous_soft = model.soft_ns;
+            uint64_t previous_period = model.period_ns;
+            model.soft_ns = now_ns() + duration;
+            if (model.period_ns != 0) {
+                model.period_ns = duration;
+            }
+            if (KernelTimer::instance().rearmTimer(model.handle, Nanoseconds(duration)) != expected) {
+                fail("rearmTimer divergiu do modelo", index);
+            }
+            if (!expected) {
+                model.soft_ns = previous_soft;
+                model.period_ns = previous_period;
+            }
+        } else if (action < 73) {
+            KernelTimer::instance().migrateTimers(static_cast<int>(random.below(STRESS_CPUS)),
+                                                  static_cast<int>(random.below(STRESS_CPUS)));
+        } else {
+            advance_to_next_event(&random);
+        }
+        if (live.size() > 100000) {
+            live.erase(live.begin(), live.begin() + 50000);
+        }
+    }
+    finish_and_check(first_model);
+    s_exact = false;
+}
+
+/**
+ * @brief Fase 2: uma thread por CPU armando, cancelando e tratando o proprio IRQ ao mesmo tempo.
+ */
+static void stress_concurrent(int threads, uint64_t ops, uint64_t seed) {
+    size_t first_model = s_nr_models.load();
+    std::vector<std::thread> workers;
+    for (int cpu = 0; cpu < threads; ++cpu) {
+        workers.emplace_back([cpu, ops, seed]() {
+            t_cpu = cpu;
+            Random random(seed * 31 + static_cast<uint64_t>(cpu));
+            std::vector<size_t> mine;
+            for (uint64_t op = 0; op < ops; ++op) {
+                uint64_t action = random.below(100);
+                if (action < 40 || mine.empty()) {
+                    mine.push_back(stress_arm(random, false));
+                } else if (action < 75) {
+                    size_t pick = static_cast<size_t>(random.below(mine.size()));
+                    stress_cancel(mine[pick]);
+                    mine[pick] = mine.back();
+                    mine.pop_back();
+                } else if (action < 78) {
+                    KernelTimer::instance().migrateTimers(static_cast<int>(random.below(STRESS_CPUS)),
+                                                          static_cast<int>(random.below(STRESS_CPUS)));
+                } else {
+                    s_virtual_now_ns.fetch_add(random.below(2 * NSEC_PER_MS));
+                    KernelTimer::instance().handleHwTimerIrq();
+                    KernelTimer::instance().runSoftirq();
+                }
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    finish_and_check(first_model);
+}
+
+static int run_stress(int threads, uint64_t ops, uint64_t seed) {
+    s_virtual_clock.store(true);
+    threads = std::min(threads, STRESS_CPUS);
+    s_max_models = static_cast<size_t>(ops) * (1 + static_cast<size_t>(threads)) + 16;
+    s_models.reset(new TimerModel[s_max_models]);
+
+    printf("Stress 1: %d CPUs simuladas, comparador exato, %llu operacoes (seed %llu)\n", STRESS_CPUS,
+           (unsigned long long)ops, (unsigned long long)seed);
+    stress_exact(ops, seed);
+    uint64_t exact_timers = s_nr_models.load();
+    printf("  %llu timers, %llu disparos, %llu falhas\n", (unsigned long long)exact_timers,
+           (unsigned long long)s_fires.load(), (unsigned long long)s_failures.load());
+
+    uint64_t failures = s_failures.load();
+    uint64_t fires = s_fires.load();
+    printf("Stress 2: %d threads (uma por CPU) concorrentes, %llu operacoes cada\n", threads,
+           (unsigned long long)ops);
+    stress_concurrent(threads, ops, seed);
+    printf("  %llu timers, %llu disparos, %llu falhas\n", (unsigned long long)(s_nr_models.load() - exact_timers),
+           (unsigned long long)(s_fires.load() - fires), (unsigned long long)(s_failures.load() - failures));
+
+    bool ok = s_failures.load() == 0;
+    printf("%s\n", ok ? "OK" : "FALHOU");
+    return ok ? 0 : 1;
+}
+
+static void print_usage() {
+    printf("Uso: timer_bench [--stress] [--threads N] [--ops N] [--seed N]\n");
+}
+
+static int run(int argc, char** argv) {
+    bool stress = false;
+    int threads = STRESS_CPUS;
+    uint64_t ops = 0;
+    uint64_t seed = 1;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--stress") == 0) {
+            stress = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            print_usage();
+            return 1;
+        }
+        uint64_t value = strtoull(argv[++i], nullptr, 10);
+        if (strcmp(argv[i - 1], "--threads") == 0 && value > 0 && value <= cpu::MAX_CPU_CORES) {
+            threads = static_cast<int>(value);
+        } else if (strcmp(argv[i - 1], "--ops") == 0 && value > 0) {
+            ops = value;
+        } else if (strcmp(argv[i - 1], "--seed") == 0) {
+            seed = value;
+        } else {
+            print_usage();
+            return 1;
+        }
+    }
+
+    if (stress) {
+        return run_stress(threads, ops ? ops : 200000, seed);
+    }
+    return run_bench(threads, ops ? ops : 500000);
+}
+
+} // namespace schedbench
+} // namespace tools
+
+// ---------------------------------------------------------------------
+// Implementacoes de host das interfaces stubadas em host/comandro/kernel
+// ---------------------------------------------------------------------
+
+uint64_t SystemTime::get_current_ns() {
+    return tools::schedbench::now_ns();
+}
+
+std::chrono::nanoseconds Scheduler::getKernelTime() {
+    return std::chrono::nanoseconds(tools::schedbench::now_ns());
+}
+
+void Scheduler::raiseTimerSoftirq(int) {
+    // Cada thread drena a fila softirq da sua CPU logo depois do IRQ
+}
+
+namespace cpu {
+
+int get_current_cpu_id() {
+    return tools::schedbench::t_cpu;
+}
+
+} // namespace cpu
+} // namespace kernel
+} // namespace comandro
+
+int main(int argc, char** argv) {
+    return comandro::kernel::tools::schedbench::run(argc, argv);
+}
@@ -0,0 +1,7 @@
+#ifndef COMANDRO_HOST_STUB_CLOCK_EVENT_H
+#define COMANDRO_HOST_STUB_CLOCK_EVENT_H
+
+// <comandro/kernel/ClockEvent.h> no host: usa o header real do kernel-core.
+#include "../../../../../../ClockEvent.h"
+
+#endif // COMANDRO_HOST_STUB_CLOCK_EVENT_H
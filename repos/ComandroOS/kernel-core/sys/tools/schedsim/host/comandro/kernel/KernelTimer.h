@@ -0,0 +1,7 @@
+#ifndef COMANDRO_HOST_STUB_KERNEL_TIMER_H
+#define COMANDRO_HOST_STUB_KERNEL_TIMER_H
+
+// <comandro/kernel/KernelTimer.h> no host: usa o header real do kernel-core.
+#include "../../../../../../KernelTimer.h"
+
+#endif // COMANDRO_HOST_STUB_KERNEL_TIMER_H
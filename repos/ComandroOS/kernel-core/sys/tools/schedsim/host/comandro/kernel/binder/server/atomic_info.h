@@ -0,0 +1,20 @@
+#ifndef COMANDRO_HOST_STUB_BINDER_ATOMIC_INFO_H
+#define COMANDRO_HOST_STUB_BINDER_ATOMIC_INFO_H
+
+// Stub de host para <comandro/kernel/binder/server/atomic_info.h>.
+// A ferramenta fornece a carga/frequencia de cada nucleo (CpuAtomicCache simulada).
+
+#include <stdint.h>
+
+namespace comandro {
+namespace kernel {
+namespace binder {
+
+uint32_t atomic_read_core_frequency(int core_id);
+uint8_t atomic_read_core_load(int core_id);
+
+} // namespace binder
+} // namespace kernel
+} // namespace comandro
+
+#endif // COMANDRO_HOST_STUB_BINDER_ATOMIC_INFO_H
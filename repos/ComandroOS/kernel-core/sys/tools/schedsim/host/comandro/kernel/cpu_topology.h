@@ -0,0 +1,32 @@
+#ifndef COMANDRO_HOST_STUB_CPU_TOPOLOGY_H
+#define COMANDRO_HOST_STUB_CPU_TOPOLOGY_H
+
+// Stub de host para <comandro/kernel/cpu_topology.h>.
+// get_topology_info()/get_current_cpu_id() sao fornecidas pela ferramenta.
+
+namespace comandro {
+namespace kernel {
+namespace cpu {
+
+static constexpr int MAX_CPU_CORES = 64;
+
+struct TopologyInfo {
+    int total_core_count;
+    bool has_big_cores;
+    bool has_little_cores;
+    int highest_performance_core_id;
+    int first_little_core_id;
+    int first_big_core_id;
+
+    bool is_big_core(int core_id) const { return has_big_cores && core_id >= first_big_core_id; }
+    bool is_little_core(int core_id) const { return !is_big_core(core_id); }
+};
+
+const TopologyInfo& get_topology_info();
+int get_current_cpu_id();
+
+} // namespace cpu
+} // namespace kernel
+} // namespace comandro
+
+#endif // COMANDRO_HOST_STUB_CPU_TOPOLOGY_H
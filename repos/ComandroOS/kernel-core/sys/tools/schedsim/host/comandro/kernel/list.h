@@ -0,0 +1,49 @@
+#ifndef COMANDRO_HOST_STUB_LIST_H
+#define COMANDRO_HOST_STUB_LIST_H
+
+// Stub de host para <comandro/kernel/list.h>: lista duplamente ligada circular (estilo kernel).
+
+#include <stddef.h>
+
+struct list_head {
+    list_head* next;
+    list_head* prev;
+};
+
+static inline void INIT_LIST_HEAD(list_head* list) {
+    list->next = list;
+    list->prev = list;
+}
+
+static inline void __list_add(list_head* entry, list_head* prev, list_head* next) {
+    next->prev = entry;
+    entry->next = next;
+    entry->prev = prev;
+    prev->next = entry;
+}
+
+static inline void list_add(list_head* entry, list_head* head) {
+    __list_add(entry, head, head->next);
+}
+
+static inline void list_add_tail(list_head* entry, list_head* head) {
+    __list_add(entry, head->prev, head);
+}
+
+static inline void list_del_init(list_head* entry) {
+    entry->next->prev = entry->prev;
+    entry->prev->next = entry->next;
+    INIT_LIST_HEAD(entry);
+}
+
+static inline bool list_empty(const list_head* head) {
+    return head->next == head;
+}
+
+#define list_entry(ptr, type, member) \
+    ((type*)((char*)(ptr) - offsetof(type, member)))
+
+#define list_for_each(pos, head) \
+    for (pos = (head)->next; pos != (head); pos = pos->next)
+
+#endif // COMANDRO_HOST_STUB_LIST_H
@@ -0,0 +1,38 @@
+#ifndef COMANDRO_HOST_STUB_LOCK_H
+#define COMANDRO_HOST_STUB_LOCK_H
+
+// Stub de host para <comandro/kernel/lock.h>: spinlock sobre std::atomic_flag.
+
+#include <atomic>
+
+namespace comandro {
+namespace kernel {
+
+class SpinLock {
+public:
+    void lock() {
+        while (m_flag.test_and_set(std::memory_order_acquire)) {
+        }
+    }
+
+    bool try_lock() { return !m_flag.test_and_set(std::memory_order_acquire); }
+
+    void unlock() { m_flag.clear(std::memory_order_release); }
+
+    class Guard {
+    public:
+        explicit Guard(SpinLock& lock) : m_lock(lock) { m_lock.lock(); }
+        ~Guard() { m_lock.unlock(); }
+
+    private:
+        SpinLock& m_lock;
+    };
+
+private:
+    std::atomic_flag m_flag = ATOMIC_FLAG_INIT;
+};
+
+} // namespace kernel
+} // namespace comandro
+
+#endif // COMANDRO_HOST_STUB_LOCK_H
@@ -0,0 +1,31 @@
+#ifndef COMANDRO_HOST_STUB_LOG_H
+#define COMANDRO_HOST_STUB_LOG_H
+
+// Stub de host para <comandro/kernel/log.h>: so erros vao para stderr (o simulador mede o hot path).
+
+#include <cstdio>
+#include <string>
+
+namespace comandro {
+namespace kernel {
+
+class Log {
+public:
+    static void debug(const char*, const std::string&) {}
+    static void info(const char*, const std::string&) {}
+    static void warn(const char*, const std::string&) {}
+    static void alert(const char* tag, const std::string& msg) { print("ALERT", tag, msg); }
+    static void error(const char* tag, const std::string& msg) { print("ERROR", tag, msg); }
+    static void critical(const char* tag, const std::string& msg) { print("CRITICAL", tag, msg); }
+    static void fatal(const char* tag, const std::string& msg) { print("FATAL", tag, msg); }
+
+private:
+    static void print(const char* level, const char* tag, const std::string& msg) {
+        fprintf(stderr, "[%s] %s: %s\n", level, tag, msg.c_str());
+    }
+};
+
+} // namespace kernel
+} // namespace comandro
+
+#endif // COMANDRO_HOST_STUB_LOG_H
@@ -0,0 +1,22 @@
+#ifndef COMANDRO_HOST_STUB_SCHEDULER_H
+#define COMANDRO_HOST_STUB_SCHEDULER_H
+
+// Stub de host para a fachada kernel::Scheduler usada pelo KernelTimer.
+// getKernelTime()/raiseTimerSoftirq() sao fornecidas pela ferramenta.
+
+#include <chrono>
+
+namespace comandro {
+namespace kernel {
+
+class Scheduler {
+public:
+    static std::chrono::nanoseconds getKernelTime();
+    // Acorda a thread softirq de timers da CPU (chamada do IRQ: nao aloca nem bloqueia)
+    static void raiseTimerSoftirq(int cpu);
+};
+
+} // namespace kernel
+} // namespace comandro
+
+#endif // COMANDRO_HOST_STUB_SCHEDULER_H
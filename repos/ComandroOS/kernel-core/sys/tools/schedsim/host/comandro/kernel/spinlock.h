@@ -0,0 +1,7 @@
+#ifndef COMANDRO_HOST_STUB_SPINLOCK_H
+#define COMANDRO_HOST_STUB_SPINLOCK_H
+
+// Stub de host para <comandro/kernel/spinlock.h> (mesmo SpinLock de lock.h).
+#include "lock.h"
+
+#endif // COMANDRO_HOST_STUB_SPINLOCK_H
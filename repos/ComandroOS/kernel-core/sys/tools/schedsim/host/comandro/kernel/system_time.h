@@ -0,0 +1,19 @@
+#ifndef COMANDRO_HOST_STUB_SYSTEM_TIME_H
+#define COMANDRO_HOST_STUB_SYSTEM_TIME_H
+
+// Stub de host para <comandro/kernel/system_time.h>.
+// A implementacao e fornecida pela ferramenta (ex.: relogio virtual do schedsim).
+
+#include <stdint.h>
+
+namespace comandro {
+namespace kernel {
+
+struct SystemTime {
+    static uint64_t get_current_ns();
+};
+
+} // namespace kernel
+} // namespace comandro
+
+#endif // COMANDRO_HOST_STUB_SYSTEM_TIME_H
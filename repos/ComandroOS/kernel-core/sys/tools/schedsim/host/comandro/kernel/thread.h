@@ -0,0 +1,18 @@
+#ifndef COMANDRO_HOST_STUB_THREAD_H
+#define COMANDRO_HOST_STUB_THREAD_H
+
+// Stub de host para <comandro/kernel/thread.h>.
+
+#include <stdint.h>
+
+namespace comandro {
+namespace kernel {
+
+struct Thread {
+    using TID = uint32_t;
+};
+
+} // namespace kernel
+} // namespace comandro
+
+#endif // COMANDRO_HOST_STUB_THREAD_H
@@ -0,0 +1,7 @@
+#ifndef COMANDRO_HOST_STUB_TRACE_H
+#define COMANDRO_HOST_STUB_TRACE_H
+
+// <comandro/kernel/trace.h> no host: usa o header real do kernel-core.
+#include "../../../../../../tools/trace.h"
+
+#endif // COMANDRO_HOST_STUB_TRACE_H
@@ -0,0 +1,10 @@
+#ifndef COMANDRO_HOST_STUB_TYPES_H
+#define COMANDRO_HOST_STUB_TYPES_H
+
+// Stub de host para <comandro/kernel/types.h>.
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+#endif // COMANDRO_HOST_STUB_TYPES_H
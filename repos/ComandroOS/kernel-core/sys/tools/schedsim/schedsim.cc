@@ -0,0 +1,797 @@
+#include "../../../scheduler/ComandroScheduler.h"
+#include "../../../scheduler/EnergyModel.h"
+#include <comandro/kernel/system_time.h>
+#include <comandro/kernel/cpu_topology.h>
+#include <comandro/kernel/scheduler.h>
+#include <comandro/kernel/KernelTimer.h>
+#include <comandro/kernel/ClockEvent.h>
+#include <comandro/kernel/binder/server/atomic_info.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+// =====================================================================
+// schedsim.cc - Simulador do ComandroScheduler no host
+// Roda o ComandroScheduler/KernelTimer reais com relogio virtual,
+// CPUs simuladas e uma carga sintetica ou lida de um arquivo de trace.
+// Relata: custo do pick (schedule()), latencia wakeup->execucao por
+// prioridade (percentis), fatia de CPU por prioridade, interrupcoes de
+// timer evitadas pelo NO_HZ, utilizacao PELT por CPU, throttles do
+// orcamento RT e da cota background e, em big.LITTLE, energia estimada
+// por cluster.
+//
+// Build (host, a partir de sys/tools/schedsim):
+//   g++ -std=c++20 -O2 -Ihost -o schedsim schedsim.cc ../../../KernelTimer.cc ../../../ClockEvent.cc
+//       ../../../tools/trace.cc ../../../scheduler/ComandroScheduler.cc ../../../scheduler/Timeline.cc
+//       ../../../scheduler/EnergyModel.cc
+//
+// Uso:
+//   schedsim [--cpus N] [--ui N] [--normal N] [--bg N] [--audio N]
+//            [--duration-ms N] [--tick-us N] [--nohz 0|1] [--big N] [--throttle 0|1]
+//            [--trace arquivo]
+//
+// Com --nohz 1 (padrao) cada CPU so passa por schedule() quando o tick pedido
+// pelo scheduler vence (get_next_tick_ns) e so trata o IRQ da sua base do KernelTimer
+// no instante programado no seu ClockEventDevice (one-shot); --nohz 0 mantem o tick fixo.
+//
+// --throttle 0 desliga o orcamento RT e a cota background (comparacao com o
+// comportamento sem controle de banda).
+//
+// Com --big N as ultimas N CPUs sao big e as demais LITTLE (EnergyModel habilitado);
+// os bursts valem num nucleo big e demoram proporcionalmente mais num LITTLE.
+// A CpuAtomicCache simulada publica a carga media recente de cada CPU e a frequencia
+// maxima do cluster; a energia relatada e potencia do OPP x tempo ocupado.
+//
+// Formato do trace (uma diretiva por linha, '#' comenta):
+//   thread <tid> <prioridade> <burst_us> <sleep_us> [start_us] [yield]
+//       Roda burst_us e dorme sleep_us, em loop. burst_us = 0: CPU-bound.
+//       Com "yield", cede a CPU (yield) ao fim do burst em vez de dormir.
+//   prio <at_us> <tid> <prioridade>
+//       set_thread_priority() no instante indicado.
+//   deadline <tid> <runtime_us> <deadline_us> <period_us>
+//       Parametros da classe Deadline, aplicados no add_thread (admissao).
+//       Cada burst e um job liberado no wakeup; o relatorio conta os prazos perdidos.
+// =====================================================================
+
+namespace comandro {
+namespace kernel {
+namespace tools {
+namespace schedsim {
+
+using scheduler::ComandroScheduler;
+using scheduler::Priority;
+using scheduler::ThreadDescriptor;
+
+// ---------------------------------------------------------------------
+// Ambiente simulado: relogio virtual, CPU atual e threads softirq de timers
+// ---------------------------------------------------------------------
+
+static uint64_t s_now_ns = 0;
+static int s_current_cpu = 0;
+static cpu::TopologyInfo s_topology = {4, false, true, 0, 0, 0};
+// Thread softirq de timers acordada pelo IRQ de cada CPU (Scheduler::raiseTimerSoftirq)
+static bool s_timer_softirq_raised[scheduler::SCHED_MAX_CPUS];
+// Proximo IRQ do KernelTimer de cada CPU, programado no ClockEventDevice simulado
+static uint64_t s_next_timer_irq_ns[scheduler::SCHED_MAX_CPUS];
+
+/**
+ * @brief Comparador one-shot simulado de uma CPU (contador de 1 GHz no relogio virtual).
+ */
+class SimClockEvent : public ClockEventDevice {
+public:
+    void init(int cpu) {
+        m_cpu = cpu;
+        name = "sim-comparator";
+        features = CLOCK_EVT_FEAT_ONESHOT;
+        configure(1000000000ULL, 0, UINT64_MAX >> 1); // Vencimento ja passado: IRQ no proprio tick
+    }
+
+    bool set_next_event(uint64_t cycles) override {
+        s_next_timer_irq_ns[m_cpu] = s_now_ns + cycles;
+        return true;
+    }
+
+    bool set_periodic(uint64_t) override { return false; }
+
+    void shutdown() override { s_next_timer_irq_ns[m_cpu] = UINT64_MAX; }
+
+private:
+    int m_cpu = 0;
+};
+
+static SimClockEvent s_clockevents[scheduler::SCHED_MAX_CPUS];
+// CpuAtomicCache simulada: carga recente (0-100%) de cada CPU
+static uint8_t s_cpu_load_percent[scheduler::SCHED_MAX_CPUS];
+
+// Roda a thread softirq de timers das CPUs acordadas pelo IRQ, cada uma na sua CPU
+static void run_timer_softirqs(int nr_cpus) {
+    for (int cpu = 0; cpu < nr_cpus; ++cpu) {
+        if (s_timer_softirq_raised[cpu]) {
+            s_timer_softirq_raised[cpu] = false;
+            s_current_cpu = cpu;
+            KernelTimer::instance().runSoftirq();
+        }
+    }
+    s_current_cpu = 0;
+}
+
+// ---------------------------------------------------------------------
+// Carga de trabalho
+// ---------------------------------------------------------------------
+
+/**
+ * @brief Thread simulada. O descritor e o primeiro membro (recuperado a partir de ThreadDescriptor*).
+ */
+struct SimThread {
+    ThreadDescriptor td;
+    Priority initial_priority;
+    uint64_t burst_ns;          // 0 = CPU-bound
+    uint64_t sleep_ns;
+    uint64_t start_ns;
+    bool yields;
+
+    bool added;
+    bool rejected;              // Recusada pela admissao Deadline
+    bool sleeping;
+    bool waiting_cpu;           // Acordou e ainda nao entrou na CPU
+    uint64_t wake_ns;
+    uint64_t remaining_ns;      // Restante do burst atual
+    uint64_t runtime_ns;        // Tempo de CPU medido pelo simulador
+
+    scheduler::DeadlineParams dl;
+    uint64_t job_release_ns;    // Inicio do job (burst) atual
+    uint64_t jobs;
+    uint64_t deadline_misses;
+};
+
+static SimThread* sim_thread_of(ThreadDescriptor* td) {
+    return reinterpret_cast<SimThread*>(td);
+}
+
+struct PriorityChange {
+    uint64_t at_ns;
+    uint32_t tid;
+    Priority priority;
+};
+
+struct Config {
+    int nr_cpus = 4;
+    int ui_threads = 4;
+    int normal_threads = 4;
+    int background_threads = 8;
+    int audio_threads = 1;
+    uint64_t duration_ns = 5000ULL * 1000000ULL;
+    bool nohz = true;
+    bool throttle = true;
+    int big_cpus = 0;           // 0 = topologia simetrica
+    uint64_t tick_ns = 1000000;
+    const char* trace_path = nullptr;
+};
+
+struct Workload {
+    std::vector<std::unique_ptr<SimThread>> threads;
+    std::vector<PriorityChange> priority_changes;
+};
+
+static SimThread* new_thread(Workload& workload, uint32_t tid, int priority, uint64_t burst_us,
+                             uint64_t sleep_us, uint64_t start_us, bool yields) {
+    auto thread = std::make_unique<SimThread>(); // Value-init: descritor zerado
+    thread->td.tid = tid;
+    thread->initial_priority = static_cast<Priority>(priority);
+    thread->burst_ns = burst_us * 1000;
+    thread->sleep_ns = sleep_us * 1000;
+    thread->start_ns = start_us * 1000;
+    thread->yields = yields;
+    thread->remaining_ns = thread->burst_ns;
+    workload.threads.push_back(std::move(thread));
+    return workload.threads.back().get();
+}
+
+/**
+ * @brief Carga sintetica: audio (90), UI (70), tarefas normais (50) e background CPU-bound (20).
+ * * Os inicios sao escalonados para que as threads periodicas nao acordem todas no mesmo tick.
+ */
+static void build_synthetic_workload(const Config& config, Workload& workload) {
+    uint32_t tid = 1;
+    for (int i = 0; i < config.audio_threads; ++i) {
+        new_thread(workload, tid++, scheduler::PRIORITY_RT_AUDIO_STREAM, 500, 4500, i, false);
+    }
+    for (int i = 0; i < config.ui_threads; ++i) {
+        new_thread(workload, tid++, scheduler::PRIORITY_UI_INTERACTIVE, 2000, 14000, (i * 4000) % 16000, false);
+    }
+    for (int i = 0; i < config.normal_threads; ++i) {
+        new_thread(workload, tid++, scheduler::PRIORITY_CRAN_NORMAL, 1000, 3000, (i * 1000) % 4000, false);
+    }
+    for (int i = 0; i < config.background_threads; ++i) {
+        new_thread(workload, tid++, scheduler::PRIORITY_CRAN_BACKGROUND, 0, 0, 0, false);
+    }
+}
+
+static bool load_trace(const char* path, Workload& workload) {
+    FILE* file = fopen(path, "r");
+    if (file == nullptr) {
+        fprintf(stderr, "ERRO: nao foi possivel abrir o trace '%s'\n", path);
+        return false;
+    }
+
+    char line[256];
+    int line_number = 0;
+    bool ok = true;
+    while (fgets(line, sizeof(line), file) != nullptr) {
+        ++line_number;
+        char* comment = strchr(line, '#');
+        if (comment != nullptr) {
+            *comment = '\0';
+        }
+
+        char directive[16] = {0};
+        if (sscanf(line, "%15s", directive) != 1) {
+            continue; // Linha vazia
+        }
+
+        if (strcmp(directive, "thread") == 0) {
+            unsigned tid = 0;
+            int priority = 0;
+            unsigned long long burst_us = 0, sleep_us = 0, start_us = 0;
+            char flag[16] = {0};
+            int fields = sscanf(line, "%*s %u %d %llu %llu %llu %15s", &tid, &priority, &burst_us, &sleep_us, &start_us, flag);
+            if (fields < 4 || priority < 1 || priority > 99) {
+                fprintf(stderr, "ERRO: %s:%d: diretiva 'thread' invalida\n", path, line_number);
+                ok = false;
+                break;
+            }
+            new_thread(workload, tid, priority, burst_us, sleep_us, start_us, strcmp(flag, "yield") == 0);
+        } else if (strcmp(directive, "deadline") == 0) {
+            unsigned tid = 0;
+            unsigned long long runtime_us = 0, deadline_us = 0, period_us = 0;
+            if (sscanf(line, "%*s %u %llu %llu %llu", &tid, &runtime_us, &deadline_us, &period_us) != 4) {
+                fprintf(stderr, "ERRO: %s:%d: diretiva 'deadline' invalida\n", path, line_number);
+                ok = false;
+                break;
+            }
+            bool found = false;
+            for (auto& thread : workload.threads) {
+                if (thread->td.tid == tid) {
+                    thread->dl = {runtime_us * 1000, deadline_us * 1000, period_us * 1000};
+                    found = true;
+                }
+            }
+            if (!found) {
+                fprintf(stderr, "ERRO: %s:%d: TID %u sem diretiva 'thread' anterior\n", path, line_number, tid);
+                ok = false;
+                break;
+            }
+        } else if (strcmp(directive, "prio") == 0) {
+            unsigned long long at_us = 0;
+            unsigned tid = 0;
+            int priority = 0;
+            if (sscanf(line, "%*s %llu %u %d", &at_us, &tid, &priority) != 3 || priority < 1 || priority > 99) {
+                fprintf(stderr, "ERRO: %s:%d: diretiva 'prio' invalida\n", path, line_number);
+                ok = false;
+                break;
+            }
+            workload.priority_changes.push_back({at_us * 1000, tid, static_cast<Priority>(priority)});
+        } else {
+            fprintf(stderr, "ERRO: %s:%d: diretiva desconhecida '%s'\n", path, line_number, directive);
+            ok = false;
+            break;
+        }
+    }
+    fclose(file);
+
+    std::stable_sort(workload.priority_changes.begin(), workload.priority_changes.end(),
+                     [](const PriorityChange& a, const PriorityChange& b) { return a.at_ns < b.at_ns; });
+    return ok;
+}
+
+// ---------------------------------------------------------------------
+// Estatisticas
+// ---------------------------------------------------------------------
+
+struct PriorityStats {
+    int threads = 0;
+    uint64_t runtime_ns = 0;
+    std::vector<uint64_t> wake_latencies_ns;
+    std::vector<double> thread_runtimes;
+};
+
+static uint64_t percentile(std::vector<uint64_t>& samples, double p) {
+    if (samples.empty()) {
+        return 0;
+    }
+    size_t index = static_cast<size_t>(p * (samples.size() - 1) + 0.5);
+    std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+    return samples[index];
+}
+
+// Indice de justica de Jain: 1.0 = todas as threads receberam o mesmo tempo
+static double jain_fairness(const std::vector<double>& values) {
+    double sum = 0.0, sum_squares = 0.0;
+    for (double value : values) {
+        sum += value;
+        sum_squares += value * value;
+    }
+    if (sum_squares == 0.0) {
+        return 1.0;
+    }
+    return (sum * sum) / (values.size() * sum_squares);
+}
+
+// ---------------------------------------------------------------------
+// Simulacao
+// ---------------------------------------------------------------------
+
+class Simulator {
+public:
+    Simulator(const Config& config, Workload& workload)
+        : m_config(config), m_workload(workload), m_scheduler(ComandroScheduler::instance()) {}
+
+    void run() {
+        m_scheduler.set_nohz_enabled(m_config.nohz);
+        if (!m_config.throttle) {
+            m_scheduler.set_rt_bandwidth(scheduler::RT_PERIOD_NS_DEFAULT, scheduler::RT_PERIOD_NS_DEFAULT);
+            m_scheduler.set_background_bandwidth(0, scheduler::BG_PERIOD_NS_DEFAULT);
+        }
+        std::fill(std::begin(s_next_timer_irq_ns), std::end(s_next_timer_irq_ns), UINT64_MAX);
+        for (int cpu = 0; cpu < m_config.nr_cpus; ++cpu) {
+            s_clockevents[cpu].init(cpu);
+            KernelTimer::instance().registerClockEventDevice(cpu, &s_clockevents[cpu]);
+        }
+
+        for (uint64_t tick_start = 0; tick_start < m_config.duration_ns; tick_start += m_config.tick_ns) {
+            uint64_t tick_end = std::min(tick_start + m_config.tick_ns, m_config.duration_ns);
+
+            s_now_ns = tick_start;
+            s_current_cpu = 0;
+            start_threads(tick_start);
+            apply_priority_changes(tick_start);
+
+            // O timer de hardware de cada CPU entrega os timers da sua base do KernelTimer
+            bool timer_due[scheduler::SCHED_MAX_CPUS];
+            for (int cpu = 0; cpu < m_config.nr_cpus; ++cpu) {
+                timer_due[cpu] = !m_config.nohz || tick_start >= s_next_timer_irq_ns[cpu];
+            }
+            fire_timers(timer_due);
+
+            for (int cpu = 0; cpu < m_config.nr_cpus; ++cpu) {
+                bool tick_due = !m_config.nohz || tick_start >= m_scheduler.get_next_tick_ns(cpu);
+                if (tick_due || timer_due[cpu]) {
+                    m_timer_interrupts++;
+                }
+                run_cpu(cpu, tick_start, tick_end, tick_due);
+            }
+            update_cpu_cache(tick_end - tick_start);
+        }
+        s_now_ns = m_config.duration_ns;
+    }
+
+    void report() {
+        std::map<int, PriorityStats, std::greater<int>> by_priority;
+        uint64_t busy_ns = 0;
+        for (auto& thread : m_workload.threads) {
+            if (thread->rejected) {
+                continue;
+            }
+            PriorityStats& stats = by_priority[thread->td.priority];
+            stats.threads++;
+            stats.thread_runtimes.push_back(static_cast<double>(thread->runtime_ns));
+        }
+        for (auto& [priority, runtime_ns] : m_runtime_by_priority) {
+            by_priority[priority].runtime_ns += runtime_ns;
+            busy_ns += runtime_ns;
+        }
+        for (auto& [priority, latencies] : m_latencies_by_priority) {
+            auto& samples = by_priority[priority].wake_latencies_ns;
+            samples.insert(samples.end(), latencies.begin(), latencies.end());
+        }
+
+        uint64_t capacity_ns = m_config.duration_ns * m_config.nr_cpus;
+        printf("Simulacao: %d CPUs, %zu threads, %.0f ms, tick %.0f us\n", m_config.nr_cpus,
+               m_workload.threads.size(), m_config.duration_ns / 1e6, m_config.tick_ns / 1e3);
+        printf("Ocupacao total: %.1f%%\n", 100.0 * busy_ns / capacity_ns);
+
+        uint64_t periodic_interrupts = (m_config.duration_ns + m_config.tick_ns - 1) / m_config.tick_ns * m_config.nr_cpus;
+        printf("Interrupcoes de timer (NO_HZ %s): %llu de %llu (%.1f%% evitadas)\n\n",
+               m_config.nohz ? "ligado" : "desligado", (unsigned long long)m_timer_interrupts,
+               (unsigned long long)periodic_interrupts,
+               100.0 - 100.0 * m_timer_interrupts / periodic_interrupts);
+
+        std::vector<uint64_t> pick = m_pick_cost_ns;
+        double pick_mean = 0.0;
+        for (uint64_t sample : pick) {
+            pick_mean += sample;
+        }
+        pick_mean = pick.empty() ? 0.0 : pick_mean / pick.size();
+        printf("Custo do pick (schedule() no tick, %zu chamadas):\n", pick.size());
+        printf("  media %.0f ns  p50 %llu ns  p99 %llu ns  max %llu ns\n\n", pick_mean,
+               (unsigned long long)percentile(pick, 0.50), (unsigned long long)percentile(pick, 0.99),
+               (unsigned long long)percentile(pick, 1.0));
+
+        printf("%5s %7s %8s %8s %8s %9s %9s %9s %9s\n", "prio", "threads", "CPU%", "justica",
+               "wakeups", "p50(us)", "p90(us)", "p99(us)", "max(us)");
+        for (auto& [priority, stats] : by_priority) {
+            auto& samples = stats.wake_latencies_ns;
+            printf("%5d %7d %7.1f%% %8.3f %8zu %9.1f %9.1f %9.1f %9.1f\n", priority, stats.threads,
+                   100.0 * stats.runtime_ns / capacity_ns, jain_fairness(stats.thread_runtimes), samples.size(),
+                   percentile(samples, 0.50) / 1e3, percentile(samples, 0.90) / 1e3,
+                   percentile(samples, 0.99) / 1e3, percentile(samples, 1.0) / 1e3);
+        }
+
+        printf("\n%5s %9s %16s\n", "CPU", "ocupacao", "util PELT media");
+        for (int cpu = 0; cpu < m_config.nr_cpus; ++cpu) {
+            uint64_t ticks = (m_config.duration_ns + m_config.tick_ns - 1) / m_config.tick_ns;
+            printf("%5d %8.1f%% %11.0f/%u\n", cpu, 100.0 * m_cpu_busy_ns[cpu] / m_config.duration_ns,
+                   static_cast<double>(m_cpu_util_sum[cpu]) / ticks, scheduler::EnergyModel::instance().cpu_capacity(cpu));
+        }
+
+        scheduler::SchedThrottleStats throttle;
+        m_scheduler.get_throttle_stats(-1, &throttle);
+        printf("\nThrottle: RT %llu vezes (%.1f ms), background %llu vezes (%.1f ms)\n",
+               (unsigned long long)throttle.rt_throttle_count, throttle.rt_throttled_ns / 1e6,
+               (unsigned long long)throttle.bg_throttle_count, throttle.bg_throttled_ns / 1e6);
+
+        report_energy();
+
+        bool header_printed = false;
+        for (auto& thread : m_workload.threads) {
+            const scheduler::DeadlineParams& dl = thread->td.dl;
+            if (thread->rejected || dl.runtime_ns == 0) {
+                continue;
+            }
+            if (!header_printed) {
+                printf("\nDeadline (EDF/CBS):\n%5s %12s %12s %12s %8s %8s %8s\n", "tid", "runtime(us)",
+                       "deadline(us)", "period(us)", "CPU%", "jobs", "perdidos");
+                header_printed = true;
+            }
+            printf("%5u %12.0f %12.0f %12.0f %7.1f%% %8llu %8llu\n", thread->td.tid, dl.runtime_ns / 1e3,
+                   dl.deadline_ns / 1e3, dl.period_ns / 1e3, 100.0 * thread->runtime_ns / m_config.duration_ns,
+                   (unsigned long long)thread->jobs, (unsigned long long)thread->deadline_misses);
+        }
+    }
+
+private:
+    void report_energy() {
+        scheduler::EnergyModel& model = scheduler::EnergyModel::instance();
+        if (!model.is_enabled()) {
+            return;
+        }
+        printf("\nEnergia (estimativa: potencia do OPP x tempo ocupado):\n%8s %5s %8s %12s\n", "cluster",
+               "CPUs", "CPU%", "energia(mJ)");
+        double total_mj = 0.0;
+        for (const char* name : {"LITTLE", "big"}) {
+            int cpus = 0;
+            uint64_t busy_ns = 0;
+            double energy_mj = 0.0;
+            for (int cpu = 0; cpu < m_config.nr_cpus; ++cpu) {
+                if (strcmp(model.cluster_of(cpu)->name, name) == 0) {
+                    cpus++;
+                    busy_ns += m_cpu_busy_ns[cpu];
+                    energy_mj += m_cpu_energy_mj[cpu];
+                }
+            }
+            total_mj += energy_mj;
+            printf("%8s %5d %7.1f%% %12.1f\n", name, cpus,
+                   100.0 * busy_ns / (m_config.duration_ns * m_config.nr_cpus), energy_mj);
+        }
+        printf("%8s %5d %8s %12.1f\n", "total", m_config.nr_cpus, "", total_mj);
+    }
+
+    // Fim do tick: publica a carga de cada CPU (media movel, como o daemon que
+    // alimenta a CpuAtomicCache) e soma a energia gasta no tick
+    void update_cpu_cache(uint64_t tick_ns) {
+        scheduler::EnergyModel& model = scheduler::EnergyModel::instance();
+        for (int cpu = 0; cpu < m_config.nr_cpus; ++cpu) {
+            double busy_percent = 100.0 * m_cpu_tick_busy_ns[cpu] / tick_ns;
+            m_cpu_load[cpu] += (busy_percent - m_cpu_load[cpu]) / 8.0;
+            s_cpu_load_percent[cpu] = static_cast<uint8_t>(m_cpu_load[cpu] + 0.5);
+        }
+        for (int cpu = 0; cpu < m_config.nr_cpus; ++cpu) {
+            const scheduler::EnergyCluster* cluster = model.cluster_of(cpu);
+            // O cluster compartilha o clock: o OPP segue a CPU mais ocupada dele
+            uint32_t max_util = 0;
+            for (int other = 0; other < m_config.nr_cpus; ++other) {
+                if (model.cluster_of(other) == cluster) {
+                    max_util = std::max(max_util, model.cpu_utilization(other));
+                }
+            }
+            const scheduler::EnergyOpp* opp = model.find_opp(cluster, max_util);
+            m_cpu_energy_mj[cpu] += opp->power_mw * (m_cpu_tick_busy_ns[cpu] / 1e9);
+            m_cpu_busy_ns[cpu] += m_cpu_tick_busy_ns[cpu];
+            m_cpu_util_sum[cpu] += m_scheduler.get_cpu_util(cpu);
+            m_cpu_tick_busy_ns[cpu] = 0;
+        }
+    }
+
+    void start_threads(uint64_t now_ns) {
+        for (auto& thread : m_workload.threads) {
+            if (thread->added || thread->start_ns > now_ns) {
+                continue;
+            }
+            thread->td.priority = thread->initial_priority;
+            thread->td.dl = thread->dl;
+            thread->added = true;
+            if (!m_scheduler.add_thread(&thread->td)) {
+                fprintf(stderr, "Admissao recusada: TID %u nao participa da simulacao\n", thread->td.tid);
+                thread->rejected = true;
+                continue;
+            }
+            mark_woken(thread.get(), now_ns);
+        }
+    }
+
+    void apply_priority_changes(uint64_t now_ns) {
+        while (m_next_change < m_workload.priority_changes.size() &&
+               m_workload.priority_changes[m_next_change].at_ns <= now_ns) {
+            const PriorityChange& change = m_workload.priority_changes[m_next_change++];
+            for (auto& thread : m_workload.threads) {
+                if (thread->added && !thread->rejected && thread->td.tid == change.tid) {
+                    m_scheduler.set_thread_priority(&thread->td, change.priority);
+                }
+            }
+        }
+    }
+
+    // IRQ do timer de hardware nas CPUs com evento vencido, seguido da thread softirq de timers de cada uma
+    void fire_timers(const bool* timer_due) {
+        for (int cpu = 0; cpu < m_config.nr_cpus; ++cpu) {
+            if (timer_due[cpu]) {
+                s_current_cpu = cpu;
+                KernelTimer::instance().handleHwTimerIrq();
+            }
+        }
+        run_timer_softirqs(m_config.nr_cpus);
+
+        for (auto& thread : m_workload.threads) {
+            // WAKING conta como acordada: a espera na wake_list faz parte da latencia
+            if (thread->sleeping && thread->td.state != scheduler::THREAD_SLEEPING) {
+                thread->sleeping = false;
+                mark_woken(thread.get(), s_now_ns);
+            }
+        }
+    }
+
+    void mark_woken(SimThread* thread, uint64_t now_ns) {
+        thread->waiting_cpu = true;
+        thread->wake_ns = now_ns;
+        thread->job_release_ns = now_ns;
+    }
+
+    // Fim de um burst: para threads Deadline, confere o prazo do job
+    void complete_job(SimThread* thread, uint64_t now_ns) {
+        if (thread->td.dl.runtime_ns == 0) {
+            return;
+        }
+        thread->jobs++;
+        if (now_ns > thread->job_release_ns + thread->td.dl.deadline_ns) {
+            thread->deadline_misses++;
+        }
+        thread->job_release_ns = now_ns;
+    }
+
+    void timed_schedule() {
+        auto start = std::chrono::steady_clock::now();
+        m_scheduler.schedule();
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        m_pick_cost_ns.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+    }
+
+    // Executa a CPU ate o fim do tick; bursts que terminam no meio do tick dormem/cedem na hora
+    // tick_due = false: sem interrupcao nesta CPU (NO_HZ); a thread atual segue rodando
+    void run_cpu(int cpu, uint64_t tick_start, uint64_t tick_end, bool tick_due) {
+        s_current_cpu = cpu;
+        s_now_ns = tick_start;
+        if (tick_due) {
+            timed_schedule();
+        }
+
+        uint32_t capacity = scheduler::EnergyModel::instance().cpu_capacity(cpu);
+        uint64_t now = tick_start;
+        while (now < tick_end) {
+            ThreadDescriptor* td = m_scheduler.get_current_thread(cpu);
+            if (td == nullptr) {
+                break; // CPU ociosa ate o proximo tick
+            }
+
+            SimThread* thread = sim_thread_of(td);
+            if (thread->waiting_cpu) {
+                thread->waiting_cpu = false;
+                m_latencies_by_priority[td->priority].push_back(now - thread->wake_ns);
+            }
+
+            // burst_ns vale num nucleo de capacidade maxima; num LITTLE o mesmo trabalho demora mais
+            uint64_t available = tick_end - now;
+            uint64_t needed = thread->remaining_ns * scheduler::SCHED_CAPACITY_SCALE / capacity;
+            if (thread->burst_ns == 0 || needed > available) {
+                account(thread, available);
+                if (thread->burst_ns != 0) {
+                    thread->remaining_ns -= available * capacity / scheduler::SCHED_CAPACITY_SCALE;
+                }
+                break;
+            }
+
+            account(thread, needed);
+            now += needed;
+            s_now_ns = now;
+            thread->remaining_ns = thread->burst_ns;
+            complete_job(thread, now);
+
+            if (thread->yields) {
+                m_scheduler.yield(); // Cede a CPU (o proprio yield() passa por schedule())
+            } else {
+                thread->sleeping = true;
+                m_scheduler.sleep_current(std::chrono::nanoseconds(thread->sleep_ns));
+                if (thread->td.state == scheduler::THREAD_RUNNABLE) {
+                    // sleep de duracao zero: acordou imediatamente
+                    thread->sleeping = false;
+                    mark_woken(thread, now);
+                }
+            }
+        }
+    }
+
+    void account(SimThread* thread, uint64_t ran_ns) {
+        thread->runtime_ns += ran_ns;
+        m_cpu_tick_busy_ns[s_current_cpu] += ran_ns;
+        m_runtime_by_priority[thread->td.priority] += ran_ns;
+    }
+
+    const Config& m_config;
+    Workload& m_workload;
+    ComandroScheduler& m_scheduler;
+    size_t m_next_change = 0;
+    std::vector<uint64_t> m_pick_cost_ns;
+    uint64_t m_timer_interrupts = 0;
+    std::map<int, uint64_t> m_runtime_by_priority;
+    std::map<int, std::vector<uint64_t>> m_latencies_by_priority;
+    uint64_t m_cpu_tick_busy_ns[scheduler::SCHED_MAX_CPUS] = {};
+    uint64_t m_cpu_busy_ns[scheduler::SCHED_MAX_CPUS] = {};
+    uint64_t m_cpu_util_sum[scheduler::SCHED_MAX_CPUS] = {};
+    double m_cpu_load[scheduler::SCHED_MAX_CPUS] = {};
+    double m_cpu_energy_mj[scheduler::SCHED_MAX_CPUS] = {};
+};
+
+static void print_usage() {
+    printf("Uso: schedsim [--cpus N] [--ui N] [--normal N] [--bg N] [--audio N]\n"
+           "                [--duration-ms N] [--tick-us N] [--nohz 0|1] [--big N] [--throttle 0|1]\n"
+           "                [--trace arquivo]\n");
+}
+
+static bool parse_args(int argc, char** argv, Config& config) {
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        if (strcmp(arg, "--help") == 0 || strcmp(arg, "-h") == 0) {
+            return false;
+        }
+        if (i + 1 >= argc) {
+            fprintf(stderr, "ERRO: '%s' requer um valor\n", arg);
+            return false;
+        }
+        const char* value = argv[++i];
+        long number = strtol(value, nullptr, 10);
+
+        if (strcmp(arg, "--cpus") == 0) {
+            config.nr_cpus = std::clamp<int>(number, 1, scheduler::SCHED_MAX_CPUS);
+        } else if (strcmp(arg, "--ui") == 0) {
+            config.ui_threads = std::max<int>(number, 0);
+        } else if (strcmp(arg, "--normal") == 0) {
+            config.normal_threads = std::max<int>(number, 0);
+        } else if (strcmp(arg, "--bg") == 0) {
+            config.background_threads = std::max<int>(number, 0);
+        } else if (strcmp(arg, "--audio") == 0) {
+            config.audio_threads = std::max<int>(number, 0);
+        } else if (strcmp(arg, "--duration-ms") == 0) {
+            config.duration_ns = std::max<long>(number, 1) * 1000000ULL;
+        } else if (strcmp(arg, "--tick-us") == 0) {
+            config.tick_ns = std::max<long>(number, 10) * 1000ULL;
+        } else if (strcmp(arg, "--nohz") == 0) {
+            config.nohz = (number != 0);
+        } else if (strcmp(arg, "--throttle") == 0) {
+            config.throttle = (number != 0);
+        } else if (strcmp(arg, "--big") == 0) {
+            config.big_cpus = std::max<int>(number, 0);
+        } else if (strcmp(arg, "--trace") == 0) {
+            config.trace_path = value;
+        } else {
+            fprintf(stderr, "ERRO: opcao desconhecida '%s'\n", arg);
+            return false;
+        }
+    }
+    return true;
+}
+
+static int run(int argc, char** argv) {
+    Config config;
+    if (!parse_args(argc, argv, config)) {
+        print_usage();
+        return 1;
+    }
+
+    Workload workload;
+    if (config.trace_path != nullptr) {
+        if (!load_trace(config.trace_path, workload)) {
+            return 1;
+        }
+    } else {
+        build_synthetic_workload(config, workload);
+    }
+    if (workload.threads.empty()) {
+        fprintf(stderr, "ERRO: carga de trabalho vazia\n");
+        return 1;
+    }
+
+    // O scheduler global le a topologia na primeira chamada de instance()
+    s_topology.total_core_count = config.nr_cpus;
+    if (config.big_cpus > 0) {
+        int big_cpus = std::min(config.big_cpus, config.nr_cpus);
+        s_topology.has_big_cores = true;
+        s_topology.has_little_cores = (big_cpus < config.nr_cpus);
+        s_topology.first_big_core_id = config.nr_cpus - big_cpus;
+        s_topology.first_little_core_id = 0;
+        s_topology.highest_performance_core_id = config.nr_cpus - 1;
+    }
+
+    Simulator simulator(config, workload);
+    simulator.run();
+    simulator.report();
+    return 0;
+}
+
+} // namespace schedsim
+} // namespace tools
+
+// ---------------------------------------------------------------------
+// Implementacoes de host das interfaces stubadas em host/comandro/kernel
+// ---------------------------------------------------------------------
+
+uint64_t SystemTime::get_current_ns() {
+    return tools::schedsim::s_now_ns;
+}
+
+std::chrono::nanoseconds Scheduler::getKernelTime() {
+    return std::chrono::nanoseconds(tools::schedsim::s_now_ns);
+}
+
+void Scheduler::raiseTimerSoftirq(int cpu) {
+    tools::schedsim::s_timer_softirq_raised[cpu] = true;
+}
+
+namespace binder {
+
+uint32_t atomic_read_core_frequency(int core_id) {
+    const scheduler::EnergyCluster* cluster = scheduler::EnergyModel::instance().cluster_of(core_id);
+    return cluster ? cluster->opps[cluster->nr_opps - 1].frequency_mhz : 0;
+}
+
+uint8_t atomic_read_core_load(int core_id) {
+    if (core_id < 0 || core_id >= scheduler::SCHED_MAX_CPUS) {
+        return 100;
+    }
+    return tools::schedsim::s_cpu_load_percent[core_id];
+}
+
+} // namespace binder
+
+namespace cpu {
+
+const TopologyInfo& get_topology_info() {
+    return tools::schedsim::s_topology;
+}
+
+int get_current_cpu_id() {
+    return tools::schedsim::s_current_cpu;
+}
+
+} // namespace cpu
+} // namespace kernel
+} // namespace comandro
+
+int main(int argc, char** argv) {
+    return comandro::kernel::tools::schedsim::run(argc, argv);
+}
@@ -0,0 +1,92 @@
+#include "time.h"
+#include <comandro/kernel/spinlock.h>
+
+namespace comandro {
+namespace kernel {
+namespace time {
+
+// Mantissa de 32 bits: erro de conversao abaixo de 1 ns por segundo em qualquer contador ate GHz
+static constexpr uint32_t CLOCK_PAGE_SHIFT = 32;
+
+ClockPage g_clock_page;
+
+// Serializa os escritores (boot, NTP); os leitores so olham seq
+static SpinLock s_clock_write_lock;
+
+/**
+ * @brief Monotonico em cycles pela conversao publicada. O chamador segura s_clock_write_lock.
+ */
+static uint64_t monotonic_at(const ClockPage& page, uint64_t cycles) {
+    uint64_t base_cycles = page.base_cycles.load(std::memory_order_relaxed);
+    uint64_t delta = (cycles > base_cycles) ? cycles - base_cycles : 0;
+    return page.base_ns.load(std::memory_order_relaxed) +
+           static_cast<uint64_t>((static_cast<unsigned __int128>(delta) * page.mult.load(std::memory_order_relaxed)) >>
+                                 page.shift.load(std::memory_order_relaxed));
+}
+
+// seq impar durante a escrita: um leitor concorrente descarta o que leu e repete
+static void begin_write(ClockPage& page) {
+    page.seq.store(page.seq.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+}
+
+static void end_write(ClockPage& page) {
+    page.seq.store(page.seq.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+bool TimeUtils::setClockFrequency(uint64_t counter_hz) {
+    if (counter_hz == 0) {
+        return false;
+    }
+    ClockPage& page = g_clock_page;
+    SpinLock::Guard lock(s_clock_write_lock);
+
+    // Rebase: o instante atual pela conversao antiga vira a nova base (0 no primeiro boot)
+    uint64_t cycles = readCycleCounter();
+    uint64_t now_ns = (page.counter_hz.load(std::memory_order_relaxed) != 0) ? monotonic_at(page, cycles) : 0;
+    uint64_t mult = static_cast<uint64_t>((static_cast<unsigned __int128>(NANOS_PER_SECOND.count()) << CLOCK_PAGE_SHIFT) /
+                                          counter_hz);
+
+    begin_write(page);
+    page.mult.store(mult, std::memory_order_relaxed);
+    page.shift.store(CLOCK_PAGE_SHIFT, std::memory_order_relaxed);
+    page.base_cycles.store(cycles, std::memory_order_relaxed);
+    page.base_ns.store(now_ns, std::memory_order_relaxed);
+    page.counter_hz.store(counter_hz, std::memory_order_relaxed);
+    end_write(page);
+    return true;
+}
+
+void TimeUtils::setSystemTime(SystemTime now) {
+    ClockPage& page = g_clock_page;
+    SpinLock::Guard lock(s_clock_write_lock);
+
+    int64_t wall_ns = static_cast<int64_t>(now.seconds * NANOS_PER_SECOND.count() + now.nanoseconds);
+    int64_t offset = wall_ns - static_cast<int64_t>(monotonic_at(page, readCycleCounter()));
+
+    begin_write(page);
+    page.wall_offset_ns.store(offset, std::memory_order_relaxed);
+    end_write(page);
+}
+
+} // namespace time
+} // namespace kernel
+} // namespace comandro
+
+// =====================================================================
+// Interface nativa (FFI): processos mapeiam a pagina e leem com readClockPage
+// =====================================================================
+
+extern "C" const comandro::kernel::time::ClockPage* native_get_clock_page() {
+    return &comandro::kernel::time::g_clock_page;
+}
+
+extern "C" uint64_t native_clock_monotonic_ns() {
+    return comandro::kernel::time::readClockPage(nullptr);
+}
+
+extern "C" int64_t native_clock_realtime_ns() {
+    int64_t offset;
+    uint64_t monotonic_ns = comandro::kernel::time::readClockPage(&offset);
+    return static_cast<int64_t>(monotonic_ns) + offset;
+}
@@ -2,7 +2,11 @@
 #define COMANDRO_KERNEL_TOOLS_TIME_H
 
 #include <comandro/kernel/types.h>
+#include <atomic>
 #include <chrono>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
 
 namespace comandro {
 namespace kernel {
@@ -29,6 +33,93 @@ struct SystemTime {
     uint32_t nanoseconds;   // Nanosegundos dentro do segundo atual
 };
 
+// =====================================================================
+// Pagina do relogio
+// O kernel publica a conversao ciclos -> ns do contador de hardware
+// (cntvct_el0 no ARM64, TSC no x86) numa pagina somente leitura, mapeada
+// tambem nos processos (native_get_clock_page). Ler o tempo e ler o
+// contador e fazer uma multiplicacao, sem chamada ao kernel; o seqlock
+// entrega uma versao consistente enquanto o kernel rebaseia ou ajusta.
+// =====================================================================
+
+/**
+ * @brief Dados do relogio: monotonico = base_ns + ((ciclos - base_cycles) * mult) >> shift.
+ * * seq impar = escrita em andamento; o leitor repete se seq mudou durante a leitura.
+ * * Campos atomicos (leitura relaxed): a pagina e lida sem lock por qualquer CPU.
+ */
+struct alignas(64) ClockPage {
+    std::atomic<uint32_t> seq{0};
+    std::atomic<uint32_t> shift{0};
+    std::atomic<uint64_t> mult{0};
+    std::atomic<uint64_t> base_cycles{0};
+    std::atomic<uint64_t> base_ns{0};           // Monotonico (desde o boot) em base_cycles
+    std::atomic<int64_t> wall_offset_ns{0};     // Wall clock = monotonico + offset (RTC/NTP)
+    std::atomic<uint64_t> counter_hz{0};        // 0 = relogio ainda nao iniciado no boot
+};
+
+extern ClockPage g_clock_page;
+
+/**
+ * @brief Le o contador de ciclos da CPU (o mesmo em todas as CPUs: generic timer / TSC invariante).
+ */
+static inline uint64_t readCycleCounter() {
+#if defined(__aarch64__)
+    uint64_t cycles;
+    // isb: a leitura nao e antecipada para antes das instrucoes anteriores
+    asm volatile("isb\n\tmrs %0, cntvct_el0" : "=r"(cycles) : : "memory");
+    return cycles;
+#elif defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    // Sem contador conhecido: o relogio monotonico do host faz o papel (1 ciclo = 1 ns)
+    return static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+}
+
+/**
+ * @brief Pausa curta dentro de um spin (libera o pipeline para o outro hyperthread).
+ */
+static inline void cpuRelax() {
+#if defined(__aarch64__)
+    asm volatile("yield" : : : "memory");
+#elif defined(__x86_64__) || defined(__i386__)
+    _mm_pause();
+#endif
+}
+
+/**
+ * @brief Leitura lock-free da pagina do relogio.
+ * @param wall_offset_ns Saida opcional: offset do wall clock da mesma versao.
+ * @return Tempo monotonico em ns desde o boot.
+ */
+static inline uint64_t readClockPage(int64_t* wall_offset_ns) {
+    const ClockPage& page = g_clock_page;
+    for (;;) {
+        uint32_t seq = page.seq.load(std::memory_order_acquire);
+        if (seq & 1) {
+            cpuRelax();
+            continue;
+        }
+        uint64_t mult = page.mult.load(std::memory_order_relaxed);
+        uint32_t shift = page.shift.load(std::memory_order_relaxed);
+        uint64_t base_cycles = page.base_cycles.load(std::memory_order_relaxed);
+        uint64_t base_ns = page.base_ns.load(std::memory_order_relaxed);
+        int64_t offset = page.wall_offset_ns.load(std::memory_order_relaxed);
+        uint64_t cycles = readCycleCounter();
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (page.seq.load(std::memory_order_relaxed) != seq) {
+            continue;
+        }
+
+        if (wall_offset_ns != nullptr) {
+            *wall_offset_ns = offset;
+        }
+        // Contador de outra CPU um pouco atras da base recem-publicada: nao volta no tempo
+        uint64_t delta = (cycles > base_cycles) ? cycles - base_cycles : 0;
+        return base_ns + static_cast<uint64_t>((static_cast<unsigned __int128>(delta) * mult) >> shift);
+    }
+}
+
 /**
  * @brief O TimeUtils fornece acesso ao relógio de hardware (H/W Clock)
  * e servicos de temporizacao de kernel de alta precisao.
@@ -39,41 +130,80 @@ public:
     /**
      * @brief Obtem a contagem atual do relogio do kernel de alta resolucao.
      * * Esta e a fonte mais precisa de tempo no kernel.
-     * @return O tempo atual em nanosegundos (desde o boot ou outra referencia).
+     * * Inline sobre a pagina do relogio: uma leitura do contador, sem chamada ao kernel.
+     * @return O tempo atual em nanosegundos (desde o boot).
      */
-    static Nanoseconds getHighResTime();
+    static Nanoseconds getHighResTime() {
+        return Nanoseconds(readClockPage(nullptr));
+    }
 
     /**
      * @brief Obtem o tempo do sistema (wall clock time) atual.
      * * Este tempo e ajustado via NTP e pode ter jitter.
      */
-    static SystemTime getSystemTime();
+    static SystemTime getSystemTime() {
+        int64_t offset;
+        uint64_t monotonic_ns = readClockPage(&offset);
+        return fromWallNanoseconds(static_cast<int64_t>(monotonic_ns) + offset);
+    }
 
     /**
-     * @brief Converte um tempo absoluto de Nanoseconds para a estrutura SystemTime.
+     * @brief Converte um tempo absoluto de Nanoseconds (relogio de getHighResTime) para a estrutura SystemTime.
+     * * Usa o offset do wall clock atual: um ajuste de NTP depois do instante tambem vale para ele.
      */
-    static SystemTime toSystemTime(Nanoseconds absolute_time);
+    static SystemTime toSystemTime(Nanoseconds absolute_time) {
+        int64_t offset;
+        readClockPage(&offset);
+        return fromWallNanoseconds(absolute_time.count() + offset);
+    }
+
+    /**
+     * @brief Inicia ou ajusta o relogio (boot de cada clocksource, correcao de frequencia do NTP).
+     * * Rebaseia no instante atual: o tempo monotonico continua sem salto, so a taxa muda.
+     * @param counter_hz Frequencia do contador (cntfrq_el0 no ARM64; TSC calibrado no x86).
+     * @return false se counter_hz e 0.
+     */
+    static bool setClockFrequency(uint64_t counter_hz);
+
+    /**
+     * @brief Acerta o wall clock (RTC no boot, NTP): so o offset muda, o monotonico nao.
+     */
+    static void setSystemTime(SystemTime now);
 
     /**
      * @brief Adiciona um temporizador one-shot ao agendador do kernel.
      * @param duration Duracao para o disparo.
-     * @param callback A funcao a ser executada no vencimento.
+     * @param callback A funcao a ser executada no vencimento (overruns sempre 0 no one-shot).
      * @param is_real_time Se o temporizador deve ter prioridade de RT.
-     * @return Um ID do temporizador para cancelamento, ou 0 em caso de falha.
+     * @param slack Atraso tolerado alem de duration, para vencer junto com outros timers
+     *        (um wakeup so). Ignorado se is_real_time.
+     * @return Handle opaco do temporizador (o TimerHandle do KernelTimer), ou 0 em caso de falha.
      */
-    using TimerCallback = void (*)(void* context);
-    static uint32_t setKernelTimer(Nanoseconds duration, TimerCallback callback, void* context, bool is_real_time);
+    using TimerCallback = void (*)(void* context, uint32_t overruns);
+    using TimerHandle = uint64_t;
+    static TimerHandle setKernelTimer(Nanoseconds duration, TimerCallback callback, void* context, bool is_real_time,
+                                      Nanoseconds slack = Nanoseconds(0));
 
     /**
      * @brief Cancela um temporizador de kernel ativo.
-     * @param timer_id O ID retornado por setKernelTimer.
-     * @return true se o temporizador foi encontrado e cancelado.
+     * @param timer_handle O handle retornado por setKernelTimer.
+     * @return true se o temporizador foi encontrado e cancelado (false se ja disparou).
      */
-    static bool cancelKernelTimer(uint32_t timer_id);
+    static bool cancelKernelTimer(TimerHandle timer_handle);
     
 private:
     // Nao instanciável (classe estática de utilidade)
     TimeUtils() = delete;
+
+    static SystemTime fromWallNanoseconds(int64_t wall_ns) {
+        if (wall_ns < 0) {
+            wall_ns = 0;
+        }
+        SystemTime time;
+        time.seconds = static_cast<uint64_t>(wall_ns) / NANOS_PER_SECOND.count();
+        time.nanoseconds = static_cast<uint32_t>(static_cast<uint64_t>(wall_ns) % NANOS_PER_SECOND.count());
+        return time;
+    }
 };
 
 // =====================================================================
@@ -90,12 +220,16 @@ Nanoseconds toNanos(const std::chrono::duration<Rep, Period>& duration) {
 
 /**
  * @brief Funcao utilitaria para realizar um busy-wait (nao usar em threads de aplicacao).
+ * * Calibrado pela frequencia do contador da pagina do relogio: o loop so le o contador
+ *   e compara, sem converter para ns a cada volta. Antes do boot do relogio nao espera.
  */
 static inline void busyWaitMicroseconds(uint32_t us) {
-    // Implementacao de calibracao de loop de kernel
-    // (Acesso direto ao contador de ciclo da CPU ou timer loop)
-    TimeUtils::getHighResTime(); // Leitura inicial
-    // ...
+    uint64_t counter_hz = g_clock_page.counter_hz.load(std::memory_order_relaxed);
+    uint64_t cycles = static_cast<uint64_t>(static_cast<unsigned __int128>(us) * counter_hz / 1000000);
+    uint64_t start = readCycleCounter();
+    while (readCycleCounter() - start < cycles) {
+        cpuRelax();
+    }
 }
 
 
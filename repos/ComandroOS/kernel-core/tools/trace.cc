@@ -0,0 +1,106 @@
+#include "trace.h"
+#include <comandro/kernel/system_time.h> // Para SystemTime::get_current_ns()
+#include <comandro/kernel/cpu_topology.h> // Para cpu::get_current_cpu_id()
+
+namespace comandro {
+namespace kernel {
+namespace trace {
+
+static_assert((KTRACE_RING_EVENTS & (KTRACE_RING_EVENTS - 1)) == 0, "KTRACE_RING_EVENTS deve ser potencia de 2");
+
+std::atomic<bool> g_trace_enabled{true};
+
+/**
+ * @brief Ring de eventos de uma CPU. head e um contador monotono (posicao = head % tamanho).
+ */
+struct alignas(64) TraceRing {
+    std::atomic<uint64_t> head{0};
+    TraceEvent events[KTRACE_RING_EVENTS];
+};
+
+static TraceRing s_rings[KTRACE_MAX_CPUS];
+
+void write_event(FormatId id, const uint64_t* args, int arg_count) {
+    int cpu = cpu::get_current_cpu_id();
+    if (cpu < 0 || cpu >= KTRACE_MAX_CPUS) {
+        return;
+    }
+    TraceRing& ring = s_rings[cpu];
+
+    // Reserva atomica do slot: um IRQ que emita na mesma CPU recebe outra posicao
+    uint64_t pos = ring.head.fetch_add(1, std::memory_order_relaxed);
+    TraceEvent& event = ring.events[pos & (KTRACE_RING_EVENTS - 1)];
+
+    // seq = 0 durante a escrita: o leitor descarta o slot em vez de ler um evento pela metade
+    event.seq.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    event.timestamp_ns = SystemTime::get_current_ns();
+    event.format_id = id;
+    event.cpu = static_cast<uint8_t>(cpu);
+    event.arg_count = static_cast<uint8_t>(arg_count);
+    for (int i = 0; i < arg_count; ++i) {
+        event.args[i] = args[i];
+    }
+
+    event.seq.store(pos + 1, std::memory_order_release);
+}
+
+size_t read_events(int cpu, TraceRecord* out, size_t max_records) {
+    if (cpu < 0 || cpu >= KTRACE_MAX_CPUS || max_records == 0) {
+        return 0;
+    }
+    const TraceRing& ring = s_rings[cpu];
+
+    uint64_t head = ring.head.load(std::memory_order_acquire);
+    uint64_t first = (head > KTRACE_RING_EVENTS) ? head - KTRACE_RING_EVENTS : 0;
+    if (head - first > max_records) {
+        first = head - max_records;
+    }
+
+    size_t count = 0;
+    for (uint64_t pos = first; pos < head; ++pos) {
+        const TraceEvent& event = ring.events[pos & (KTRACE_RING_EVENTS - 1)];
+
+        // Slot sobrescrito por uma volta mais nova do ring, ou ainda em escrita
+        uint64_t seq = event.seq.load(std::memory_order_acquire);
+        if (seq != pos + 1) {
+            continue;
+        }
+
+        TraceRecord& record = out[count];
+        record.timestamp_ns = event.timestamp_ns;
+        record.format_id = event.format_id;
+        record.cpu = event.cpu;
+        record.arg_count = event.arg_count;
+        record.reserved = 0;
+        for (int i = 0; i < KTRACE_MAX_ARGS; ++i) {
+            record.args[i] = (i < event.arg_count) ? event.args[i] : 0;
+        }
+
+        // O escritor pode ter reusado o slot durante a copia
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (event.seq.load(std::memory_order_relaxed) != seq) {
+            continue;
+        }
+        record.seq = seq;
+        ++count;
+    }
+    return count;
+}
+
+} // namespace trace
+} // namespace kernel
+} // namespace comandro
+
+// =====================================================================
+// Interface nativa para o dexter (trace, trace_save, trace_enable)
+// =====================================================================
+
+extern "C" size_t native_trace_read(int cpu, comandro::kernel::trace::TraceRecord* out, size_t max_records) {
+    return comandro::kernel::trace::read_events(cpu, out, max_records);
+}
+
+extern "C" void native_trace_set_enabled(int enabled) {
+    comandro::kernel::trace::g_trace_enabled.store(enabled != 0, std::memory_order_relaxed);
+}
@@ -0,0 +1,146 @@
+#ifndef COMANDRO_KERNEL_TOOLS_TRACE_H
+#define COMANDRO_KERNEL_TOOLS_TRACE_H
+
+#include <comandro/kernel/types.h>
+#include <atomic>
+
+namespace comandro {
+namespace kernel {
+namespace trace {
+
+// =====================================================================
+// TRACE_H - Tracing binario diferido do kernel
+// O hot path grava apenas o ID do formato e os argumentos crus num ring
+// por CPU; o texto e montado fora do kernel (dexter trace / trace_decode).
+// =====================================================================
+
+/**
+ * @brief Tabela de formatos: X(ID, subsistema, formato).
+ * * Os formatos usam apenas conversoes de inteiro de 64 bits (%llu, %llx, %lld):
+ *   o decodificador passa cada argumento como unsigned long long.
+ * * Novos eventos entram no final (os IDs fazem parte do formato dos arquivos salvos).
+ */
+#define KTRACE_FORMATS(X) \
+    X(SCHED_SWITCH,      "sched", "Troca de contexto: TID %llu -> TID %llu Prio: %llu") \
+    X(SCHED_ADD_THREAD,  "sched", "Thread TID %llu adicionada na CPU %llu.") \
+    X(TIMER_SET,         "timer", "Temporizador setado. ID: %llu, Expira em: %lluns") \
+    X(TIMER_EXPIRED,     "timer", "Temporizador %llu expirou.") \
+    X(TIMER_CANCEL,      "timer", "Temporizador ID %llu cancelado.") \
+    X(TIMER_CANCEL_MISS, "timer", "Tentativa de cancelar ID %llu nao encontrado.") \
+    X(SCHED_RT_THROTTLE, "sched", "RT throttled na CPU %llu: %lluns de RT no periodo.") \
+    X(SCHED_BG_THROTTLE, "sched", "Grupo background throttled na CPU %llu: cota global esgotada.") \
+    X(TIMER_MIGRATE,     "timer", "%llu temporizadores migrados da CPU %llu para a CPU %llu.") \
+    X(TIMER_OVERRUN,     "timer", "Temporizador periodico %llu atrasado: %llu periodos perdidos.")
+
+enum FormatId : uint16_t {
+#define KTRACE_ENUM_ENTRY(id, subsystem, format) TRACE_##id,
+    KTRACE_FORMATS(KTRACE_ENUM_ENTRY)
+#undef KTRACE_ENUM_ENTRY
+    TRACE_FORMAT_COUNT
+};
+
+struct FormatInfo {
+    const char* name;
+    const char* subsystem;
+    const char* format;
+};
+
+static constexpr FormatInfo FORMATS[TRACE_FORMAT_COUNT] = {
+#define KTRACE_INFO_ENTRY(id, subsystem, format) {#id, subsystem, format},
+    KTRACE_FORMATS(KTRACE_INFO_ENTRY)
+#undef KTRACE_INFO_ENTRY
+};
+
+static constexpr int KTRACE_MAX_ARGS = 4;
+static constexpr int KTRACE_MAX_CPUS = 64;
+// Eventos por CPU (potencia de 2); os mais antigos sao sobrescritos
+static constexpr uint32_t KTRACE_RING_EVENTS = 512;
+
+/**
+ * @brief Registro binario de um evento (48 bytes).
+ * * seq = posicao no ring + 1 apos a escrita completa; 0 = slot em escrita ou vazio.
+ */
+struct TraceEvent {
+    std::atomic<uint64_t> seq;
+    uint64_t timestamp_ns;
+    uint16_t format_id;
+    uint8_t cpu;
+    uint8_t arg_count;
+    uint32_t reserved;
+    uint64_t args[KTRACE_MAX_ARGS];
+};
+
+/**
+ * @brief Copia estavel de um evento (o que native_trace_read entrega e trace_save grava).
+ */
+struct TraceRecord {
+    uint64_t seq;
+    uint64_t timestamp_ns;
+    uint16_t format_id;
+    uint8_t cpu;
+    uint8_t arg_count;
+    uint32_t reserved;
+    uint64_t args[KTRACE_MAX_ARGS];
+};
+
+// Cabecalho dos arquivos gravados por "dexter trace_save"
+static constexpr uint32_t KTRACE_FILE_MAGIC = 0x4352544B; // "KTRC" nos bytes do arquivo (little-endian)
+static constexpr uint32_t KTRACE_FILE_VERSION = 1;
+
+struct TraceFileHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t record_size;
+    uint32_t record_count;
+};
+
+// Conta as conversoes (%x, ignorando %%) de um formato em tempo de compilacao
+static constexpr int format_arg_count(const char* format) {
+    int count = 0;
+    for (const char* c = format; *c != '\0'; ++c) {
+        if (*c == '%') {
+            if (c[1] == '%') {
+                ++c;
+            } else {
+                ++count;
+            }
+        }
+    }
+    return count;
+}
+
+// Habilitado por padrao; "dexter trace_enable off" desliga sem recompilar
+extern std::atomic<bool> g_trace_enabled;
+
+void write_event(FormatId id, const uint64_t* args, int arg_count);
+
+/**
+ * @brief Grava um evento: algumas stores no ring da CPU atual, sem alocacao nem lock.
+ */
+template <FormatId Id, typename... Args>
+inline void emit(Args... args) {
+    static_assert(sizeof...(Args) <= KTRACE_MAX_ARGS, "KTRACE: argumentos demais");
+    static_assert(format_arg_count(FORMATS[Id].format) == sizeof...(Args),
+                  "KTRACE: numero de argumentos diferente do formato");
+
+    if (!g_trace_enabled.load(std::memory_order_relaxed)) {
+        return;
+    }
+    const uint64_t values[KTRACE_MAX_ARGS + 1] = {static_cast<uint64_t>(args)...};
+    write_event(Id, values, sizeof...(Args));
+}
+
+/**
+ * @brief Copia ate max_records eventos completos do ring de uma CPU, do mais antigo ao mais novo.
+ * @return Numero de eventos copiados.
+ */
+size_t read_events(int cpu, TraceRecord* out, size_t max_records);
+
+} // namespace trace
+} // namespace kernel
+} // namespace comandro
+
+// Uso: KTRACE(SCHED_SWITCH, prev_tid, next_tid, priority);
+#define KTRACE(id, ...) ::comandro::kernel::trace::emit<::comandro::kernel::trace::TRACE_##id>(__VA_ARGS__)
+
+#endif // COMANDRO_KERNEL_TOOLS_TRACE_H